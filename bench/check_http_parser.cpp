@@ -0,0 +1,438 @@
+// Robustness check of HttpParser (pc_monitor_bench --check-http-parser).
+//
+// The parser keeps resumable offsets (scanned_, head_start_) across reads
+// and across the receive buffer being compacted, skips stray blank lines and
+// serves pipelined requests, so it is checked the way the web server drives
+// it: ReceiveAll() below mirrors ServiceConnection (main.cpp), fed in random
+// splits, and has to produce exactly what parsing the whole stream does.
+//
+//   - generated valid streams (pipelined, CRLF or bare LF, stray blank
+//     lines, bodies) parse to the requests that were generated, whole and
+//     in random splits
+//   - fixed malformed heads give 400 and oversized ones 431, whole and split
+//   - Content-Length must be digits and bounded; Transfer-Encoding is refused
+//   - mutated streams give the same outcome split as whole
+//   - every view of a completed request lies within the bytes it consumed
+//
+// Deterministic for a seed; prints each failure and returns 1 if any.
+
+#include "http_parser.h"
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+    using PCMonitor::HttpParser;
+    using PCMonitor::HttpRequest;
+
+    constexpr uint32_t kSeed = 20261018;
+    constexpr int kValidStreams = 3000;
+    constexpr int kSplitsPerStream = 8;
+    constexpr int kMutatedStreams = 20000;
+
+    int g_failures = 0;
+
+    void Fail(const char* check, const std::string& detail) {
+        if (++g_failures <= 20) {
+            printf("FAIL %s: %s\n", check, detail.c_str());
+        }
+    }
+
+    // Printable form of a stream, for failure messages
+    std::string Escape(std::string_view text, size_t limit = 160) {
+        std::string out;
+        for (size_t i = 0; i < text.size() && i < limit; ++i) {
+            char c = text[i];
+            if (c == '\r') out += "\\r";
+            else if (c == '\n') out += "\\n";
+            else if (c < 0x20 || c >= 0x7F) {
+                char hex[8];
+                snprintf(hex, sizeof(hex), "\\x%02X", static_cast<unsigned char>(c));
+                out += hex;
+            }
+            else out += c;
+        }
+        if (text.size() > limit) out += "... (" + std::to_string(text.size()) + " bytes)";
+        return out;
+    }
+
+    bool Within(std::string_view view, const char* begin, const char* end) {
+        return view.empty() || (view.data() >= begin && view.data() + view.size() <= end);
+    }
+
+    // One request as the server saw it, copied out before the buffer moves
+    std::string Describe(const HttpRequest& request) {
+        std::string out;
+        out.append(request.method).append(" ").append(request.target).append(" ").append(request.version);
+        out += request.keep_alive ? " keep-alive" : " close";
+        for (size_t i = 0; i < request.header_count; ++i) {
+            out.append(" [").append(request.headers[i].name).append("=").append(request.headers[i].value).append("]");
+        }
+        out.append(" body=").append(request.body);
+        return out;
+    }
+
+    // Everything a connection produced: the requests served, then how it ended
+    struct Outcome {
+        std::vector<std::string> requests;
+        std::string end;
+
+        bool operator==(const Outcome& other) const { return requests == other.requests && end == other.end; }
+    };
+
+    std::string Summary(const Outcome& outcome) {
+        std::string out = std::to_string(outcome.requests.size()) + " requests, " + outcome.end;
+        if (!outcome.requests.empty()) out += "; last: " + Escape(outcome.requests.back(), 80);
+        return out;
+    }
+
+    // Checks a completed request's views and records it. False once the
+    // connection would close after it.
+    bool Accept(const HttpRequest& request, const char* data, size_t consumed, Outcome& outcome) {
+        const char* end = data + consumed;
+        bool inside = Within(request.method, data, end) && Within(request.target, data, end) &&
+                      Within(request.path, data, end) && Within(request.query, data, end) &&
+                      Within(request.version, data, end) && Within(request.body, data, end) &&
+                      request.header_count <= HttpRequest::kMaxHeaders;
+        for (size_t i = 0; inside && i < request.header_count; ++i) {
+            inside = Within(request.headers[i].name, data, end) && Within(request.headers[i].value, data, end);
+        }
+        if (!inside) Fail("views", "a view points outside the consumed bytes: " + Escape(std::string_view(data, consumed)));
+
+        outcome.requests.push_back(Describe(request));
+        return request.keep_alive;
+    }
+
+    const char* ErrorName(HttpParser::Result result) {
+        return result == HttpParser::Result::TooLarge ? "431" : "400";
+    }
+
+    // The reference: the whole stream in memory, parsed request by request
+    Outcome ParseWhole(std::string_view stream) {
+        Outcome outcome;
+        HttpParser parser;
+        size_t offset = 0;
+        for (;;) {
+            HttpRequest request;
+            size_t consumed = 0;
+            auto result = parser.Parse(stream.data() + offset, stream.size() - offset, request, consumed);
+            if (result == HttpParser::Result::Incomplete) {
+                outcome.end = "open, " + std::to_string(stream.size() - offset) + " bytes pending";
+                return outcome;
+            }
+            if (result != HttpParser::Result::Complete) {
+                outcome.end = ErrorName(result);
+                return outcome;
+            }
+            if (consumed == 0 || consumed > stream.size() - offset) {
+                Fail("consumed", "consumed " + std::to_string(consumed) + " of " + std::to_string(stream.size() - offset));
+                outcome.end = "broken";
+                return outcome;
+            }
+            bool open = Accept(request, stream.data() + offset, consumed, outcome);
+            offset += consumed;
+            if (!open) {
+                outcome.end = "closed";
+                return outcome;
+            }
+        }
+    }
+
+    // ServiceConnection's loop: a fixed receive buffer, reads of the given
+    // sizes, every complete request served in place, then the remainder
+    // moved to the front
+    Outcome ReceiveAll(std::string_view stream, const std::vector<size_t>& reads) {
+        static char buffer[HttpParser::kMaxRequestBytes];
+        Outcome outcome;
+        HttpParser parser;
+        size_t size = 0;
+        size_t sent = 0;
+
+        for (size_t r = 0; sent < stream.size(); ++r) {
+            size_t chunk = reads.empty() ? stream.size() : reads[r % reads.size()];
+            chunk = std::min(chunk, std::min(stream.size() - sent, sizeof(buffer) - size));
+            if (chunk == 0) {
+                // recv() into a full buffer returns 0 and the server hangs up without a response
+                outcome.end = "stalled with a full buffer";
+                return outcome;
+            }
+            // Poison what the parser has no business reading
+            memset(buffer + size, '#', sizeof(buffer) - size);
+            memcpy(buffer + size, stream.data() + sent, chunk);
+            size += chunk;
+            sent += chunk;
+
+            size_t offset = 0;
+            for (;;) {
+                HttpRequest request;
+                size_t consumed = 0;
+                auto result = parser.Parse(buffer + offset, size - offset, request, consumed);
+                if (result == HttpParser::Result::Incomplete) break;
+                if (result != HttpParser::Result::Complete) {
+                    outcome.end = ErrorName(result);
+                    return outcome;
+                }
+                if (consumed == 0 || consumed > size - offset) {
+                    Fail("consumed", "consumed " + std::to_string(consumed) + " of " + std::to_string(size - offset));
+                    outcome.end = "broken";
+                    return outcome;
+                }
+                bool open = Accept(request, buffer + offset, consumed, outcome);
+                offset += consumed;
+                if (!open) {
+                    outcome.end = "closed";
+                    return outcome;
+                }
+            }
+
+            if (offset > 0) {
+                memmove(buffer, buffer + offset, size - offset);
+                size -= offset;
+            }
+        }
+
+        outcome.end = "open, " + std::to_string(size) + " bytes pending";
+        return outcome;
+    }
+
+    std::vector<size_t> RandomReads(std::mt19937& rng, size_t stream_size) {
+        std::vector<size_t> reads;
+        size_t total = 0;
+        int style = static_cast<int>(rng() % 4);
+        while (total < stream_size) {
+            size_t read;
+            switch (style) {
+                case 0: read = 1; break;                                // Byte at a time
+                case 1: read = 1 + rng() % 8; break;                    // Trickle
+                case 2: read = 1 + rng() % 512; break;
+                default: read = 1 + rng() % (stream_size + 1); break;   // Few large reads
+            }
+            reads.push_back(read);
+            total += read;
+        }
+        return reads;
+    }
+
+    // Whole versus split, for one stream
+    void CheckSplits(const char* check, std::mt19937& rng, std::string_view stream, const Outcome& expected, int splits) {
+        for (int s = 0; s < splits; ++s) {
+            Outcome split = ReceiveAll(stream, RandomReads(rng, stream.size()));
+            if (!(split == expected)) {
+                Fail(check, "split parse differs for " + Escape(stream) + "\n    whole: " + Summary(expected) +
+                     "\n    split: " + Summary(split));
+                return;
+            }
+        }
+    }
+
+    // ------------------------------------------------------------------
+    // Generated valid streams
+
+    std::string RandomToken(std::mt19937& rng, size_t min_length, size_t max_length) {
+        static const char kChars[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789-_.~!#$&'*+^`|";
+        size_t length = min_length + rng() % (max_length - min_length + 1);
+        std::string token;
+        for (size_t i = 0; i < length; ++i) token += kChars[rng() % (sizeof(kChars) - 1)];
+        return token;
+    }
+
+    // A valid pipelined stream and the requests it must parse to
+    std::string GenerateStream(std::mt19937& rng, Outcome& expected) {
+        static const char* const kMethods[] = { "GET", "HEAD", "POST", "PUT", "OPTIONS" };
+        static const char* const kPaths[] = { "/", "/api/metrics", "/api/history", "/metrics", "/index.html", "/api/stats" };
+
+        std::string stream;
+        expected = Outcome();
+        int count = 1 + static_cast<int>(rng() % 6);
+        for (int i = 0; i < count; ++i) {
+            const char* newline = rng() % 4 == 0 ? "\n" : "\r\n";
+            // Stray blank lines before a request are tolerated
+            if (rng() % 5 == 0) stream += rng() % 2 ? "\r\n" : "\r\n\r\n";
+
+            std::string method = kMethods[rng() % 5];
+            std::string target = kPaths[rng() % 6];
+            if (rng() % 2) target += "?" + RandomToken(rng, 1, 6) + "=" + RandomToken(rng, 0, 12);
+            std::string version = rng() % 5 == 0 ? "HTTP/1.0" : "HTTP/1.1";
+            stream += method + " " + target + " " + version + newline;
+
+            std::vector<std::pair<std::string, std::string>> headers;
+            headers.emplace_back("Host", "localhost:8080");
+            int extra = static_cast<int>(rng() % 12);
+            for (int h = 0; h < extra; ++h) headers.emplace_back("X-" + RandomToken(rng, 1, 10), RandomToken(rng, 0, 40));
+
+            bool last = i == count - 1;
+            bool keep_alive = !last || rng() % 2;
+            if (version == "HTTP/1.0") {
+                if (keep_alive) headers.emplace_back("Connection", "keep-alive");
+            } else if (!keep_alive) {
+                headers.emplace_back("Connection", rng() % 2 ? "close" : "Upgrade, close");
+            }
+
+            std::string body;
+            if (method == "POST" || method == "PUT") {
+                body = RandomToken(rng, 0, 300);
+                headers.emplace_back("Content-Length", std::to_string(body.size()));
+            }
+
+            std::string described = method + " " + target + " " + version + (keep_alive ? " keep-alive" : " close");
+            for (const auto& header : headers) {
+                // Optional whitespace around values is not part of them
+                const char* space = rng() % 3 == 0 ? "" : rng() % 2 ? " " : " \t ";
+                stream += header.first + ":" + space + header.second + (rng() % 4 == 0 ? " " : "") + newline;
+                described += " [" + header.first + "=" + header.second + "]";
+            }
+            stream += newline;
+            stream += body;
+            described += " body=" + body;
+            expected.requests.push_back(described);
+
+            if (!keep_alive) {
+                expected.end = "closed";
+                return stream;
+            }
+        }
+
+        // Optionally leave the start of another request pending
+        if (rng() % 3 == 0) {
+            std::string partial = "GET /api/metrics HTTP/1.1\r\nHost: loc";
+            partial.resize(1 + rng() % partial.size());
+            stream += partial;
+            expected.end = "open, " + std::to_string(partial.size()) + " bytes pending";
+        } else {
+            expected.end = "open, 0 bytes pending";
+        }
+        return stream;
+    }
+
+    void CheckValidStreams(std::mt19937& rng, std::vector<std::string>& corpus) {
+        for (int i = 0; i < kValidStreams; ++i) {
+            Outcome expected;
+            std::string stream = GenerateStream(rng, expected);
+            Outcome whole = ParseWhole(stream);
+            if (!(whole == expected)) {
+                Fail("valid", Escape(stream) + "\n    expected: " + Summary(expected) + "\n    parsed:   " + Summary(whole));
+                continue;
+            }
+            CheckSplits("valid", rng, stream, expected, kSplitsPerStream);
+            corpus.push_back(std::move(stream));
+        }
+    }
+
+    // ------------------------------------------------------------------
+    // Fixed cases
+
+    struct FixedCase {
+        const char* name;
+        std::string stream;
+        const char* end;    // Expected Outcome::end
+    };
+
+    void CheckFixed(std::mt19937& rng) {
+        const std::string get = "GET / HTTP/1.1\r\nHost: x\r\n";
+        std::vector<FixedCase> cases = {
+            // Malformed request lines
+            { "no version", "GET /\r\n\r\n", "400" },
+            { "extra field", "GET / HTTP/1.1 x\r\n\r\n", "400" },
+            { "double space", "GET  / HTTP/1.1\r\n\r\n", "400" },
+            { "method not a token", "G@T / HTTP/1.1\r\n\r\n", "400" },
+            { "empty method", " / HTTP/1.1\r\n\r\n", "400" },
+            { "relative target", "GET index.html HTTP/1.1\r\n\r\n", "400" },
+            { "http/2", "GET / HTTP/2.0\r\n\r\n", "400" },
+            { "lowercase version", "GET / http/1.1\r\n\r\n", "400" },
+            { "binary", std::string("\x16\x03\x01\x02\x00\x01\x00\x01\xfc\x03\x03\r\n\r\n", 15), "400" },
+            // Malformed headers
+            { "no colon", get + "Accept text/html\r\n\r\n", "400" },
+            { "space in name", get + "Bad Name: x\r\n\r\n", "400" },
+            { "space before colon", get + "Host : x\r\n\r\n", "400" },
+            { "empty name", get + ": x\r\n\r\n", "400" },
+            { "folded line", get + "X-A: a\r\n continued\r\n\r\n", "400" },
+            // Content-Length and Transfer-Encoding
+            { "length not digits", get + "Content-Length: 12a\r\n\r\n", "400" },
+            { "length negative", get + "Content-Length: -1\r\n\r\n", "400" },
+            { "length signed", get + "Content-Length: +5\r\n\r\n12345", "400" },
+            { "length hex", get + "Content-Length: 0x10\r\n\r\n", "400" },
+            { "length list", get + "Content-Length: 5, 5\r\n\r\n12345", "400" },
+            { "length empty", get + "Content-Length:\r\n\r\n", "400" },
+            { "length twice", get + "Content-Length: 5\r\nContent-Length: 0\r\n\r\n12345", "400" },
+            { "length overflow", get + "Content-Length: 99999999999999999999999999\r\n\r\n", "431" },
+            { "length over limit", get + "Content-Length: 16385\r\n\r\n", "431" },
+            { "chunked", get + "Transfer-Encoding: chunked\r\n\r\n5\r\nhello\r\n0\r\n\r\n", "400" },
+            { "chunked and length", get + "Transfer-Encoding: chunked\r\nContent-Length: 5\r\n\r\nhello", "400" },
+            { "length padded", get + "Content-Length:  5 \r\nConnection: close\r\n\r\n12345", "closed" },
+            { "length leading zeros", get + "Content-Length: 0005\r\nConnection: close\r\n\r\n12345", "closed" },
+            // Sizes
+            { "head over limit", get + "X-Big: " + std::string(HttpParser::kMaxHeaderBytes, 'a') + "\r\n\r\n", "431" },
+            { "head never ends", get + "X-Big: " + std::string(HttpParser::kMaxHeaderBytes + 100, 'a'), "431" },
+            { "blank lines forever", std::string(HttpParser::kMaxHeaderBytes + 2, '\n'), "431" },
+            { "too many headers", get + [] {
+                  std::string headers;
+                  for (size_t i = 0; i < HttpRequest::kMaxHeaders; ++i) headers += "X-" + std::to_string(i) + ": v\r\n";
+                  return headers + "\r\n";
+              }(), "431" },
+            { "request over limit", get + "Content-Length: 16350\r\n\r\n" + std::string(16350, 'b'), "431" },
+            { "body at limit", [&] {
+                  std::string head = get + "Connection: close\r\nContent-Length: 00000\r\n\r\n";
+                  std::string body(HttpParser::kMaxRequestBytes - head.size(), 'b');
+                  std::string length = std::to_string(body.size());
+                  head.replace(head.size() - 4 - length.size(), length.size(), length);
+                  return head + body;
+              }(), "closed" },
+            // An error ends the connection even after good requests
+            { "bad after good", get + "\r\n" + get + "\r\nGET / HTTP/9\r\n\r\n", "400" },
+        };
+
+        for (const FixedCase& c : cases) {
+            Outcome whole = ParseWhole(c.stream);
+            if (whole.end != c.end) {
+                Fail("fixed", std::string(c.name) + ": expected " + c.end + ", got " + Summary(whole));
+                continue;
+            }
+            CheckSplits(c.name, rng, c.stream, whole, kSplitsPerStream);
+        }
+    }
+
+    // ------------------------------------------------------------------
+    // Mutations of valid streams
+
+    void CheckMutations(std::mt19937& rng, const std::vector<std::string>& corpus) {
+        static const char kInteresting[] = { '\r', '\n', ' ', ':', '\t', '0', '9', '?', '#', '\0', '\x7f', '\xff' };
+        for (int i = 0; i < kMutatedStreams && !corpus.empty(); ++i) {
+            std::string stream = corpus[rng() % corpus.size()];
+            int edits = 1 + static_cast<int>(rng() % 4);
+            for (int e = 0; e < edits && !stream.empty(); ++e) {
+                size_t at = rng() % stream.size();
+                char c = rng() % 2 ? kInteresting[rng() % sizeof(kInteresting)] : static_cast<char>(rng());
+                switch (rng() % 4) {
+                    case 0: stream[at] = c; break;
+                    case 1: stream.insert(stream.begin() + static_cast<std::ptrdiff_t>(at), c); break;
+                    case 2: stream.erase(at, 1 + rng() % 8); break;
+                    default: stream.insert(at, stream.substr(rng() % stream.size(), rng() % 64)); break;
+                }
+            }
+
+            CheckSplits("mutated", rng, stream, ParseWhole(stream), 2);
+        }
+    }
+
+}
+
+int CheckHttpParser() {
+    std::mt19937 rng(kSeed);
+    std::vector<std::string> corpus;
+
+    CheckValidStreams(rng, corpus);
+    CheckFixed(rng);
+    CheckMutations(rng, corpus);
+
+    if (g_failures > 0) {
+        printf("FAIL: %d HttpParser check(s) failed (seed %u)\n", g_failures, kSeed);
+        return 1;
+    }
+    printf("OK: HttpParser, %d generated streams, %d mutated, %d splits each\n", kValidStreams, kMutatedStreams,
+           kSplitsPerStream);
+    return 0;
+}
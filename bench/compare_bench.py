@@ -0,0 +1,81 @@
+#!/usr/bin/env python3
+"""Compares two pc_monitor_bench --json results and flags regressions.
+
+    python bench/compare_bench.py baseline.json current.json [--threshold 10]
+
+A benchmark regresses when its ns/op grows by more than the threshold
+(percent), when it allocates more per op than the baseline, or when it ran
+in the baseline but is missing from the current results. Exits 1 if any
+benchmark regressed, so it can gate a build.
+"""
+
+import argparse
+import json
+import sys
+
+
+def load(path):
+    with open(path, encoding="utf-8") as f:
+        document = json.load(f)
+    if document.get("schema") != 1:
+        sys.exit(f"{path}: unsupported schema {document.get('schema')!r}")
+    return {b["name"]: b for b in document["benchmarks"]}
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Flag pc_monitor_bench regressions against a baseline")
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="allowed ns/op increase in percent (default 10)")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline)
+    current = load(args.current)
+
+    # Allocation counts are exact, but batches that wake other threads
+    # (logger, interference) vary a little with timing
+    def alloc_limit(base_allocs):
+        return base_allocs + max(0.05, base_allocs * 0.05)
+
+    regressions = 0
+    print(f"{'benchmark':36} {'baseline':>12} {'current':>12} {'change':>8}  allocs/op")
+    for name, base in baseline.items():
+        now = current.get(name)
+        if "skipped" in base:
+            continue
+        if now is None:
+            print(f"{name:36} {'':>12} {'missing':>12} {'':>8}  REGRESSION")
+            regressions += 1
+            continue
+        if "skipped" in now:
+            print(f"{name:36} {'':>12} {'skipped':>12} {'':>8}  ({now['skipped']})")
+            continue
+
+        change = (now["ns_per_op"] - base["ns_per_op"]) / base["ns_per_op"] * 100.0 if base["ns_per_op"] > 0 else 0.0
+        allocs = f"{base['allocs_per_op']:.2f} -> {now['allocs_per_op']:.2f}"
+        verdict = ""
+        if change > args.threshold:
+            verdict = "  REGRESSION (time)"
+        elif now["allocs_per_op"] > alloc_limit(base["allocs_per_op"]):
+            verdict = "  REGRESSION (allocations)"
+        elif change < -args.threshold:
+            verdict = "  improved"
+        if verdict.startswith("  REGRESSION"):
+            regressions += 1
+
+        print(f"{name:36} {base['ns_per_op']:12.1f} {now['ns_per_op']:12.1f} {change:+7.1f}%  {allocs}{verdict}")
+
+    for name in current:
+        if name not in baseline:
+            print(f"{name:36} {'new':>12}")
+
+    if regressions:
+        print(f"\n{regressions} regression(s) beyond {args.threshold:g}%")
+        return 1
+    print(f"\nNo regressions beyond {args.threshold:g}%")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,1265 @@
+// pc_monitor_bench: timings of the monitor's hot paths on synthetic
+// snapshots, so performance claims can be measured and regressions caught.
+//
+// Each benchmark sets up once, then runs batches of its operation: the batch
+// size grows until one batch takes --min-time, and the median of
+// kRepetitions batches of that size is reported as ns/op. Every heap
+// allocation in the process is counted (the global operator new below), so
+// allocs/op covers background threads a benchmark wakes as well.
+//
+//     pc_monitor_bench [--filter <text>] [--min-time <s>] [--json <file>] [--list]
+//                      [--fixtures <dir>]
+//     pc_monitor_bench --check-allocations
+//     pc_monitor_bench --check-http-parser
+//
+// --json writes the results for bench/compare_bench.py. --check-allocations
+// runs full monitor ticks from a replayed recording instead and exits 1 if
+// any tick after warm-up allocates. --check-http-parser feeds generated,
+// malformed and mutated requests to HttpParser in random splits
+// (check_http_parser.cpp) and exits 1 on any mismatch.
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+
+// Prevent old winsock.h from being included
+#ifndef WINSOCK_API_LINKAGE
+#define WINSOCK_API_LINKAGE
+#endif
+
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <mmsystem.h>
+
+#include "performance_monitor.h"
+#include "metrics_serializer.h"
+#include "metrics_projection.h"
+#include "binary_codec.h"
+#include "prometheus_exporter.h"
+#include "snapshot_cache.h"
+#include "data_logger.h"
+#include "http_parser.h"
+#include "log_export.h"
+#include "shared_memory_publisher.h"
+#include "pcmonitor_shm.h"
+#include "window_stats.h"
+#include "anomaly_detector.h"
+#include "alert_engine.h"
+#include "correlation_matrix.h"
+#include "trend_forecaster.h"
+#include "agent_policy.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <queue>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#pragma comment(lib, "ws2_32.lib")
+#pragma comment(lib, "winmm.lib")
+
+#ifndef PCMONITOR_BENCH_FIXTURES
+#define PCMONITOR_BENCH_FIXTURES "bench/fixtures"
+#endif
+
+// Allocation counting: every operator new in the process goes through here
+static std::atomic<uint64_t> g_allocations(0);
+
+void* operator new(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+// HttpParser robustness check (check_http_parser.cpp)
+int CheckHttpParser();
+
+using namespace PCMonitor;
+
+namespace {
+
+    constexpr int kRepetitions = 3;
+    constexpr size_t kFrameCount = 64;
+
+    struct Options {
+        std::string filter;
+        double min_time = 0.5;
+        std::string json_path;
+        std::string fixtures = PCMONITOR_BENCH_FIXTURES;
+        bool list = false;
+        bool check_allocations = false;
+        bool check_http_parser = false;
+    };
+
+    // What a benchmark's setup hands the runner. State the operation needs
+    // lives in objects captured by run and is torn down with the Case.
+    struct Case {
+        std::function<void(uint64_t iterations)> run;
+        std::function<void()> reset;        // Untimed, after every batch
+        uint64_t bytes_per_op = 0;          // Input or output size, for MB/s
+        uint64_t max_iterations = 0;        // Per batch; 0: no limit
+        std::string skipped;                // Why it couldn't be set up
+    };
+
+    struct Benchmark {
+        const char* name;
+        const char* description;
+        Case (*setup)(const Options& options);
+    };
+
+    struct Result {
+        const Benchmark* benchmark;
+        uint64_t iterations;                // Per batch
+        double ns_per_op;
+        double allocs_per_op;
+        uint64_t bytes_per_op;
+        std::string skipped;
+    };
+
+    // Keeps results observable so the optimizer can't drop the work
+    volatile uint64_t g_sink = 0;
+
+    // ------------------------------------------------------------------
+    // Inputs
+
+    void WriteField(SystemMetrics& metrics, const FieldInfo& field, double value) {
+        char* base = reinterpret_cast<char*>(&metrics) + field.offset;
+        switch (field.type) {
+            case FieldType::U32: {
+                uint32_t v = static_cast<uint32_t>(value);
+                memcpy(base, &v, sizeof(v));
+                break;
+            }
+            case FieldType::U64: {
+                uint64_t v = static_cast<uint64_t>(value);
+                memcpy(base, &v, sizeof(v));
+                break;
+            }
+            case FieldType::F64:
+                memcpy(base, &value, sizeof(value));
+                break;
+            case FieldType::U32Array: {
+                FanSpeeds& fans = *reinterpret_cast<FanSpeeds*>(base);
+                fans.clear();
+                for (uint32_t i = 0; i < 4; ++i) fans.push_back(static_cast<uint32_t>(value * 20.0) + i * 150);
+                break;
+            }
+        }
+    }
+
+    // kFrameCount snapshots in which every field moves (a sine per field,
+    // out of phase with the others), cycled by the benchmarks so encoders
+    // and detectors see changing values without computing them per op
+    const std::vector<MetricsSnapshot>& Frames() {
+        static const std::vector<MetricsSnapshot> frames = [] {
+            std::vector<MetricsSnapshot> result(kFrameCount);
+            int64_t start = static_cast<int64_t>(std::time(nullptr));
+            for (size_t f = 0; f < kFrameCount; ++f) {
+                MetricsSnapshot& snapshot = result[f];
+                snapshot.version = f + 1;
+                snapshot.timestamp = start + static_cast<int64_t>(f);
+                snapshot.metrics = SystemMetrics{};
+
+                size_t index = 0;
+                for (const FieldGroup& group : kMetricGroups) {
+                    for (size_t i = 0; i < group.field_count; ++i, ++index) {
+                        double level = 20.0 + static_cast<double>((index * 13) % 60);
+                        double wave = 10.0 * std::sin(6.283185307 * static_cast<double>(f) / kFrameCount + index);
+                        WriteField(snapshot.metrics, group.fields[i], level + wave);
+                    }
+                }
+            }
+            return result;
+        }();
+        return frames;
+    }
+
+    const MetricsSnapshot& Frame(uint64_t i) {
+        return Frames()[i % kFrameCount];
+    }
+
+    // Fixture text with LF line endings made CRLF (HTTP requests are kept
+    // as plain text in the repository)
+    bool LoadFixture(const Options& options, const char* name, std::string& out) {
+        std::ifstream file(options.fixtures + "/" + name, std::ios::binary);
+        if (!file.is_open()) return false;
+
+        std::ostringstream text;
+        text << file.rdbuf();
+        out.clear();
+        for (char c : text.str()) {
+            if (c == '\r') continue;
+            if (c == '\n') out += '\r';
+            out += c;
+        }
+        return true;
+    }
+
+    Case Skip(std::string reason) {
+        Case c;
+        c.skipped = std::move(reason);
+        return c;
+    }
+
+    std::string TempPath(const char* name) {
+        std::error_code error;
+        std::filesystem::path directory = std::filesystem::temp_directory_path(error);
+        return (error ? std::filesystem::path(name) : directory / name).string();
+    }
+
+    // ------------------------------------------------------------------
+    // Serialization
+
+    // What the generated serializer replaced: a string built by concatenating
+    // per-field temporaries
+    void WriteJsonByConcatenation(const MetricsSnapshot& snapshot, std::string& out) {
+        out += "{\"timestamp\":" + std::to_string(snapshot.timestamp) + ",\"version\":" + std::to_string(snapshot.version);
+        for (const FieldGroup& group : kMetricGroups) {
+            out += ",\"" + std::string(group.name) + "\":{";
+            for (size_t i = 0; i < group.field_count; ++i) {
+                const FieldInfo& field = group.fields[i];
+                if (i > 0) out += ",";
+                out += "\"" + std::string(field.name) + "\":";
+                if (field.type == FieldType::U32Array) {
+                    const FanSpeeds& fans = *reinterpret_cast<const FanSpeeds*>(
+                        reinterpret_cast<const char*>(&snapshot.metrics) + field.offset);
+                    out += "[";
+                    for (size_t k = 0; k < fans.size(); ++k) {
+                        out += (k > 0 ? "," : "") + std::to_string(fans[k]);
+                    }
+                    out += "]";
+                } else {
+                    out += std::to_string(ReadScalarField(snapshot.metrics, field));
+                }
+            }
+            out += "}";
+        }
+        out += "}";
+    }
+
+    Case SetupSerializeJson(const Options&) {
+        auto out = std::make_shared<std::string>();
+        out->reserve(8192);
+        WriteMetricsJson(Frame(0), *out);
+
+        Case c;
+        c.bytes_per_op = out->size();
+        c.run = [out](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; ++i) {
+                out->clear();
+                WriteMetricsJson(Frame(i), *out);
+            }
+            g_sink += out->size();
+        };
+        return c;
+    }
+
+    Case SetupSerializeJsonConcat(const Options&) {
+        auto out = std::make_shared<std::string>();
+        out->reserve(8192);
+        WriteJsonByConcatenation(Frame(0), *out);
+
+        Case c;
+        c.bytes_per_op = out->size();
+        c.run = [out](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; ++i) {
+                out->clear();
+                WriteJsonByConcatenation(Frame(i), *out);
+            }
+            g_sink += out->size();
+        };
+        return c;
+    }
+
+    Case SetupSerializeCbor(const Options&) {
+        Case c;
+        c.bytes_per_op = EncodeMetricsCbor(Frame(0)).size();
+        c.run = [](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; ++i) {
+                g_sink += EncodeMetricsCbor(Frame(i)).size();
+            }
+        };
+        return c;
+    }
+
+    // DataLogger::FormatLogEntry is this call with the entry's time
+    Case SetupSerializeCsvRow(const Options&) {
+        auto out = std::make_shared<std::string>();
+        out->reserve(2048);
+        WriteCsvRow(Frame(0).timestamp, Frame(0).metrics, *out);
+
+        Case c;
+        c.bytes_per_op = out->size();
+        c.run = [out](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; ++i) {
+                out->clear();
+                const MetricsSnapshot& snapshot = Frame(i);
+                WriteCsvRow(snapshot.timestamp, snapshot.metrics, *out);
+            }
+            g_sink += out->size();
+        };
+        return c;
+    }
+
+    Case SetupSerializePrometheus(const Options&) {
+        struct State {
+            PrometheusExporter exporter;
+            CollectorLatencies latencies = {};
+            ServerStats stats;
+            std::string out;
+        };
+        auto state = std::make_shared<State>();
+        state->exporter.Render(Frame(0), state->latencies, state->stats, state->out);
+
+        Case c;
+        c.bytes_per_op = state->out.size();
+        c.run = [state](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; ++i) {
+                state->out.clear();
+                state->exporter.Render(Frame(i), state->latencies, state->stats, state->out);
+            }
+            g_sink += state->out.size();
+        };
+        return c;
+    }
+
+    // ------------------------------------------------------------------
+    // Logging and thread handoff
+
+    // The producer side of DataLogger: what the monitoring thread pays per
+    // logged snapshot. The writer thread is restarted between batches,
+    // dropping whatever it hadn't written, so the backlog stays bounded.
+    Case SetupLoggerLogMetrics(const Options&) {
+        struct State {
+            std::string path = TempPath("pc_monitor_bench_log.csv");
+            std::unique_ptr<DataLogger> logger;
+
+            bool Start() {
+                logger = std::make_unique<DataLogger>(path, 1024, false);
+                return logger->Initialize();
+            }
+            ~State() {
+                if (logger) logger->Shutdown();
+                logger.reset();
+                std::error_code error;
+                std::filesystem::remove(path, error);
+            }
+        };
+        auto state = std::make_shared<State>();
+        if (!state->Start()) return Skip("cannot open " + state->path);
+
+        Case c;
+        c.max_iterations = 20000;
+        c.run = [state](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; ++i) {
+                state->logger->LogMetrics(Frame(i).metrics);
+            }
+        };
+        c.reset = [state] {
+            state->logger->Shutdown();
+            state->Start();
+        };
+        return c;
+    }
+
+    // One snapshot through a mutex + condition variable queue to another
+    // thread and the acknowledgement back: the wake-up cost every
+    // producer/consumer pair in the monitor pays (logger, notifier, streams)
+    Case SetupQueueHandoff(const Options&) {
+        struct State {
+            std::mutex mutex;
+            std::condition_variable cv;
+            std::queue<SystemMetrics> queue;
+            uint64_t produced = 0;
+            uint64_t consumed = 0;
+            bool stop = false;
+            std::thread consumer;
+
+            ~State() {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    stop = true;
+                }
+                cv.notify_all();
+                if (consumer.joinable()) consumer.join();
+            }
+        };
+        auto state = std::make_shared<State>();
+        // A plain pointer: the State joins the thread before it goes away
+        State* raw = state.get();
+        state->consumer = std::thread([raw] {
+            std::unique_lock<std::mutex> lock(raw->mutex);
+            for (;;) {
+                raw->cv.wait(lock, [raw] { return !raw->queue.empty() || raw->stop; });
+                if (raw->queue.empty()) break;
+                g_sink += raw->queue.front().cpu.core_count;
+                raw->queue.pop();
+                raw->consumed++;
+                raw->cv.notify_all();
+            }
+        });
+
+        Case c;
+        c.run = [state](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; ++i) {
+                std::unique_lock<std::mutex> lock(state->mutex);
+                state->queue.push(Frame(i).metrics);
+                uint64_t target = ++state->produced;
+                state->cv.notify_all();
+                state->cv.wait(lock, [&state, target] { return state->consumed == target; });
+            }
+        };
+        return c;
+    }
+
+    // ------------------------------------------------------------------
+    // Parsing
+
+    Case SetupParseHttp(const Options& options, const char* fixture) {
+        std::string text;
+        if (!LoadFixture(options, fixture, text)) {
+            return Skip("missing fixture " + options.fixtures + "/" + fixture);
+        }
+        auto input = std::make_shared<std::string>(std::move(text));
+        auto parser = std::make_shared<HttpParser>();
+
+        Case c;
+        c.bytes_per_op = input->size();
+        c.run = [input, parser](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; ++i) {
+                size_t offset = 0;
+                while (offset < input->size()) {
+                    HttpRequest request;
+                    size_t consumed = 0;
+                    if (parser->Parse(input->data() + offset, input->size() - offset, request, consumed) !=
+                        HttpParser::Result::Complete) {
+                        break;
+                    }
+                    offset += consumed;
+                    g_sink += request.header_count;
+                }
+            }
+        };
+        return c;
+    }
+
+    Case SetupParseHttpGet(const Options& options) {
+        return SetupParseHttp(options, "browser_get.http");
+    }
+
+    Case SetupParseHttpPipelined(const Options& options) {
+        return SetupParseHttp(options, "pipelined.http");
+    }
+
+    // /api/history over ten minutes of 1 Hz log rows: reading, splitting
+    // and re-encoding the CSV log
+    Case SetupParseCsvHistory(const Options&) {
+        struct State {
+            std::string path = TempPath("pc_monitor_bench_history.csv");
+            std::string out;
+            ~State() {
+                std::error_code error;
+                std::filesystem::remove(path, error);
+            }
+        };
+        auto state = std::make_shared<State>();
+        {
+            std::ofstream file(state->path, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) return Skip("cannot write " + state->path);
+
+            std::string row;
+            file << GetCsvHeader();
+            for (uint64_t i = 0; i < 600; ++i) {
+                row.clear();
+                WriteCsvRow(Frame(0).timestamp + static_cast<int64_t>(i), Frame(i).metrics, row);
+                file << row;
+            }
+        }
+
+        Case c;
+        std::error_code error;
+        c.bytes_per_op = static_cast<uint64_t>(std::filesystem::file_size(state->path, error));
+        c.run = [state](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; ++i) {
+                BodyGenerator generator = MakeJsonHistory(state->path, ExportRange{ 0, 0 });
+                bool more = true;
+                while (more) {
+                    state->out.clear();
+                    more = generator(state->out);
+                    g_sink += state->out.size();
+                }
+            }
+        };
+        return c;
+    }
+
+    Case SetupParseAlertRules(const Options& options) {
+        std::string path = options.fixtures + "/alerts.rules";
+        std::string error;
+        if (!AlertEngine(std::chrono::milliseconds(1000)).LoadFile(path, error)) {
+            return Skip(error);
+        }
+
+        Case c;
+        std::error_code size_error;
+        c.bytes_per_op = static_cast<uint64_t>(std::filesystem::file_size(path, size_error));
+        c.run = [path](uint64_t iterations) {
+            std::string error;
+            for (uint64_t i = 0; i < iterations; ++i) {
+                AlertEngine engine(std::chrono::milliseconds(1000));
+                engine.LoadFile(path, error);
+                g_sink += engine.GetRuleCount();
+            }
+        };
+        return c;
+    }
+
+    // ------------------------------------------------------------------
+    // Publication and reads
+
+    // A monitor publishing into shared memory and /api/stats, the
+    // listeners every run of pc_monitor has
+    struct Publisher {
+        PerformanceMonitor monitor;
+        SharedMemoryPublisher shared_memory;
+        WindowStats window_stats;
+
+        Publisher() : window_stats(monitor) {}
+    };
+
+    const char* const kSharedMemoryInUse = "shared memory is in use (stop pc_monitor first)";
+
+    Case SetupPublishSnapshot(const Options&) {
+        auto publisher = std::make_shared<Publisher>();
+        if (!publisher->shared_memory.Open(publisher->monitor)) return Skip(kSharedMemoryInUse);
+
+        Case c;
+        c.run = [publisher](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; ++i) {
+                publisher->monitor.PublishMetrics(Frame(i).metrics);
+            }
+        };
+        return c;
+    }
+
+    // A full tick with one client per format: publish, then the cached
+    // JSON and CBOR encodings and a Prometheus scrape
+    Case SetupPublishTickEncoded(const Options&) {
+        struct State : Publisher {
+            SnapshotCache json;
+            SnapshotCache cbor;
+            PrometheusExporter exporter;
+            CollectorLatencies latencies = {};
+            ServerStats stats;
+            std::string scrape;
+
+            State()
+                : json(monitor, EncodeMetricsJson, "application/json")
+                , cbor(monitor, EncodeMetricsCbor, "application/cbor")
+            {
+            }
+        };
+        auto state = std::make_shared<State>();
+        if (!state->shared_memory.Open(state->monitor)) return Skip(kSharedMemoryInUse);
+
+        Case c;
+        c.run = [state](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; ++i) {
+                state->monitor.PublishMetrics(Frame(i).metrics);
+                g_sink += state->json.Get()->response.size();
+                g_sink += state->cbor.Get()->response.size();
+                state->scrape.clear();
+                state->exporter.Render(state->monitor.GetSnapshot(), state->latencies, state->stats, state->scrape);
+            }
+        };
+        return c;
+    }
+
+    Case SetupReadSharedMemory(const Options&) {
+        struct State : Publisher {
+            pcmon_shm_reader reader = {};
+            ~State() { pcmon_shm_close(&reader); }
+        };
+        auto state = std::make_shared<State>();
+        if (!state->shared_memory.Open(state->monitor)) return Skip(kSharedMemoryInUse);
+        state->monitor.PublishMetrics(Frame(0).metrics);
+        if (pcmon_shm_open(&state->reader) != 0) return Skip("cannot map " PCMON_SHM_NAME);
+
+        Case c;
+        c.bytes_per_op = sizeof(pcmon_shm_sample);
+        c.run = [state](uint64_t iterations) {
+            pcmon_shm_sample sample;
+            for (uint64_t i = 0; i < iterations; ++i) {
+                if (pcmon_shm_read_latest(&state->reader, &sample) == 0) {
+                    g_sink += sample.version;
+                }
+            }
+        };
+        return c;
+    }
+
+    // Serves one keep-alive connection the way the web server does: parse
+    // every complete request in what arrived, answer each from the cache
+    void ServeLoopback(SOCKET socket, SnapshotCache& cache) {
+        AgentPolicy::ApplyToCurrentThread(ThreadRole::Worker);
+
+        std::vector<char> buffer(HttpParser::kMaxRequestBytes);
+        HttpParser parser;
+        size_t size = 0;
+        for (;;) {
+            int received = recv(socket, buffer.data() + size, static_cast<int>(buffer.size() - size), 0);
+            if (received <= 0) break;
+            size += static_cast<size_t>(received);
+
+            size_t offset = 0;
+            for (;;) {
+                HttpRequest request;
+                size_t consumed = 0;
+                auto result = parser.Parse(buffer.data() + offset, size - offset, request, consumed);
+                if (result == HttpParser::Result::Incomplete) break;
+                if (result != HttpParser::Result::Complete) {
+                    closesocket(socket);
+                    return;
+                }
+                offset += consumed;
+
+                auto entry = cache.Get();
+                send(socket, entry->response.data(), static_cast<int>(entry->response.size()), 0);
+            }
+            if (offset > 0) {
+                memmove(buffer.data(), buffer.data() + offset, size - offset);
+                size -= offset;
+            }
+        }
+        closesocket(socket);
+    }
+
+    // GET /api/metrics over a kept-alive 127.0.0.1 connection: request out,
+    // parse, cached response back, read to its last byte
+    Case SetupReadHttpLoopback(const Options& options) {
+        struct State {
+            PerformanceMonitor monitor;
+            SnapshotCache cache;
+            SOCKET listener = INVALID_SOCKET;
+            SOCKET client = INVALID_SOCKET;
+            std::thread server;
+            std::string request;
+            std::vector<char> response;
+
+            State() : cache(monitor, EncodeMetricsJson, "application/json") {}
+            ~State() {
+                if (client != INVALID_SOCKET) closesocket(client);
+                if (server.joinable()) server.join();
+                if (listener != INVALID_SOCKET) closesocket(listener);
+            }
+        };
+        auto state = std::make_shared<State>();
+        if (!LoadFixture(options, "browser_get.http", state->request)) {
+            return Skip("missing fixture " + options.fixtures + "/browser_get.http");
+        }
+        state->monitor.PublishMetrics(Frame(0).metrics);
+        state->response.resize(state->cache.Get()->response.size());
+
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = 0;
+        int length = sizeof(address);
+
+        state->listener = socket(AF_INET, SOCK_STREAM, 0);
+        if (state->listener == INVALID_SOCKET ||
+            bind(state->listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == SOCKET_ERROR ||
+            listen(state->listener, 1) == SOCKET_ERROR ||
+            getsockname(state->listener, reinterpret_cast<sockaddr*>(&address), &length) == SOCKET_ERROR) {
+            return Skip("cannot listen on 127.0.0.1");
+        }
+
+        state->client = socket(AF_INET, SOCK_STREAM, 0);
+        if (state->client == INVALID_SOCKET ||
+            connect(state->client, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == SOCKET_ERROR) {
+            return Skip("cannot connect to 127.0.0.1");
+        }
+        SOCKET connection = accept(state->listener, nullptr, nullptr);
+        if (connection == INVALID_SOCKET) return Skip("accept failed");
+
+        int no_delay = 1;
+        setsockopt(state->client, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&no_delay), sizeof(no_delay));
+        setsockopt(connection, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&no_delay), sizeof(no_delay));
+        State* raw = state.get();
+        state->server = std::thread([raw, connection] { ServeLoopback(connection, raw->cache); });
+
+        Case c;
+        c.bytes_per_op = state->response.size();
+        c.run = [state](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; ++i) {
+                send(state->client, state->request.data(), static_cast<int>(state->request.size()), 0);
+                size_t received = 0;
+                while (received < state->response.size()) {
+                    int n = recv(state->client, state->response.data() + received,
+                                 static_cast<int>(state->response.size() - received), 0);
+                    if (n <= 0) return;
+                    received += static_cast<size_t>(n);
+                }
+            }
+        };
+        return c;
+    }
+
+    // ------------------------------------------------------------------
+    // Per-snapshot consumers
+
+    // Every field plus 256 device series, about what a 64-thread machine
+    // with several disks and adapters feeds it from DeviceSampler
+    Case SetupDetectAnomaly(const Options&) {
+        constexpr size_t kExtraSeries = 256;
+        std::vector<std::string> names;
+        for (size_t i = 0; i < kExtraSeries; ++i) names.push_back("device." + std::to_string(i));
+
+        struct State {
+            AnomalyDetector detector;
+            std::vector<float> extra;
+            State(std::vector<std::string> names)
+                : detector(AnomalyDetector::Settings{}, std::move(names)), extra(kExtraSeries * kFrameCount) {}
+        };
+        auto state = std::make_shared<State>(std::move(names));
+        for (size_t i = 0; i < state->extra.size(); ++i) {
+            state->extra[i] = static_cast<float>(50.0 + 40.0 * std::sin(static_cast<double>(i) * 0.37));
+        }
+
+        Case c;
+        c.run = [state](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; ++i) {
+                state->detector.Evaluate(Frame(i), &state->extra[(i % kFrameCount) * kExtraSeries]);
+            }
+        };
+        return c;
+    }
+
+    Case SetupDetectAlerts(const Options& options) {
+        auto engine = std::make_shared<AlertEngine>(std::chrono::milliseconds(1000));
+        std::string error;
+        if (!engine->LoadFile(options.fixtures + "/alerts.rules", error)) return Skip(error);
+
+        Case c;
+        c.run = [engine](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; ++i) {
+                engine->Evaluate(Frame(i));
+            }
+        };
+        return c;
+    }
+
+    // The budget case: 1000 rules, generated by cycling every scalar field
+    // through last/avg/min/max over a few windows, with some `for` and
+    // `clear` clauses so pending and hysteresis paths run too
+    Case SetupDetectAlerts1000(const Options&) {
+        constexpr size_t kRules = 1000;
+        static const char* const kAggregates[] = { "", "avg", "min", "max" };
+        static const char* const kWindows[] = { "10s", "1m", "5m" };
+
+        std::vector<std::string> fields;
+        for (const FieldGroup& group : kMetricGroups) {
+            for (size_t f = 0; f < group.field_count; ++f) {
+                if (group.fields[f].type == FieldType::U32Array) continue;
+                fields.push_back(std::string(group.name) + "." + group.fields[f].name);
+            }
+        }
+
+        auto engine = std::make_shared<AlertEngine>(std::chrono::milliseconds(1000));
+        for (size_t r = 0; r < kRules; ++r) {
+            size_t round = r / fields.size();
+            const char* aggregate = kAggregates[round % 4];
+            const char* window = kWindows[(round / 4 + r) % 3];
+            std::string operand = fields[r % fields.size()];
+            if (*aggregate) operand = std::string(aggregate) + "(" + operand + ", " + window + ")";
+
+            bool above = r % 2 == 0;
+            double threshold = static_cast<double>(r % 10) * 10.0;
+            std::string rule = "rule_" + std::to_string(r) + ": " + operand + (above ? " > " : " < ") +
+                               std::to_string(threshold);
+            if (r % 3 == 0) rule += " for 30s";
+            if (r % 5 == 0) rule += " clear " + std::to_string(above ? threshold - 5.0 : threshold + 5.0);
+
+            std::string error;
+            if (!engine->AddRule(rule, error)) return Skip(rule + ": " + error);
+        }
+
+        Case c;
+        c.run = [engine](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; ++i) {
+                engine->Evaluate(Frame(i));
+            }
+        };
+        return c;
+    }
+
+    // Snapshot fields plus 128 device series, about what a 32-thread
+    // machine with a few disks and adapters produces
+    Case SetupDetectCorrelations(const Options&) {
+        constexpr size_t kExtraSeries = 128;
+        std::vector<std::string> names;
+        for (size_t i = 0; i < kExtraSeries; ++i) names.push_back("device." + std::to_string(i));
+
+        struct State {
+            CorrelationMatrix matrix;
+            std::vector<float> extra;
+            State(std::vector<std::string> names) : matrix(300, std::move(names)), extra(kExtraSeries * kFrameCount) {}
+        };
+        auto state = std::make_shared<State>(std::move(names));
+        for (size_t i = 0; i < state->extra.size(); ++i) {
+            state->extra[i] = static_cast<float>(50.0 + 40.0 * std::sin(static_cast<double>(i) * 0.37));
+        }
+
+        Case c;
+        c.run = [state](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; ++i) {
+                state->matrix.Add(Frame(i), &state->extra[(i % kFrameCount) * kExtraSeries]);
+            }
+        };
+        return c;
+    }
+
+    Case SetupDetectForecasts(const Options&) {
+        auto forecaster = std::make_shared<TrendForecaster>(TrendForecaster::Settings{}, std::chrono::milliseconds(1000));
+
+        Case c;
+        c.run = [forecaster](uint64_t iterations) {
+            for (uint64_t i = 0; i < iterations; ++i) {
+                forecaster->Add(Frame(i));
+            }
+        };
+        return c;
+    }
+
+    // ------------------------------------------------------------------
+    // Interference: the same stand-in workload alone and with the
+    // monitor's pipeline running beside it at 1 kHz (publish, encode,
+    // scrape), to see what sampling costs the machine's real work
+
+    constexpr size_t kKernelFloats = 256 * 1024;   // 1 MB, about an L2's worth
+
+    float RunKernel(std::vector<float>& data) {
+        float sum = 0.0f;
+        for (float& v : data) {
+            v = v * 0.999f + 1.0f;
+            sum += v;
+        }
+        return sum;
+    }
+
+    Case MakeKernelCase(std::shared_ptr<void> background) {
+        auto data = std::make_shared<std::vector<float>>(kKernelFloats, 1.0f);
+
+        Case c;
+        c.bytes_per_op = kKernelFloats * sizeof(float);
+        c.run = [data, background](uint64_t iterations) {
+            float sum = 0.0f;
+            for (uint64_t i = 0; i < iterations; ++i) sum += RunKernel(*data);
+            g_sink += static_cast<uint64_t>(sum);
+        };
+        return c;
+    }
+
+    Case SetupKernelAlone(const Options&) {
+        return MakeKernelCase(nullptr);
+    }
+
+    Case SetupKernelWithPipeline(const Options&) {
+        struct Pipeline : Publisher {
+            SnapshotCache json;
+            SnapshotCache cbor;
+            PrometheusExporter exporter;
+            std::atomic<bool> running;
+            std::thread thread;
+
+            Pipeline()
+                : json(monitor, EncodeMetricsJson, "application/json")
+                , cbor(monitor, EncodeMetricsCbor, "application/cbor")
+                , running(true)
+            {
+                // Without the mapping (pc_monitor running) the rest still runs
+                shared_memory.Open(monitor);
+                thread = std::thread([this] {
+                    AgentPolicy::ApplyToCurrentThread(ThreadRole::Sampler);
+                    timeBeginPeriod(1);
+
+                    CollectorLatencies latencies = {};
+                    ServerStats stats;
+                    std::string scrape;
+                    for (uint64_t i = 0; running; ++i) {
+                        monitor.PublishMetrics(Frame(i).metrics);
+                        g_sink += json.Get()->response.size() + cbor.Get()->response.size();
+                        scrape.clear();
+                        exporter.Render(monitor.GetSnapshot(), latencies, stats, scrape);
+                        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                    }
+
+                    timeEndPeriod(1);
+                });
+            }
+            ~Pipeline() {
+                running = false;
+                thread.join();
+            }
+        };
+        return MakeKernelCase(std::make_shared<Pipeline>());
+    }
+
+    const Benchmark kBenchmarks[] = {
+        { "serialize.json", "WriteMetricsJson, the /api/metrics document", SetupSerializeJson },
+        { "serialize.json_concat", "The same document by string concatenation (baseline)", SetupSerializeJsonConcat },
+        { "serialize.cbor", "EncodeMetricsCbor, /api/metrics.bin", SetupSerializeCbor },
+        { "serialize.csv_row", "WriteCsvRow, DataLogger::FormatLogEntry", SetupSerializeCsvRow },
+        { "serialize.prometheus", "PrometheusExporter::Render, /metrics", SetupSerializePrometheus },
+        { "logger.log_metrics", "DataLogger::LogMetrics with the writer thread running", SetupLoggerLogMetrics },
+        { "queue.handoff", "Snapshot to another thread and back through a locked queue", SetupQueueHandoff },
+        { "parse.http_get", "HttpParser on a browser GET (fixture)", SetupParseHttpGet },
+        { "parse.http_pipelined", "HttpParser on 8 pipelined requests (fixture)", SetupParseHttpPipelined },
+        { "parse.csv_history", "/api/history over a 600-row CSV log", SetupParseCsvHistory },
+        { "parse.alert_rules", "AlertEngine::LoadFile on 40 rules (fixture)", SetupParseAlertRules },
+        { "publish.snapshot", "PublishMetrics into shared memory and window stats", SetupPublishSnapshot },
+        { "publish.tick_encoded", "Publish plus JSON, CBOR and Prometheus encodings", SetupPublishTickEncoded },
+        { "read.shm_latest", "pcmon_shm_read_latest from the shared memory view", SetupReadSharedMemory },
+        { "read.http_loopback", "GET /api/metrics over keep-alive loopback TCP", SetupReadHttpLoopback },
+        { "detect.anomaly", "AnomalyDetector::Evaluate over every field and 256 device series", SetupDetectAnomaly },
+        { "detect.alerts", "AlertEngine::Evaluate on 40 rules (fixture)", SetupDetectAlerts },
+        { "detect.alerts_1000", "AlertEngine::Evaluate on 1000 generated rules", SetupDetectAlerts1000 },
+        { "detect.correlations", "CorrelationMatrix::Add with 128 device series", SetupDetectCorrelations },
+        { "detect.forecasts", "TrendForecaster::Add with the default series", SetupDetectForecasts },
+        { "interference.kernel_alone", "A 1 MB streaming kernel on an idle machine", SetupKernelAlone },
+        { "interference.kernel_with_pipeline", "The same kernel with a 1 kHz publish/encode loop beside it", SetupKernelWithPipeline },
+    };
+
+    // ------------------------------------------------------------------
+    // Allocation check (--check-allocations)
+    //
+    // The sampling and publishing path must not touch the heap once warm
+    // (metrics_types.h). A synthetic recording is replayed through a real
+    // PerformanceMonitor with the listeners every pc_monitor run has, so
+    // each tick is the full RunCycle: collectors, publish, CSV log, shared
+    // memory and window stats. Any allocation in a tick after warm-up fails
+    // the check.
+
+    constexpr uint32_t kCheckTicks = 1000;          // Rolls every 1m and 1h stats bucket
+    constexpr uint32_t kCheckWarmupTicks = 120;
+    constexpr uint32_t kCheckBurstsPerTick = 4;
+
+    bool WriteCheckRecording(const std::string& path, std::string& error) {
+        RecordingHeader header = { 8, 16, 1000, 1000 / (kCheckBurstsPerTick + 1), static_cast<int64_t>(std::time(nullptr)) };
+        RecordingWriter writer;
+        if (!writer.Open(path, header, error)) return false;
+
+        auto start = std::chrono::steady_clock::now();
+        CollectorInputs in = {};
+        for (uint32_t t = 0; t < kCheckTicks; ++t) {
+            double phase = t * 0.05;
+            auto cycle_start = start + std::chrono::milliseconds(t * 1000ull);
+
+            for (uint32_t b = 1; b <= kCheckBurstsPerTick; ++b) {
+                double burst[kRecordedBurstSeries] = {
+                    50.0 + 45.0 * std::sin(phase + b),
+                    2e8 * (1.0 + std::sin(phase * 3.0 + b)),
+                    1e8 * (1.0 + std::cos(phase * 2.0 + b)),
+                    5e6 * (1.0 + std::sin(phase * 5.0 + b)),
+                    NAN,                                        // A series that never formats
+                };
+                writer.WriteBurst(cycle_start + header.burst_interval_ms * b * std::chrono::milliseconds(1), burst);
+            }
+
+            in.gpu_vram_total_mb = 16384;
+            in.gpu_vram_used_mb = 8192 + 2048 * std::sin(phase);
+            in.gpu_core_clock_mhz = 2400 + 200 * std::sin(phase * 2.0);
+            in.gpu_memory_clock_mhz = 10000;
+            in.gpu_temperature_c = 70 + 10 * std::sin(phase);
+            in.gpu_power_draw_w = 250 + 80 * std::sin(phase * 1.5);
+            in.gpu_power_measured = 1;
+            in.gpu_utilization_percent = 50 + 45 * std::sin(phase * 1.5);
+            in.gpu_memory_bandwidth_mbps = NAN;
+            in.cpu_utilization_percent = 50 + 45 * std::sin(phase);
+            // Now and then a counter fails to read, as PDH counters do
+            in.cpu_frequency_mhz = t % 50 == 49 ? NAN : 3600 + 400 * std::sin(phase * 0.5);
+            in.cpu_effective_clock_mhz = 3500 + 400 * std::sin(phase * 0.5);
+            in.cpu_performance_limit_percent = t % 200 < 20 ? 80 : 100;
+            in.cpu_throttled_cores = t % 200 < 20 ? 2 : 0;
+            in.cpu_throttled_seconds = (t / 200) * 20.0 + (t % 200 < 20 ? t % 200 : 20);
+            in.cpu_frequency_loss_mhz = t % 200 < 20 ? 600 : 0;
+            in.memory_total_bytes = 32.0 * 1024 * 1024 * 1024;
+            in.memory_available_bytes = in.memory_total_bytes * (0.5 + 0.3 * std::sin(phase * 0.2));
+            in.memory_load_percent = 50 - 30 * std::sin(phase * 0.2);
+            in.disk_read_bytes_per_sec = 2e8 * (1.0 + std::sin(phase * 3.0));
+            in.disk_write_bytes_per_sec = 1e8 * (1.0 + std::cos(phase * 2.0));
+            in.volume_used_gb = 700 + t * 0.01;
+            in.volume_capacity_gb = 953.8;
+            in.net_received_bytes_per_sec = 5e6 * (1.0 + std::sin(phase * 5.0));
+            in.net_sent_bytes_per_sec = t % 50 == 25 ? NAN : 1e6;
+            in.package_power_w = 65 + 40 * std::sin(phase);
+            in.dram_power_w = 4 + std::sin(phase);
+            writer.WriteCycle(cycle_start + std::chrono::milliseconds(1000), in);
+        }
+        writer.Close();
+        return true;
+    }
+
+    int CheckAllocations() {
+        std::filesystem::path directory = std::filesystem::temp_directory_path();
+        std::string recording_path = (directory / "pc_monitor_bench_check.pmrec").string();
+        std::string log_path = (directory / "pc_monitor_bench_check.csv").string();
+        std::error_code ignored;
+        std::filesystem::remove(log_path, ignored);
+
+        std::string error;
+        if (!WriteCheckRecording(recording_path, error)) {
+            fprintf(stderr, "Cannot write the recording: %s\n", error.c_str());
+            return 1;
+        }
+
+        int status = 0;
+        {
+            Publisher pipeline;
+            pipeline.monitor.SetReplayFile(recording_path, 0.0);
+            pipeline.monitor.SetLogFile(log_path);
+            if (!pipeline.monitor.Initialize()) {
+                fprintf(stderr, "Cannot replay %s\n", recording_path.c_str());
+                return 1;
+            }
+            if (!pipeline.shared_memory.Open(pipeline.monitor)) {
+                printf("note: %s; checking without it\n", kSharedMemoryInUse);
+            }
+
+            for (uint32_t t = 0; t < kCheckWarmupTicks; ++t) {
+                pipeline.monitor.ReplayCycle();
+            }
+
+            uint32_t ticks = 0;
+            uint32_t allocating_ticks = 0;
+            uint32_t first_allocating = 0;
+            uint64_t allocations = 0;
+            for (;;) {
+                uint64_t before = g_allocations.load(std::memory_order_relaxed);
+                if (!pipeline.monitor.ReplayCycle()) break;
+                uint64_t count = g_allocations.load(std::memory_order_relaxed) - before;
+                if (count > 0) {
+                    if (allocating_ticks == 0) first_allocating = kCheckWarmupTicks + ticks;
+                    allocating_ticks++;
+                    allocations += count;
+                }
+                ticks++;
+            }
+
+            if (ticks + kCheckWarmupTicks != kCheckTicks) {
+                fprintf(stderr, "FAIL: replayed %u of %u ticks\n", ticks + kCheckWarmupTicks, kCheckTicks);
+                status = 1;
+            } else if (allocating_ticks > 0) {
+                printf("FAIL: %u of %u ticks allocated (%llu allocations, first at tick %u)\n", allocating_ticks, ticks,
+                       static_cast<unsigned long long>(allocations), first_allocating);
+                status = 1;
+            } else {
+                printf("OK: %u ticks after %u warm-up ticks, 0 allocations\n", ticks, kCheckWarmupTicks);
+            }
+        }
+
+        std::filesystem::remove(recording_path, ignored);
+        std::filesystem::remove(log_path, ignored);
+        return status;
+    }
+
+    // ------------------------------------------------------------------
+    // Runner
+
+    double RunBatch(const Case& c, uint64_t iterations, uint64_t& allocations) {
+        uint64_t before = g_allocations.load(std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+        c.run(iterations);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        allocations = g_allocations.load(std::memory_order_relaxed) - before;
+
+        if (c.reset) c.reset();
+        return std::chrono::duration<double>(elapsed).count();
+    }
+
+    Result Measure(const Benchmark& benchmark, const Case& c, double min_time) {
+        Result result = { &benchmark, 0, 0.0, 0.0, c.bytes_per_op, std::string() };
+        uint64_t allocations = 0;
+
+        // Warm-up: first-use allocations, cold caches, lazy statics
+        RunBatch(c, 1, allocations);
+
+        uint64_t iterations = 1;
+        for (;;) {
+            double seconds = RunBatch(c, iterations, allocations);
+            bool capped = c.max_iterations > 0 && iterations >= c.max_iterations;
+            if (seconds >= min_time || capped) break;
+
+            double scale = seconds > 0.0 ? min_time * 1.2 / seconds : 100.0;
+            scale = (std::min)((std::max)(scale, 2.0), 100.0);
+            iterations = static_cast<uint64_t>(static_cast<double>(iterations) * scale);
+            if (c.max_iterations > 0 && iterations > c.max_iterations) iterations = c.max_iterations;
+        }
+
+        double ns[kRepetitions];
+        uint64_t total_allocations = 0;
+        for (int r = 0; r < kRepetitions; ++r) {
+            ns[r] = RunBatch(c, iterations, allocations) * 1e9 / static_cast<double>(iterations);
+            total_allocations += allocations;
+        }
+        std::sort(ns, ns + kRepetitions);
+
+        result.iterations = iterations;
+        result.ns_per_op = ns[kRepetitions / 2];
+        result.allocs_per_op = static_cast<double>(total_allocations) / (static_cast<double>(iterations) * kRepetitions);
+        return result;
+    }
+
+    void PrintResult(const Result& result) {
+        if (!result.skipped.empty()) {
+            printf("%-36s skipped: %s\n", result.benchmark->name, result.skipped.c_str());
+            return;
+        }
+
+        char throughput[32] = "";
+        if (result.bytes_per_op > 0 && result.ns_per_op > 0.0) {
+            snprintf(throughput, sizeof(throughput), "%10.1f MB/s",
+                     static_cast<double>(result.bytes_per_op) * 1e3 / result.ns_per_op);
+        }
+        printf("%-36s %12.1f ns/op %9.2f allocs/op %10llu iters %s\n", result.benchmark->name, result.ns_per_op,
+               result.allocs_per_op, static_cast<unsigned long long>(result.iterations), throughput);
+        fflush(stdout);
+    }
+
+    bool WriteJson(const std::string& path, const std::vector<Result>& results, const Options& options) {
+        std::ofstream file(path, std::ios::trunc);
+        if (!file.is_open()) return false;
+
+        char number[64];
+        file << "{\"schema\":1,\"timestamp\":" << static_cast<int64_t>(std::time(nullptr));
+        snprintf(number, sizeof(number), "%.3f", options.min_time);
+        file << ",\"min_time\":" << number << ",\"benchmarks\":[";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const Result& result = results[i];
+            file << (i > 0 ? ",\n" : "\n") << "{\"name\":\"" << result.benchmark->name << "\"";
+            if (!result.skipped.empty()) {
+                // Reasons are fixed text and paths; escape the path separators
+                std::string reason;
+                for (char c : result.skipped) {
+                    if (c == '\\' || c == '"') reason += '\\';
+                    reason += c;
+                }
+                file << ",\"skipped\":\"" << reason << "\"}";
+                continue;
+            }
+            snprintf(number, sizeof(number), "%.3f", result.ns_per_op);
+            file << ",\"iterations\":" << result.iterations << ",\"ns_per_op\":" << number;
+            snprintf(number, sizeof(number), "%.3f", result.allocs_per_op);
+            file << ",\"allocs_per_op\":" << number << ",\"bytes_per_op\":" << result.bytes_per_op << "}";
+        }
+        file << "\n]}\n";
+        return file.good();
+    }
+
+    void PrintUsage() {
+        printf("Usage: pc_monitor_bench [options]\n"
+               "  --filter <text>    Run only benchmarks whose name contains text\n"
+               "  --min-time <s>     Target seconds per batch (default 0.5)\n"
+               "  --json <file>      Write results as JSON (see bench/compare_bench.py)\n"
+               "  --fixtures <dir>   Fixture directory (default %s)\n"
+               "  --list             List benchmarks and exit\n"
+               "  --check-allocations Replay full monitor ticks; exit 1 if a warm tick allocates\n"
+               "  --check-http-parser Parse generated and mutated requests in random splits; exit 1 on a mismatch\n",
+               PCMONITOR_BENCH_FIXTURES);
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--filter" && has_value) {
+            options.filter = argv[++i];
+        } else if (arg == "--min-time" && has_value) {
+            options.min_time = std::atof(argv[++i]);
+            if (!(options.min_time > 0.0)) {
+                fprintf(stderr, "--min-time must be positive\n");
+                return 1;
+            }
+        } else if (arg == "--json" && has_value) {
+            options.json_path = argv[++i];
+        } else if (arg == "--fixtures" && has_value) {
+            options.fixtures = argv[++i];
+        } else if (arg == "--list") {
+            options.list = true;
+        } else if (arg == "--check-allocations") {
+            options.check_allocations = true;
+        } else if (arg == "--check-http-parser") {
+            options.check_http_parser = true;
+        } else {
+            PrintUsage();
+            return arg == "--help" || arg == "-h" ? 0 : 1;
+        }
+    }
+
+    if (options.list) {
+        for (const Benchmark& benchmark : kBenchmarks) {
+            printf("%-36s %s\n", benchmark.name, benchmark.description);
+        }
+        return 0;
+    }
+
+    if (options.check_allocations) {
+        return CheckAllocations();
+    }
+    if (options.check_http_parser) {
+        return CheckHttpParser();
+    }
+
+    WSADATA wsa_data;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa_data) != 0) {
+        fprintf(stderr, "WSAStartup failed\n");
+        return 1;
+    }
+
+    std::vector<Result> results;
+    for (const Benchmark& benchmark : kBenchmarks) {
+        if (!options.filter.empty() && std::string(benchmark.name).find(options.filter) == std::string::npos) continue;
+
+        Result result;
+        {
+            Case c = benchmark.setup(options);
+            if (c.skipped.empty()) {
+                result = Measure(benchmark, c, options.min_time);
+            } else {
+                result = Result{ &benchmark, 0, 0.0, 0.0, 0, c.skipped };
+            }
+        }
+        PrintResult(result);
+        results.push_back(std::move(result));
+    }
+
+    WSACleanup();
+
+    if (!options.json_path.empty() && !WriteJson(options.json_path, results, options)) {
+        fprintf(stderr, "Cannot write %s\n", options.json_path.c_str());
+        return 1;
+    }
+    return 0;
+}
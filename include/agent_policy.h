@@ -0,0 +1,60 @@
+#pragma once
+
+#include <string_view>
+#include <cstdint>
+
+namespace PCMonitor {
+
+    // What a thread does for the agent, which decides the policy it gets
+    enum class ThreadRole : uint8_t {
+        Sampler,    // The monitoring loop
+        Worker      // Logging, web server, streams, responders, watchers
+    };
+
+    enum class WorkerPriority : uint8_t {
+        Normal,
+        Low,        // Below normal, like nice
+        Idle        // Only runs when the CPU would otherwise idle, like SCHED_IDLE
+    };
+
+    // Low-perturbation settings for running on latency-sensitive hosts
+    struct AgentSettings {
+        uint64_t sampler_cpus = 0;      // Affinity mask for the sampler; 0 leaves it to the scheduler
+        uint64_t worker_cpus = 0;       // Affinity mask for every other agent thread
+        WorkerPriority worker_priority = WorkerPriority::Normal;
+        bool realtime_sampler = false;  // Time-critical sampler priority, so ticks aren't delayed
+        bool lock_memory = false;       // Keep the warmed-up working set resident
+    };
+
+    // The agent's own footprint, for self-monitoring
+    struct AgentUsage {
+        double user_seconds = 0.0;
+        double kernel_seconds = 0.0;
+        uint64_t context_switches = 0;  // Summed over the process's live threads
+        uint64_t working_set_bytes = 0;
+        bool memory_locked = false;
+    };
+
+    // Process-wide thread placement and memory policy. Configure() runs once
+    // in main before any thread starts; each agent thread then applies the
+    // policy for its role to itself as its first action.
+    class AgentPolicy {
+    public:
+        static void Configure(const AgentSettings& settings);
+        static const AgentSettings& GetSettings();
+
+        static void ApplyToCurrentThread(ThreadRole role);
+
+        // Makes the current working set the process's hard minimum, so pages
+        // touched during warm-up stay resident (the nearest Windows has to
+        // mlockall). Call once buffers have been allocated and used.
+        static bool LockWorkingSet();
+
+        static AgentUsage ReadUsage();
+
+        // "0,2-3" style CPU lists or a 0x-prefixed mask; false on bad input
+        // or CPUs beyond the 64 an affinity mask can hold
+        static bool ParseCpuList(std::string_view text, uint64_t& mask);
+    };
+
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "metrics_types.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <cstdint>
+
+namespace PCMonitor {
+
+    // A rule starting or stopping to fire
+    struct AlertEvent {
+        int64_t timestamp;      // Snapshot time (Unix seconds)
+        uint32_t rule;          // AlertEngine::GetRuleName()
+        bool firing;            // false: resolved
+        double value;
+        double threshold;
+    };
+
+    // Threshold rules over snapshot fields, checked on every snapshot.
+    //
+    //     [name:] operand op number [for duration] [clear number]
+    //
+    //     hot_cpu: cpu.temperature_c > 90 for 30s
+    //     avg(ram.utilization_percent, 5m) > 95 clear 90
+    //
+    // An operand is a scalar field ("group.field") or avg/min/max of one over
+    // a duration; op is >, >=, < or <=; durations take ms, s, m or h. A rule
+    // fires once its condition has held for the `for` duration and resolves
+    // when the value is no longer past `clear` (default: the threshold).
+    //
+    // Rules are compiled when loaded into two flat arrays: signals (field
+    // offset plus aggregate, shared by rules that read the same thing, with
+    // their sliding-window buffers preallocated) and comparisons over them.
+    // Evaluation walks both arrays once and doesn't allocate; state changes
+    // go to the event listener.
+    class AlertEngine {
+    public:
+        enum class Aggregate : uint8_t { Last, Avg, Min, Max };
+        enum class Compare : uint8_t { Greater, GreaterEqual, Less, LessEqual };
+
+    private:
+        struct Signal {
+            const FieldInfo* field;
+            Aggregate aggregate;
+            uint32_t window;        // Samples
+            uint32_t buffer;        // First slot in values_ / sequence_
+            uint32_t head;          // Avg: next slot; Min/Max: deque front
+            uint32_t size;          // Samples (Avg) or deque entries held
+            double sum;
+            double value;           // This tick's result
+        };
+
+        struct Rule {
+            uint32_t signal;
+            Compare compare;
+            double threshold;
+            double clear;
+            uint32_t for_ticks;
+            uint32_t pending_ticks;     // Consecutive ticks the condition has held
+            bool firing;
+        };
+
+        std::chrono::milliseconds interval_;
+        std::vector<std::string> names_;
+        std::vector<std::string> texts_;
+
+        std::vector<Signal> signals_;
+        std::vector<Rule> rules_;
+        std::vector<double> values_;        // Window buffers of every signal
+        std::vector<uint64_t> sequence_;    // Min/Max: tick each deque entry was added
+        uint64_t tick_;
+
+        mutable std::mutex mutex_;          // Rule state, read by /api/alerts
+        std::function<void(const AlertEvent&)> event_listener_;
+
+        std::atomic<uint64_t> evaluations_;
+        std::atomic<uint64_t> last_evaluation_ns_;
+        std::atomic<size_t> firing_count_;
+
+        uint32_t AddSignal(const FieldInfo* field, Aggregate aggregate, uint32_t window);
+        void UpdateSignal(Signal& signal, double sample);
+
+    public:
+        // Windows and `for` durations are counted in snapshots of this interval
+        explicit AlertEngine(std::chrono::milliseconds interval);
+
+        // Compiles one rule; returns false and describes the problem in error.
+        // Not safe once Evaluate has started being called.
+        bool AddRule(std::string_view text, std::string& error);
+
+        // One rule per line; blank lines and lines starting with # are skipped
+        bool LoadFile(const std::string& path, std::string& error);
+
+        // Called on the monitoring thread for every snapshot
+        void Evaluate(const MetricsSnapshot& snapshot);
+
+        // Called on the monitoring thread for each state change
+        void SetEventListener(std::function<void(const AlertEvent&)> listener);
+
+        size_t GetRuleCount() const { return rules_.size(); }
+        size_t GetSignalCount() const { return signals_.size(); }
+        const std::string& GetRuleName(uint32_t rule) const { return names_[rule]; }
+        size_t GetFiringCount() const { return firing_count_; }
+        uint64_t GetEvaluations() const { return evaluations_; }
+        double GetLastEvaluationSeconds() const { return static_cast<double>(last_evaluation_ns_) / 1e9; }
+
+        // "timestamp":..,"rule":..,"state":..,"value":..,"threshold":..
+        // (the members only, for EventStream::Publish)
+        void AppendEventJson(const AlertEvent& event, std::string& out) const;
+
+        // {"rules":[{"name":..,"rule":..,"state":..,"value":..},...]} for /api/alerts
+        std::string GetStatusJson() const;
+    };
+
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <cstdint>
+
+namespace PCMonitor {
+
+    // Hands alert and forecast changes to things outside the process, on its
+    // own thread so a slow endpoint or command never holds up the monitor.
+    //
+    // - Webhook: the event JSON is POSTed to an http:// URL (a local
+    //   receiver; no TLS) and any 2xx status counts as delivered.
+    // - Command: started without waiting for it, after replacing {rule},
+    //   {state}, {value} and {json} in the command line, each with one quoted
+    //   argument that the program's argv gets back verbatim.
+    //
+    // At most kMaxQueued notifications wait; beyond that they're dropped and
+    // counted as failed.
+    class AlertNotifier {
+    public:
+        static constexpr size_t kMaxQueued = 64;
+
+        struct Settings {
+            std::string webhook_url;    // Empty: no webhook
+            std::string command;        // Empty: no command
+        };
+
+        struct Notification {
+            std::string rule;
+            std::string state;
+            std::string value;
+            std::string json;
+        };
+
+    private:
+        Settings settings_;
+        std::string host_;
+        std::string port_;
+        std::string path_;
+
+        std::atomic<bool> running_;
+        std::unique_ptr<std::thread> worker_thread_;
+
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        std::deque<Notification> queue_;
+
+        std::atomic<uint64_t> delivered_;
+        std::atomic<uint64_t> failed_;
+
+        void WorkerLoop();
+        bool PostWebhook(const std::string& body);
+        bool RunCommand(const Notification& notification);
+
+    public:
+        explicit AlertNotifier(Settings settings);
+        ~AlertNotifier();
+
+        // Fails if the webhook URL isn't http://host[:port][/path]
+        bool Start(std::string& error);
+        void Stop();
+
+        void Notify(Notification notification);
+
+        uint64_t GetDelivered() const { return delivered_; }
+        uint64_t GetFailed() const { return failed_; }
+    };
+
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "metrics_types.h"
+#include <string>
+#include <vector>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+
+namespace PCMonitor {
+
+    // A series entering or leaving the anomalous state
+    struct AnomalyEvent {
+        int64_t timestamp;      // Snapshot time (Unix seconds)
+        uint32_t series;        // AnomalyDetector::GetSeriesName()
+        bool anomalous;         // false: back to normal
+        float value;
+        float expected;         // Baseline the value was compared with
+        float z;
+    };
+
+    // Online anomaly detection over every scalar snapshot field plus any
+    // extra series (per-core / per-device rates from DeviceSampler).
+    //
+    // Each series keeps an exponentially weighted mean and variance of its
+    // residual and flags samples more than `z_threshold` deviations away.
+    // With a season set, the residual is taken against a per-phase baseline
+    // (kSeasonBuckets slots over the season, e.g. half-hours of a day) so
+    // regular daily load isn't reported. State is a few doubles per series
+    // (plus the season slots), allocated once; evaluating a sample is O(1).
+    class AnomalyDetector {
+    public:
+        static constexpr size_t kSeasonBuckets = 48;
+
+        struct Settings {
+            double alpha = 0.05;            // EWMA weight of the newest sample
+            double z_threshold = 4.0;       // Enter the anomalous state above this |z|
+            double clear_ratio = 0.5;       // Leave it below z_threshold * clear_ratio
+            uint32_t warmup_samples = 30;   // No verdicts until the baseline has settled
+            uint32_t season_seconds = 0;    // 0: no seasonal baseline
+            double season_alpha = 0.1;      // EWMA weight within a season slot
+        };
+
+    private:
+        Settings settings_;
+        std::vector<std::string> names_;
+        std::vector<const FieldInfo*> fields_;  // Snapshot fields, first in names_
+
+        // Per-series state, one array per member so the update loop streams
+        std::vector<double> mean_;
+        std::vector<double> variance_;
+        std::vector<uint32_t> count_;
+        std::vector<uint8_t> anomalous_;
+        std::vector<double> season_;            // series x kSeasonBuckets
+        std::vector<uint8_t> season_seen_;
+        std::vector<double> values_;            // Scratch for the current sample
+
+        std::function<void(const AnomalyEvent&)> event_listener_;
+
+        std::atomic<uint64_t> evaluations_;
+        std::atomic<uint64_t> last_evaluation_ns_;
+
+    public:
+        explicit AnomalyDetector(Settings settings, std::vector<std::string> extra_series = {});
+
+        // Called on the monitoring thread for every snapshot; extra_values
+        // holds one value per extra series (NaN skips a series this time)
+        void Evaluate(const MetricsSnapshot& snapshot, const float* extra_values);
+
+        // Called on the monitoring thread for each state change
+        void SetEventListener(std::function<void(const AnomalyEvent&)> listener);
+
+        size_t GetSeriesCount() const { return names_.size(); }
+        const std::string& GetSeriesName(uint32_t series) const { return names_[series]; }
+        uint64_t GetEvaluations() const { return evaluations_; }
+        double GetLastEvaluationSeconds() const { return static_cast<double>(last_evaluation_ns_) / 1e9; }
+
+        // "timestamp":..,"series":..,"state":..,"value":..,"expected":..,"z":..
+        // (the members only, for EventStream::Publish)
+        void AppendEventJson(const AnomalyEvent& event, std::string& out) const;
+    };
+
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+
+namespace PCMonitor {
+
+    // A file from the web directory held in memory with its response headers
+    // prebuilt, so serving it never touches the disk or reformats anything.
+    struct StaticAsset {
+        std::string path;           // URL path, e.g. "/dashboard.html"
+        std::string content_type;
+        std::string hash;           // FNV-1a of the served bytes, 16 hex digits
+        std::string body;
+        std::string gzip_body;      // Empty if zlib is unavailable or it didn't help
+
+        // Indexed by [gzip][immutable]. Immutable headers are used when the
+        // request names the current content hash (?v=<hash>).
+        std::string headers[2][2];
+        std::string not_modified[2];
+        std::string etag[2];
+    };
+
+    class AssetCache {
+    private:
+        using AssetMap = std::unordered_map<std::string, std::shared_ptr<const StaticAsset>>;
+        using LoadedAssets = std::unordered_map<std::string, std::shared_ptr<StaticAsset>>;
+
+        std::string root_;
+        bool dev_mode_;
+
+        mutable std::mutex mutex_;
+        std::shared_ptr<const AssetMap> assets_;
+
+        std::atomic<bool> watching_;
+        std::unique_ptr<std::thread> watch_thread_;
+
+        void WatchLoop();
+        void StampAssetUrls(LoadedAssets& assets) const;
+        void BuildHeaders(StaticAsset& asset) const;
+
+    public:
+        // In dev mode nothing is marked immutable and StartWatching() reloads
+        // the directory whenever a file in it changes.
+        AssetCache(const std::string& root, bool dev_mode = false);
+        ~AssetCache();
+
+        // Reads every file under the root. The previous set stays in use until
+        // the new one is complete, so a reload never serves partial content.
+        bool Load();
+
+        std::shared_ptr<const StaticAsset> Find(const std::string& path) const;
+
+        bool StartWatching();
+        void StopWatching();
+
+        size_t GetAssetCount() const;
+        bool IsDevMode() const { return dev_mode_; }
+    };
+
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "metrics_types.h"
+#include <string>
+#include <cstdint>
+
+namespace PCMonitor {
+
+    // Compact binary encoding of a snapshot for high-frequency consumers.
+    //
+    // The payload is CBOR (RFC 8949) laid out by the field tables in
+    // metrics_types.h, without any field names:
+    //
+    //   [schema_version, version, timestamp, [gpu...], [cpu...], [ram...],
+    //    [storage...], [network...], [power...], [thermal...]]
+    //
+    // Each group array holds its fields in table order. Integers use the
+    // shortest CBOR head (1-9 bytes), doubles are written as float32 and
+    // array fields (fan speeds) are nested arrays. GenerateSchemaJson()
+    // describes this layout and is served at /api/schema.
+    constexpr uint32_t kBinarySchemaVersion = 6;
+
+    std::string EncodeMetricsCbor(const MetricsSnapshot& snapshot);
+    std::string GenerateSchemaJson();
+
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace PCMonitor {
+
+    // Summary of the fast samples taken during one collection interval
+    struct BurstSummary {
+        double mean;
+        double min;
+        double max;
+        double p99;
+    };
+
+    // Fixed-size streaming buffer for the sub-interval samples of one metric.
+    // Mean, min and max are exact; p99 is exact up to kCapacity samples per
+    // interval and estimated from a uniform reservoir beyond that. Nothing is
+    // allocated after construction.
+    class BurstWindow {
+    public:
+        // 10 s of 20 ms samples
+        static constexpr size_t kCapacity = 512;
+
+    private:
+        double samples_[kCapacity];
+        size_t stored_;
+        uint64_t count_;
+        double sum_;
+        double min_;
+        double max_;
+        uint64_t random_state_;     // Reservoir replacement choices
+
+    public:
+        BurstWindow();
+
+        void Add(double value);
+        bool empty() const { return count_ == 0; }
+        uint64_t size() const { return count_; }
+
+        // Summarizes and clears the window. An empty window reports
+        // fallback for every statistic (the interval's single reading).
+        BurstSummary Take(double fallback);
+    };
+
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <deque>
+#include <cstdint>
+
+namespace PCMonitor {
+
+    // Produces a response body a piece at a time. Each call appends the next
+    // piece (roughly ChunkedResponder::kChunkBytes or less) to out and returns
+    // false once the body is complete; the final call may still append data.
+    using BodyGenerator = std::function<bool(std::string& out)>;
+
+    // Frames body pieces as HTTP/1.1 chunks, gzip-compressing them on the fly
+    // when asked (and zlib is available). Holds one compressor's state and
+    // nothing proportional to the body.
+    class ChunkedEncoder {
+    private:
+        struct Deflater;
+
+        bool chunked_;
+        std::unique_ptr<Deflater> deflater_;
+        std::string compressed_;
+
+        void AppendChunk(std::string_view data, std::string& out) const;
+
+    public:
+        // With chunked = false the body is written as-is (for HTTP/1.0
+        // clients, delimited by closing the connection).
+        ChunkedEncoder(bool chunked, bool gzip);
+        ~ChunkedEncoder();
+
+        bool IsGzip() const { return deflater_ != nullptr; }
+
+        // Appends the wire form of the next piece of body to out
+        void Write(std::string_view data, std::string& out);
+
+        // Appends whatever the compressor still holds plus the last chunk
+        void Finish(std::string& out);
+    };
+
+    // Writes generated responses (history, exports) on its own thread so a
+    // long download doesn't stall the web server loop. Memory per response
+    // is one chunk buffer and one compressor, whatever the body's length.
+    class ChunkedResponder {
+    public:
+        using SocketHandle = uintptr_t;
+
+        static constexpr size_t kChunkBytes = 64 * 1024;
+
+    private:
+        struct Job {
+            SocketHandle socket;
+            std::string headers;        // Status line and headers, without the blank line
+            BodyGenerator generator;
+            bool chunked;
+            bool gzip;
+        };
+
+        std::atomic<bool> running_;
+        std::unique_ptr<std::thread> worker_thread_;
+
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        std::deque<Job> jobs_;
+
+        std::atomic<uint64_t> responses_sent_;
+
+        void WorkerLoop();
+        void Respond(Job& job);
+
+    public:
+        ChunkedResponder();
+        ~ChunkedResponder();
+
+        bool Start();
+        void Stop();
+
+        // Takes ownership of a connected socket; the response is written on
+        // the worker thread and the connection closed afterwards.
+        void Submit(SocketHandle socket, std::string headers, BodyGenerator generator, bool chunked, bool gzip);
+
+        static bool SupportsGzip();
+        uint64_t GetResponsesSent() const { return responses_sent_; }
+    };
+
+}
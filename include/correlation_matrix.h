@@ -0,0 +1,79 @@
+#pragma once
+
+#include "metrics_types.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+namespace PCMonitor {
+
+    // Pearson correlation between every pair of series over a sliding window
+    // of samples, for /api/correlations ("what moved with it?").
+    //
+    // The series are every scalar snapshot field plus any extra series
+    // (per-core / per-device rates from DeviceSampler), as for the anomaly
+    // detector. Per pair the window's sum of cross products is kept in a
+    // packed upper triangle, one contiguous row per series, so a sample adds
+    // its products and subtracts those of the sample leaving the window in a
+    // single streaming O(n^2) pass the compiler vectorizes.
+    //
+    // Values are summed relative to a per-series offset (the window mean at
+    // the last rebuild) to keep the sums well conditioned. Every `window`
+    // samples the sums are recomputed from the retained samples, which also
+    // discards rounding drift from the add/subtract updates.
+    class CorrelationMatrix {
+    public:
+        static constexpr size_t kDefaultTop = 20;
+        static constexpr size_t kMaxTop = 1000;
+
+    private:
+        std::vector<const FieldInfo*> fields_;  // Snapshot fields, first in names_
+        std::vector<std::string> names_;
+        size_t window_;
+
+        mutable std::mutex mutex_;
+        std::vector<float> samples_;            // window x series ring, one row per sample
+        std::vector<double> offsets_;
+        std::vector<double> sums_;              // Per series, of (x - offset)
+        std::vector<double> products_;          // Packed upper triangle, diagonal included
+        std::vector<float> held_;               // Last finite value, stands in for NaN
+        std::vector<double> entering_;          // Scratch: centered new sample
+        std::vector<double> leaving_;           // Scratch: centered sample dropping out
+        size_t count_;
+        size_t head_;
+        size_t since_rebuild_;
+        int64_t latest_timestamp_;
+
+        std::atomic<uint64_t> updates_;
+        std::atomic<uint64_t> last_update_ns_;
+
+        void Rebuild();
+
+    public:
+        // window: samples per correlation (e.g. 300 at 1 Hz for five minutes)
+        CorrelationMatrix(size_t window, std::vector<std::string> extra_series = {});
+
+        // Called on the monitoring thread for every snapshot; extra_values
+        // holds one value per extra series (NaN holds the previous value)
+        void Add(const MetricsSnapshot& snapshot, const float* extra_values);
+
+        // Appends the /api/correlations document: the `top` pairs by |r|,
+        // only pairs involving one of `series` (comma-separated "group.field",
+        // device names or whole groups) when given. Series that were flat
+        // over the window have no correlation and are left out. Returns false
+        // and describes the problem in error for an unknown series or bad top.
+        bool AppendJson(std::string_view series, std::string_view top, std::string& out, std::string& error) const;
+
+        size_t GetSeriesCount() const { return names_.size(); }
+        size_t GetWindow() const { return window_; }
+        uint64_t GetUpdates() const { return updates_; }
+        double GetLastUpdateSeconds() const { return static_cast<double>(last_update_ns_) / 1e9; }
+        size_t GetMemoryBytes() const {
+            return samples_.size() * sizeof(float) + (offsets_.size() + sums_.size() + products_.size()) * sizeof(double);
+        }
+    };
+
+}
@@ -13,6 +13,12 @@
 
 namespace PCMonitor {
 
+    // Opens a CSV log for appending, with the column layout of GetCsvHeader().
+    // A file that starts with a different header (written by an older build)
+    // is moved aside to <path>.<YYYYmmdd_HHMMSS> rather than mixing layouts,
+    // and the header is written only to a new or empty file.
+    bool OpenCsvLog(std::ofstream& file, const std::string& path);
+
     class DataLogger {
     private:
         std::ofstream log_file_;
@@ -35,9 +41,8 @@ namespace PCMonitor {
         std::queue<LogEntry> log_queue_;
 
         bool OpenLogFile();
-        void WriteHeader();
         void LoggingLoop();
-        std::string FormatLogEntry(const LogEntry& entry);
+        void FormatLogEntry(const LogEntry& entry, std::string& out);
         void RotateLogFile();
 
     public:
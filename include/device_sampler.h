@@ -0,0 +1,54 @@
+#pragma once
+
+#include <windows.h>
+#include <pdh.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstddef>
+
+#pragma comment(lib, "pdh.lib")
+
+namespace PCMonitor {
+
+    // Per-core utilization and per-disk / per-interface throughput for the
+    // high-resolution consumers. Every counter instance PDH reports at
+    // Initialize() becomes one series with a fixed index, named
+    // "cpu.<core>", "disk.<disk>" or "net.<interface>" ("_Total" becomes
+    // "total", spaces become underscores). Devices that appear later are not
+    // picked up; ones that disappear read as NaN.
+    class DeviceSampler {
+    public:
+        static constexpr size_t kMaxSeries = 256;
+
+    private:
+        PDH_HQUERY query_;
+        std::vector<PDH_HCOUNTER> counters_;
+        std::vector<std::string> names_;
+        std::vector<float> values_;
+
+        void AddInstances(const char* wildcard_path, const char* prefix);
+
+    public:
+        DeviceSampler();
+        ~DeviceSampler();
+
+        DeviceSampler(const DeviceSampler&) = delete;
+        DeviceSampler& operator=(const DeviceSampler&) = delete;
+
+        bool Initialize();
+
+        // Reads every series (cpu %, bytes/s); NaN where a counter has no
+        // value yet. Called on the sampler thread; allocates nothing.
+        void Sample();
+
+        size_t GetSeriesCount() const { return names_.size(); }
+        const std::vector<std::string>& GetSeriesNames() const { return names_; }
+        const float* GetValues() const { return values_.data(); }
+
+        // Index of the named series, or -1
+        int FindSeries(std::string_view name) const;
+    };
+
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "frame_sink.h"
+#include <string>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <fstream>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+namespace PCMonitor {
+
+    // Delivers events (throttling, anomalies, alerts, forecasts) off the
+    // monitoring thread: each one is appended to the event log and pushed to
+    // /api/events subscribers as a Server-Sent Event ("event:" its type,
+    // "id:" the event id).
+    //
+    // A client's frame carries every retained event after the last one it was
+    // sent, so a frame replaced while the client catches up loses nothing;
+    // clients resuming from the same id share one encoding.
+    class EventStream {
+    public:
+        static constexpr size_t kRetainedEvents = 256;
+
+    private:
+        struct Event {
+            uint64_t id;
+            std::string type;
+            std::string json;       // {"id":..,"type":..,<members>}
+        };
+
+        struct PendingSubscriber {
+            FrameSink::SocketHandle socket;
+            uint64_t since;
+        };
+
+        std::string log_path_;
+        std::ofstream log_;
+
+        std::atomic<bool> running_;
+        std::unique_ptr<std::thread> stream_thread_;
+
+        // Shared with the publishing and web server threads
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        std::vector<Event> events_;             // Ring, by id % kRetainedEvents
+        uint64_t next_id_;
+        std::vector<PendingSubscriber> new_subscribers_;
+
+        // Owned by the stream thread
+        std::vector<FrameSink> subscribers_;
+        uint64_t logged_id_;
+        std::vector<Event> scratch_;
+        std::unordered_map<uint64_t, std::shared_ptr<const std::string>> frames_;     // By base id, this round
+
+        std::atomic<size_t> subscriber_count_;
+        std::atomic<uint64_t> events_logged_;
+
+        void StreamLoop();
+        uint64_t GetLatestId();
+        void CopyEventsSince(uint64_t since);   // Into scratch_, oldest first
+        void LogNewEvents(uint64_t latest);
+        std::shared_ptr<const std::string> FrameSince(uint64_t since);
+
+    public:
+        explicit EventStream(std::string log_path);
+        ~EventStream();
+
+        bool Start();
+        void Stop();
+
+        // Records an event and wakes the stream thread; members are the
+        // event's JSON members without braces ("timestamp":..,...). Callable
+        // from any thread; allocates, so only for state changes.
+        void Publish(std::string_view type, std::string_view members);
+
+        // Takes ownership of a socket whose SSE headers have been sent. The
+        // client gets retained events after `since` (e.g. Last-Event-ID),
+        // then every new one.
+        void AddSubscriber(FrameSink::SocketHandle socket, uint64_t since);
+
+        size_t GetSubscriberCount() const { return subscriber_count_; }
+        uint64_t GetEventsLogged() const { return events_logged_; }
+    };
+
+}
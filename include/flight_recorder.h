@@ -0,0 +1,153 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace PCMonitor {
+
+    class DeviceSampler;
+
+    enum class TriggerSource : uint32_t {
+        Threshold,
+        Api,
+        Signal
+    };
+
+    // Flight recorder: keeps the last few seconds of every DeviceSampler
+    // series at burst resolution in a ring that is continuously overwritten.
+    // A trigger (a series crossing a threshold, an API call or Ctrl+Break)
+    // keeps recording for the post-trigger window, then swaps the full ring
+    // for an empty spare in O(1) and hands it to a writer thread, so the
+    // sampler never waits on the disk. One capture is written at a time;
+    // triggers while the spare is still being written are counted and dropped.
+    // API triggers are further limited to one per kApiTriggerIntervalSeconds,
+    // and only the newest max_captures files are kept in the directory.
+    //
+    // Capture file (.pmfr, little-endian):
+    //   char magic[4] = "PMFR"; uint32 format_version = 1;
+    //   uint32 series_count; uint32 sample_count; uint32 trigger_index;
+    //   uint32 period_us; int64 trigger_unix_us; uint32 source (TriggerSource);
+    //   uint32 reserved;
+    //   series_count x { uint16 name_length; char name[name_length]; }
+    //   sample_count x { int64 offset_us (from the trigger); float values[series_count]; }
+    class FlightRecorder {
+    public:
+        static constexpr uint32_t kFormatVersion = 1;
+        static constexpr uint32_t kApiTriggerIntervalSeconds = 30;
+
+        enum class TriggerResult {
+            Accepted,
+            Busy,                           // Capture in progress or still being written
+            RateLimited                     // API trigger within kApiTriggerIntervalSeconds of the last
+        };
+
+        struct Settings {
+            uint32_t pre_seconds = 30;      // Kept before the trigger
+            uint32_t post_seconds = 5;      // Recorded after it
+            std::string directory = ".";
+            uint32_t max_captures = 20;     // Oldest flight_*.pmfr deleted beyond this; 0 keeps all
+            std::string trigger;            // "<series>><value>" or "<series><<value>", optional
+        };
+
+        struct Status {
+            bool running;
+            bool capturing;                 // Trigger seen, post-trigger window in progress
+            size_t series;
+            uint32_t period_ms;
+            uint64_t captures_written;
+            uint64_t triggers_dropped;
+            std::string last_capture;
+        };
+
+    private:
+        struct Ring {
+            std::vector<int64_t> times_us;  // Since the recorder started
+            std::vector<float> values;      // capacity x series, row per sample
+        };
+
+        // What the writer needs to know about a frozen ring
+        struct Capture {
+            Ring* ring;
+            size_t first_slot;
+            size_t count;
+            size_t trigger_index;           // Position of the trigger sample within the capture
+            int64_t trigger_time_us;
+            int64_t trigger_unix_us;
+            TriggerSource source;
+        };
+
+        const DeviceSampler& devices_;
+        Settings settings_;
+        uint32_t period_ms_;
+        size_t series_count_;
+        size_t capacity_;
+        size_t post_samples_;
+
+        // Sampler thread only
+        Ring rings_[2];
+        Ring* active_;
+        size_t next_slot_;
+        size_t stored_;
+        bool capturing_;
+        size_t post_remaining_;
+        Capture pending_;
+        int trigger_series_;
+        bool trigger_above_;
+        float trigger_value_;
+        bool trigger_armed_;                // Re-armed once the series is back on the normal side
+        std::chrono::steady_clock::time_point epoch_;
+
+        std::atomic<uint32_t> requested_;   // TriggerSource + 1 from API/signal, 0 if none
+        std::atomic<int64_t> last_api_trigger_ms_;  // steady_clock, 0 before the first
+        std::atomic<bool> spare_ready_;
+        std::atomic<bool> capturing_flag_;
+
+        // Writer thread
+        std::atomic<bool> running_;
+        std::unique_ptr<std::thread> writer_thread_;
+        mutable std::mutex mutex_;
+        std::condition_variable cv_;
+        Ring* spare_;
+        bool has_capture_;
+        Capture capture_;
+        std::string last_capture_;
+
+        std::atomic<uint64_t> captures_written_;
+        std::atomic<uint64_t> triggers_dropped_;
+
+        bool ParseTrigger();
+        void BeginCapture(TriggerSource source, std::chrono::steady_clock::time_point time);
+        void FreezeCapture();
+        void WriterLoop();
+        bool WriteCapture(const Capture& capture, std::string& path) const;
+        void PruneCaptures() const;
+
+    public:
+        FlightRecorder(const DeviceSampler& devices, Settings settings);
+        ~FlightRecorder();
+
+        // Allocates both rings for the sampling period and starts the writer.
+        // The DeviceSampler must already be initialized.
+        bool Start(std::chrono::milliseconds period);
+        void Stop();
+
+        // Sampler thread, after each DeviceSampler::Sample()
+        void Record(std::chrono::steady_clock::time_point time);
+
+        // Any thread, including a signal handler: only sets a flag that the
+        // next Record() picks up.
+        TriggerResult RequestTrigger(TriggerSource source);
+
+        Status GetStatus() const;
+        std::string GetStatusJson() const;
+    };
+
+}
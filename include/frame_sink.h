@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <cstdint>
+
+namespace PCMonitor {
+
+    // One push subscriber's connection: a non-blocking socket with at most
+    // one frame being written and the newest frame queued behind it. Frames
+    // are shared buffers, so the same encoding can go to many sinks.
+    class FrameSink {
+    public:
+        // Winsock SOCKET, kept opaque so this header doesn't pull in winsock2.h
+        using SocketHandle = uintptr_t;
+
+    private:
+        SocketHandle socket_;
+        std::shared_ptr<const std::string> frame_;  // Frame currently being written
+        size_t bytes_sent_;
+        std::shared_ptr<const std::string> next_;   // Newest frame queued behind it
+        uint64_t frame_version_;
+        uint64_t next_version_;
+
+    public:
+        // since: snapshot version the client already has, 0 if none
+        explicit FrameSink(SocketHandle socket, uint64_t since = 0);
+
+        // Switches the socket to non-blocking writes
+        static void MakeNonBlocking(SocketHandle socket);
+
+        // Queues a frame, replacing any frame still waiting behind the one
+        // being written. Returns true if a waiting frame was dropped.
+        bool Queue(std::shared_ptr<const std::string> frame, uint64_t version);
+
+        // Writes as much as the socket accepts; false if the connection failed
+        bool Flush();
+
+        void Close();
+
+        bool HasPendingWrites() const { return frame_ != nullptr; }
+        bool IsOpen() const;
+
+        // Version of the frame being written, or of the last one written: what
+        // the client will hold once the current write completes
+        uint64_t GetFrameVersion() const { return frame_version_; }
+    };
+
+}
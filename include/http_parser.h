@@ -0,0 +1,79 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+
+namespace PCMonitor {
+
+    struct HttpHeader {
+        std::string_view name;
+        std::string_view value;
+    };
+
+    // A parsed request. Every view points into the connection's receive
+    // buffer and is only valid until that buffer is compacted or reused.
+    struct HttpRequest {
+        static constexpr size_t kMaxHeaders = 32;
+
+        std::string_view method;
+        std::string_view target;    // As sent: path plus optional "?query"
+        std::string_view path;
+        std::string_view query;     // Without the '?', not percent-decoded
+        std::string_view version;   // "HTTP/1.0" or "HTTP/1.1"
+        std::string_view body;
+
+        HttpHeader headers[kMaxHeaders];
+        size_t header_count;
+        bool keep_alive;
+
+        // Value of a header (case-insensitive name), or empty if absent
+        std::string_view Header(std::string_view name) const;
+
+        // Raw value of a query parameter; false if the key is absent
+        bool QueryParam(std::string_view name, std::string_view& value) const;
+    };
+
+    // Incremental HTTP/1.x request parser.
+    //
+    // Parse() is given whatever has been received so far for the next request
+    // and either completes it, asks for more data, or rejects it. It never
+    // copies or allocates: the request is a set of views into the input. Lines
+    // already scanned are remembered between calls so a request trickling in
+    // over many reads is not rescanned from the start each time. Pipelined
+    // requests are handled by calling Parse() again at data + consumed.
+    class HttpParser {
+    public:
+        enum class Result {
+            Complete,       // request filled in, consumed set
+            Incomplete,     // need more data
+            Invalid,        // malformed: respond 400 and close
+            TooLarge        // over the header or request size limits: respond 431 and close
+        };
+
+        static constexpr size_t kMaxHeaderBytes = 8192;
+        static constexpr size_t kMaxRequestBytes = 16384;
+
+    private:
+        size_t scanned_;    // Offset of the first line not yet checked for the blank line
+        size_t head_start_; // Offset of the request line, past any stray blank lines
+
+        static Result ParseHead(const char* data, size_t head_size, HttpRequest& request);
+
+    public:
+        HttpParser();
+
+        Result Parse(const char* data, size_t size, HttpRequest& request, size_t& consumed);
+
+        // Forget partial progress (e.g. after the caller drops buffered data)
+        void Reset() { scanned_ = 0; head_start_ = 0; }
+    };
+
+    // Case-insensitive ASCII comparison
+    bool EqualsIgnoreCase(std::string_view a, std::string_view b);
+
+    // Decodes %XX escapes and '+' in a query value; false if an escape is malformed
+    bool PercentDecode(std::string_view encoded, std::string& out);
+
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "chunked_response.h"
+#include <string>
+#include <cstdint>
+
+namespace PCMonitor {
+
+    // Unix-seconds bounds on the rows exported from the CSV log; 0 leaves
+    // that end open.
+    struct ExportRange {
+        int64_t from;
+        int64_t to;
+    };
+
+    // Body generators over the CSV log file. Rows are read and emitted a
+    // chunk at a time, so memory stays constant whatever the range covers.
+    // The header row is written once even if the file has one per run.
+    BodyGenerator MakeCsvExport(const std::string& log_path, ExportRange range);
+
+    // Same rows as a JSON array of objects keyed by the CSV column names
+    // (numbers unquoted, empty cells null, the timestamp as a string).
+    BodyGenerator MakeJsonHistory(const std::string& log_path, ExportRange range);
+
+}
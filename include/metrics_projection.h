@@ -0,0 +1,98 @@
+#pragma once
+
+#include "metrics_types.h"
+#include <string>
+#include <string_view>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace PCMonitor {
+
+    // Appends one field of a snapshot as a JSON value (arrays as [a,b,...]),
+    // with the same number formatting as the full /api/metrics document
+    void AppendFieldValue(std::string& out, const SystemMetrics& metrics, const FieldInfo& field);
+
+    // One scalar field as a double; NaN for array fields
+    double ReadScalarField(const SystemMetrics& metrics, const FieldInfo& field);
+
+    // The scalar field named "group.field"; null if unknown or an array
+    const FieldInfo* FindScalarField(std::string_view name);
+
+    // Appends every scalar field and its "group.field" name, in table order:
+    // the per-field series of the detectors and statistics. Fan arrays
+    // change length and are left out.
+    void ListScalarSeries(std::vector<const FieldInfo*>& fields, std::vector<std::string>& names);
+
+    // Resolves a ?series= list against series names: each comma-separated
+    // entry is a full name or a group prefix ("cpu" selects "cpu.*", device
+    // series included). An empty list selects everything. Returns false and
+    // describes the first entry matching nothing in error.
+    bool MatchSeries(std::string_view list, const std::vector<std::string>& names, std::vector<bool>& selected,
+                     std::string& error);
+
+    // A compiled ?fields= selection for /api/metrics.
+    //
+    // The selection is a comma-separated list of "group.field", "group.*" or
+    // "group" entries; array fields also accept "group.field[N]" to pick single
+    // devices. Compiling resolves every entry against the field tables and lays
+    // out the output as literal text segments (keys, braces, commas) each
+    // followed by one value, so writing a snapshot only formats the selected
+    // numbers. Output order follows the field tables, not the query.
+    class ProjectionPlan {
+    private:
+        enum class SlotKind : uint8_t {
+            Timestamp,
+            Version,
+            Field,
+            Element     // One entry of an array field
+        };
+
+        struct Segment {
+            std::string text;           // Emitted before the value
+            SlotKind kind;
+            const FieldInfo* field;
+            size_t element;
+        };
+
+        std::vector<Segment> segments_;
+        std::string tail_;
+        size_t field_count_;
+        std::string signature_;
+
+    public:
+        ProjectionPlan();
+
+        // Returns nullptr and describes the problem in error if the selection
+        // names an unknown group or field.
+        static std::shared_ptr<const ProjectionPlan> Compile(std::string_view selection, std::string& error);
+
+        // Appends the projected JSON document for one snapshot
+        void Write(const MetricsSnapshot& snapshot, std::string& out) const;
+
+        size_t GetFieldCount() const { return field_count_; }
+
+        // The output layout: equal for selections that produce identical
+        // documents, however they were spelled ("cpu" vs "cpu.*", order)
+        const std::string& GetSignature() const { return signature_; }
+    };
+
+    // Compiled plans keyed by the raw ?fields= value, so each distinct
+    // selection is parsed once however many clients poll with it.
+    class ProjectionCache {
+    private:
+        static constexpr size_t kMaxPlans = 64;
+
+        std::mutex mutex_;
+        std::unordered_map<std::string, std::shared_ptr<const ProjectionPlan>> plans_;
+
+    public:
+        // The key is the selection as it appeared in the query string; it is
+        // percent-decoded only when a plan has to be compiled.
+        std::shared_ptr<const ProjectionPlan> Get(std::string_view raw_selection, std::string& error);
+
+        size_t GetPlanCount();
+    };
+
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "metrics_types.h"
+#include <string>
+#include <cstdint>
+
+namespace PCMonitor {
+
+    // Serializers generated from the field lists in metrics_types.h. Each one
+    // is a VisitGroups/VisitFields walk, so it compiles to a straight run of
+    // literal appends and std::to_chars calls with no per-field dispatch.
+    // Numbers are formatted directly into the output string: with its
+    // capacity reserved, writing a snapshot doesn't allocate.
+
+    // Per-device fields get this many CSV columns, empty where absent
+    constexpr size_t kCsvArrayColumns = kMaxFans;
+
+    // The /api/metrics document: compact JSON with timestamp, version and
+    // every group in table order (the same document ?fields=* selects).
+    // Doubles have one decimal place.
+    void WriteMetricsJson(const MetricsSnapshot& snapshot, std::string& out);
+    std::string EncodeMetricsJson(const MetricsSnapshot& snapshot);
+
+    // CSV log columns: Timestamp, then <group>_<field> for every field, with
+    // arrays spread over kCsvArrayColumns numbered columns
+    const std::string& GetCsvHeader();
+
+    // One log row matching GetCsvHeader(), timestamp in local time
+    // ("YYYY-MM-DD HH:MM:SS"), doubles with two decimal places
+    void WriteCsvRow(int64_t unix_seconds, const SystemMetrics& metrics, std::string& out);
+
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "metrics_types.h"
+#include "frame_sink.h"
+#include <string>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+namespace PCMonitor {
+
+    class PerformanceMonitor;
+    class SnapshotCache;
+    class SnapshotDeltas;
+
+    // Push fan-out for /api/stream (Server-Sent Events) and /api/stream.bin
+    // (length-prefixed binary frames). Every published snapshot is encoded
+    // once through the same cache the polling endpoint uses, and the same
+    // frame buffer is shared by all subscribers.
+    //
+    // With a SnapshotDeltas source, subscribers may ask for deltas: each
+    // frame then carries only the fields changed since the last frame that
+    // client was sent. Deltas are encoded once per distinct base version per
+    // snapshot, so clients that keep up all share one frame.
+    class MetricsStream {
+    public:
+        using SocketHandle = FrameSink::SocketHandle;
+
+        enum class Framing {
+            ServerSentEvents,   // "id:" + "data:" lines, for text payloads
+            LengthPrefixed      // u32 little-endian length + raw payload
+        };
+
+    private:
+        struct Subscriber {
+            FrameSink sink;             // Its frame version is the next delta's base
+            bool deltas;
+        };
+
+        struct PendingSubscriber {
+            SocketHandle socket;
+            bool deltas;
+            uint64_t since;             // Version the client already has, 0 if none
+        };
+
+        SnapshotCache& cache_;
+        SnapshotDeltas* deltas_;
+        Framing framing_;
+        std::atomic<bool> running_;
+        std::unique_ptr<std::thread> stream_thread_;
+
+        // Shared with the monitoring and web server threads
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        uint64_t published_version_;
+        std::vector<PendingSubscriber> new_subscribers_;
+
+        // Owned by the stream thread
+        std::vector<Subscriber> subscribers_;
+        std::shared_ptr<const std::string> latest_frame_;
+        uint64_t latest_version_;
+        // Delta frames for latest_version_ keyed by base, with the version each carries
+        std::unordered_map<uint64_t, std::pair<std::shared_ptr<const std::string>, uint64_t>> delta_frames_;
+
+        std::atomic<size_t> subscriber_count_;
+        std::atomic<uint64_t> frames_coalesced_;
+
+        void StreamLoop();
+        std::shared_ptr<const std::string> EncodeFrame(const std::string& payload, uint64_t version) const;
+        std::shared_ptr<const std::string> FrameFor(const Subscriber& subscriber, uint64_t& version);
+        void QueueFrame(Subscriber& subscriber, const std::shared_ptr<const std::string>& frame, uint64_t version);
+
+    public:
+        // The stream must outlive the monitor's running period (it registers a
+        // snapshot listener that refers back to it).
+        MetricsStream(PerformanceMonitor& monitor, SnapshotCache& cache,
+                      Framing framing = Framing::ServerSentEvents, SnapshotDeltas* deltas = nullptr);
+        ~MetricsStream();
+
+        bool Start();
+        void Stop();
+
+        // Takes ownership of a connected socket whose SSE response headers
+        // have already been sent. A delta subscriber that already has
+        // version `since` (e.g. from Last-Event-ID) starts with a delta.
+        void AddSubscriber(SocketHandle socket, bool deltas = false, uint64_t since = 0);
+
+        size_t GetSubscriberCount() const { return subscriber_count_; }
+        uint64_t GetFramesCoalesced() const { return frames_coalesced_; }
+    };
+
+}
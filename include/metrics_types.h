@@ -1,12 +1,61 @@
 #pragma once
 
 #include <cstdint>
-#include <vector>
+#include <cstddef>
 #include <chrono>
 #include <string>
+#include <type_traits>
+#include <initializer_list>
 
 namespace PCMonitor {
 
+    // Fixed-capacity array stored inline, so the structs holding one copy
+    // without touching the heap. Elements beyond the capacity are dropped.
+    template <typename T, size_t Capacity>
+    struct InlineArray {
+        T values[Capacity] = {};
+        uint32_t count = 0;
+
+        InlineArray() = default;
+
+        // Fills from a braced list, like the vector it replaces
+        InlineArray(std::initializer_list<T> init) {
+            for (const T& value : init) push_back(value);
+        }
+
+        static constexpr size_t capacity() { return Capacity; }
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+
+        const T& operator[](size_t index) const { return values[index]; }
+        T& operator[](size_t index) { return values[index]; }
+        const T* begin() const { return values; }
+        const T* end() const { return values + count; }
+
+        void clear() { count = 0; }
+
+        // False, and nothing stored, once full
+        bool push_back(T value) {
+            if (count == Capacity) return false;
+            values[count++] = value;
+            return true;
+        }
+
+        // Compares only the elements in use
+        bool operator==(const InlineArray& other) const {
+            if (count != other.count) return false;
+            for (uint32_t i = 0; i < count; ++i) {
+                if (values[i] != other.values[i]) return false;
+            }
+            return true;
+        }
+        bool operator!=(const InlineArray& other) const { return !(*this == other); }
+    };
+
+    // Most fans a snapshot reports
+    constexpr size_t kMaxFans = 8;
+    using FanSpeeds = InlineArray<uint32_t, kMaxFans>;
+
     struct GPUMetrics {
         uint32_t vram_total_mb;
         uint32_t vram_used_mb;
@@ -26,6 +75,20 @@ namespace PCMonitor {
         uint32_t temperature_c;
         double utilization_percent;
         uint32_t l3_cache_mb;
+
+        // Utilization over the burst samples of the interval (--burst);
+        // all equal utilization_percent when burst sampling is off
+        double utilization_mean_percent;
+        double utilization_min_percent;
+        double utilization_max_percent;
+        double utilization_p99_percent;
+
+        // Throttling, from the per-core performance counters (ThrottleDetector)
+        uint32_t effective_clock_mhz;
+        double performance_limit_percent;
+        uint32_t throttled_cores;
+        double throttled_seconds;
+        uint32_t frequency_loss_mhz;
     };
 
     struct RAMMetrics {
@@ -43,6 +106,20 @@ namespace PCMonitor {
         uint64_t random_write_iops;
         uint32_t temperature_c;
         double health_percent;
+
+        // Disk throughput over the burst samples of the interval
+        uint64_t read_mean_mbps;
+        uint64_t read_min_mbps;
+        uint64_t read_max_mbps;
+        uint64_t read_p99_mbps;
+        uint64_t write_mean_mbps;
+        uint64_t write_min_mbps;
+        uint64_t write_max_mbps;
+        uint64_t write_p99_mbps;
+
+        // Fixed volume with the highest share used, for capacity forecasts
+        double volume_used_gb;
+        double volume_capacity_gb;
     };
 
     struct NetworkMetrics {
@@ -50,6 +127,16 @@ namespace PCMonitor {
         uint64_t upload_speed_kbps;    // Current upload KB/s
         uint64_t total_received_mb;    // Total bytes received (session)
         uint64_t total_sent_mb;        // Total bytes sent (session)
+
+        // Throughput over the burst samples of the interval
+        uint64_t download_mean_kbps;
+        uint64_t download_min_kbps;
+        uint64_t download_max_kbps;
+        uint64_t download_p99_kbps;
+        uint64_t upload_mean_kbps;
+        uint64_t upload_min_kbps;
+        uint64_t upload_max_kbps;
+        uint64_t upload_p99_kbps;
     };
 
     struct PowerMetrics {
@@ -58,6 +145,17 @@ namespace PCMonitor {
         uint32_t cpu_power_w;
         uint32_t gpu_power_w;
         double efficiency_percent;
+
+        // Calibrated power model (PowerModel): RAM draw, and per domain the
+        // mean absolute error of its estimate against its measurements (NaN
+        // until the first one) and how many measurements it has been fitted to
+        uint32_t ram_power_w;
+        double cpu_model_error_w;
+        double gpu_model_error_w;
+        double ram_model_error_w;
+        uint64_t cpu_model_samples;
+        uint64_t gpu_model_samples;
+        uint64_t ram_model_samples;
     };
 
     struct ThermalMetrics {
@@ -65,7 +163,7 @@ namespace PCMonitor {
         uint32_t gpu_temp_c;
         uint32_t motherboard_temp_c;
         uint32_t case_temp_c;
-        std::vector<uint32_t> fan_speeds_rpm;
+        FanSpeeds fan_speeds_rpm;
     };
 
     struct SystemMetrics {
@@ -78,4 +176,251 @@ namespace PCMonitor {
         ThermalMetrics thermal;
     };
 
+    // Snapshots are copied on every publish and by every consumer; keeping
+    // them trivially copyable keeps the sampling path free of allocations
+    static_assert(std::is_trivially_copyable_v<SystemMetrics>, "SystemMetrics must copy without allocating");
+
+    // A published, immutable copy of SystemMetrics. The version increases by one
+    // every time the sampler completes a collection cycle.
+    struct MetricsSnapshot {
+        uint64_t version;
+        int64_t timestamp;      // Unix time (seconds) when the snapshot was published
+        SystemMetrics metrics;
+    };
+
+    // Self-monitoring: time spent in each collector, as a fixed-bucket
+    // histogram (Prometheus-style, bounds in seconds).
+    enum class CollectorId : uint8_t {
+        GPU,
+        CPU,
+        RAM,
+        Storage,
+        Network,
+        Power,
+        Thermal,
+        Cycle,      // Whole collection pass
+        Count
+    };
+
+    constexpr size_t kCollectorCount = static_cast<size_t>(CollectorId::Count);
+
+    inline constexpr const char* kCollectorNames[kCollectorCount] = {
+        "gpu", "cpu", "ram", "storage", "network", "power", "thermal", "cycle"
+    };
+
+    constexpr size_t kLatencyBucketCount = 12;
+
+    inline constexpr double kLatencyBucketBounds[kLatencyBucketCount] = {
+        0.00001, 0.000025, 0.00005, 0.0001, 0.00025, 0.0005,
+        0.001, 0.0025, 0.005, 0.01, 0.025, 0.05
+    };
+
+    struct LatencyHistogram {
+        uint64_t buckets[kLatencyBucketCount + 1];  // Per bucket, last one is +Inf
+        uint64_t count;
+        double sum_seconds;
+
+        void Record(double seconds) {
+            size_t bucket = 0;
+            while (bucket < kLatencyBucketCount && seconds > kLatencyBucketBounds[bucket]) {
+                ++bucket;
+            }
+            buckets[bucket]++;
+            count++;
+            sum_seconds += seconds;
+        }
+    };
+
+    struct CollectorLatencies {
+        LatencyHistogram collectors[kCollectorCount];
+    };
+
+    // Field tables describing every member of the metric structs, in
+    // declaration order. Offsets are relative to SystemMetrics so serializers
+    // can walk a snapshot without per-field code. Keep in sync with the structs.
+    enum class FieldType : uint8_t {
+        U32,
+        U64,
+        F64,
+        U32Array    // FanSpeeds (InlineArray<uint32_t, kMaxFans>)
+    };
+
+    struct FieldInfo {
+        const char* name;
+        const char* unit;
+        FieldType type;
+        size_t offset;
+    };
+
+    struct FieldGroup {
+        const char* name;
+        const FieldInfo* fields;
+        size_t field_count;
+    };
+
+    // C++ type behind each FieldType
+    template <FieldType> struct FieldStorage;
+    template <> struct FieldStorage<FieldType::U32> { using type = uint32_t; };
+    template <> struct FieldStorage<FieldType::U64> { using type = uint64_t; };
+    template <> struct FieldStorage<FieldType::F64> { using type = double; };
+    template <> struct FieldStorage<FieldType::U32Array> { using type = FanSpeeds; };
+
+    // One list per struct, in declaration order: X(group, Struct, member, unit, type).
+    // Each list generates both the runtime table below and the typed
+    // VisitFields overload, so the two can't drift apart.
+#define PCMONITOR_GPU_FIELDS(X) \
+    X(gpu, GPUMetrics, vram_total_mb, "MB", U32) \
+    X(gpu, GPUMetrics, vram_used_mb, "MB", U32) \
+    X(gpu, GPUMetrics, core_clock_mhz, "MHz", U32) \
+    X(gpu, GPUMetrics, memory_clock_mhz, "MHz", U32) \
+    X(gpu, GPUMetrics, temperature_c, "C", U32) \
+    X(gpu, GPUMetrics, power_draw_w, "W", U32) \
+    X(gpu, GPUMetrics, utilization_percent, "%", U32) \
+    X(gpu, GPUMetrics, memory_bandwidth_mbps, "MB/s", U64)
+
+#define PCMONITOR_CPU_FIELDS(X) \
+    X(cpu, CPUMetrics, core_count, "", U32) \
+    X(cpu, CPUMetrics, thread_count, "", U32) \
+    X(cpu, CPUMetrics, base_clock_mhz, "MHz", U32) \
+    X(cpu, CPUMetrics, current_clock_mhz, "MHz", U32) \
+    X(cpu, CPUMetrics, temperature_c, "C", U32) \
+    X(cpu, CPUMetrics, utilization_percent, "%", F64) \
+    X(cpu, CPUMetrics, l3_cache_mb, "MB", U32) \
+    X(cpu, CPUMetrics, utilization_mean_percent, "%", F64) \
+    X(cpu, CPUMetrics, utilization_min_percent, "%", F64) \
+    X(cpu, CPUMetrics, utilization_max_percent, "%", F64) \
+    X(cpu, CPUMetrics, utilization_p99_percent, "%", F64) \
+    X(cpu, CPUMetrics, effective_clock_mhz, "MHz", U32) \
+    X(cpu, CPUMetrics, performance_limit_percent, "%", F64) \
+    X(cpu, CPUMetrics, throttled_cores, "", U32) \
+    X(cpu, CPUMetrics, throttled_seconds, "s", F64) \
+    X(cpu, CPUMetrics, frequency_loss_mhz, "MHz", U32)
+
+#define PCMONITOR_RAM_FIELDS(X) \
+    X(ram, RAMMetrics, total_mb, "MB", U64) \
+    X(ram, RAMMetrics, used_mb, "MB", U64) \
+    X(ram, RAMMetrics, speed_mhz, "MHz", U32) \
+    X(ram, RAMMetrics, latency_cl, "cycles", U32) \
+    X(ram, RAMMetrics, utilization_percent, "%", F64)
+
+#define PCMONITOR_STORAGE_FIELDS(X) \
+    X(storage, StorageMetrics, seq_read_mbps, "MB/s", U64) \
+    X(storage, StorageMetrics, seq_write_mbps, "MB/s", U64) \
+    X(storage, StorageMetrics, random_read_iops, "IOPS", U64) \
+    X(storage, StorageMetrics, random_write_iops, "IOPS", U64) \
+    X(storage, StorageMetrics, temperature_c, "C", U32) \
+    X(storage, StorageMetrics, health_percent, "%", F64) \
+    X(storage, StorageMetrics, read_mean_mbps, "MB/s", U64) \
+    X(storage, StorageMetrics, read_min_mbps, "MB/s", U64) \
+    X(storage, StorageMetrics, read_max_mbps, "MB/s", U64) \
+    X(storage, StorageMetrics, read_p99_mbps, "MB/s", U64) \
+    X(storage, StorageMetrics, write_mean_mbps, "MB/s", U64) \
+    X(storage, StorageMetrics, write_min_mbps, "MB/s", U64) \
+    X(storage, StorageMetrics, write_max_mbps, "MB/s", U64) \
+    X(storage, StorageMetrics, write_p99_mbps, "MB/s", U64) \
+    X(storage, StorageMetrics, volume_used_gb, "GB", F64) \
+    X(storage, StorageMetrics, volume_capacity_gb, "GB", F64)
+
+#define PCMONITOR_NETWORK_FIELDS(X) \
+    X(network, NetworkMetrics, download_speed_kbps, "KB/s", U64) \
+    X(network, NetworkMetrics, upload_speed_kbps, "KB/s", U64) \
+    X(network, NetworkMetrics, total_received_mb, "MB", U64) \
+    X(network, NetworkMetrics, total_sent_mb, "MB", U64) \
+    X(network, NetworkMetrics, download_mean_kbps, "KB/s", U64) \
+    X(network, NetworkMetrics, download_min_kbps, "KB/s", U64) \
+    X(network, NetworkMetrics, download_max_kbps, "KB/s", U64) \
+    X(network, NetworkMetrics, download_p99_kbps, "KB/s", U64) \
+    X(network, NetworkMetrics, upload_mean_kbps, "KB/s", U64) \
+    X(network, NetworkMetrics, upload_min_kbps, "KB/s", U64) \
+    X(network, NetworkMetrics, upload_max_kbps, "KB/s", U64) \
+    X(network, NetworkMetrics, upload_p99_kbps, "KB/s", U64)
+
+#define PCMONITOR_POWER_FIELDS(X) \
+    X(power, PowerMetrics, psu_wattage, "W", U32) \
+    X(power, PowerMetrics, system_power_w, "W", U32) \
+    X(power, PowerMetrics, cpu_power_w, "W", U32) \
+    X(power, PowerMetrics, gpu_power_w, "W", U32) \
+    X(power, PowerMetrics, efficiency_percent, "%", F64) \
+    X(power, PowerMetrics, ram_power_w, "W", U32) \
+    X(power, PowerMetrics, cpu_model_error_w, "W", F64) \
+    X(power, PowerMetrics, gpu_model_error_w, "W", F64) \
+    X(power, PowerMetrics, ram_model_error_w, "W", F64) \
+    X(power, PowerMetrics, cpu_model_samples, "", U64) \
+    X(power, PowerMetrics, gpu_model_samples, "", U64) \
+    X(power, PowerMetrics, ram_model_samples, "", U64)
+
+#define PCMONITOR_THERMAL_FIELDS(X) \
+    X(thermal, ThermalMetrics, cpu_temp_c, "C", U32) \
+    X(thermal, ThermalMetrics, gpu_temp_c, "C", U32) \
+    X(thermal, ThermalMetrics, motherboard_temp_c, "C", U32) \
+    X(thermal, ThermalMetrics, case_temp_c, "C", U32) \
+    X(thermal, ThermalMetrics, fan_speeds_rpm, "RPM", U32Array)
+
+    // X(group, table, fields) for each member of SystemMetrics
+#define PCMONITOR_METRIC_GROUPS(X) \
+    X(gpu, kGPUFields, PCMONITOR_GPU_FIELDS) \
+    X(cpu, kCPUFields, PCMONITOR_CPU_FIELDS) \
+    X(ram, kRAMFields, PCMONITOR_RAM_FIELDS) \
+    X(storage, kStorageFields, PCMONITOR_STORAGE_FIELDS) \
+    X(network, kNetworkFields, PCMONITOR_NETWORK_FIELDS) \
+    X(power, kPowerFields, PCMONITOR_POWER_FIELDS) \
+    X(thermal, kThermalFields, PCMONITOR_THERMAL_FIELDS)
+
+#define PCMONITOR_FIELD(group, Struct, member, unit, type) \
+    FieldInfo{ #member, unit, FieldType::type, offsetof(SystemMetrics, group) + offsetof(Struct, member) },
+#define PCMONITOR_FIELD_TABLE(group, table, fields) \
+    inline constexpr FieldInfo table[] = { fields(PCMONITOR_FIELD) };
+
+    PCMONITOR_METRIC_GROUPS(PCMONITOR_FIELD_TABLE)
+
+#undef PCMONITOR_FIELD_TABLE
+#undef PCMONITOR_FIELD
+
+#define PCMONITOR_CHECK_FIELD(group, Struct, member, unit, kind) \
+    static_assert(std::is_same_v<decltype(Struct::member), FieldStorage<FieldType::kind>::type>, \
+                  #Struct "::" #member " doesn't match its field type");
+#define PCMONITOR_CHECK_FIELDS(group, table, fields) fields(PCMONITOR_CHECK_FIELD)
+
+    PCMONITOR_METRIC_GROUPS(PCMONITOR_CHECK_FIELDS)
+
+#undef PCMONITOR_CHECK_FIELDS
+#undef PCMONITOR_CHECK_FIELD
+
+#define PCMONITOR_GROUP(group, table, fields) \
+    FieldGroup{ #group, table, sizeof(table) / sizeof(table[0]) },
+
+    inline constexpr FieldGroup kMetricGroups[] = {
+        PCMONITOR_METRIC_GROUPS(PCMONITOR_GROUP)
+    };
+
+#undef PCMONITOR_GROUP
+
+    // Compile-time walks over the same lists. VisitFields calls
+    // visitor(name, value) for each member with value typed as declared, and
+    // VisitGroups calls visitor(group, metrics) for each group, so a
+    // serializer written as a generic lambda expands to straight-line code
+    // with no per-field type dispatch.
+#define PCMONITOR_VISIT_FIELD(group, Struct, member, unit, type) \
+    visitor(#member, metrics.member);
+#define PCMONITOR_VISIT_FIELDS(group, table, fields) \
+    template <typename Visitor> \
+    void VisitFields(const decltype(SystemMetrics::group)& metrics, Visitor&& visitor) { \
+        fields(PCMONITOR_VISIT_FIELD) \
+    }
+
+    PCMONITOR_METRIC_GROUPS(PCMONITOR_VISIT_FIELDS)
+
+#undef PCMONITOR_VISIT_FIELDS
+#undef PCMONITOR_VISIT_FIELD
+
+#define PCMONITOR_VISIT_GROUP(group, table, fields) \
+    visitor(FieldGroup{ #group, table, sizeof(table) / sizeof(table[0]) }, metrics.group);
+
+    template <typename Visitor>
+    void VisitGroups(const SystemMetrics& metrics, Visitor&& visitor) {
+        PCMONITOR_METRIC_GROUPS(PCMONITOR_VISIT_GROUP)
+    }
+
+#undef PCMONITOR_VISIT_GROUP
+
 }
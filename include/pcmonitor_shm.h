@@ -0,0 +1,244 @@
+/*
+ * Shared-memory view of the latest PC Monitor snapshot.
+ *
+ * pc_monitor publishes every snapshot into a named file mapping. Local
+ * processes map it read-only and copy samples out with plain memory reads,
+ * no socket round-trip or parsing. This header is plain C so it can be used
+ * from any language with a C FFI; the reader functions are static inline and
+ * need nothing but kernel32.
+ *
+ * Layout: pcmon_shm_header, then the latest sample, then a ring of the last
+ * history_capacity samples. A sequence counter (seqlock) guards all of it:
+ * the writer makes it odd before changing anything and even afterwards, and
+ * readers retry until they see the same even value before and after copying.
+ *
+ *     pcmon_shm_reader reader;
+ *     pcmon_shm_sample sample;
+ *     if (pcmon_shm_open(&reader) == 0 && pcmon_shm_read_latest(&reader, &sample) == 0) {
+ *         printf("CPU %.1f%%\n", sample.cpu_utilization_percent);
+ *     }
+ *     pcmon_shm_close(&reader);
+ */
+#ifndef PCMONITOR_SHM_H
+#define PCMONITOR_SHM_H
+
+#include <stdint.h>
+#include <string.h>
+
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PCMON_SHM_NAME "Local\\PCMonitorMetrics"
+#define PCMON_SHM_MAGIC 0x4E4F4D50u     /* "PMON" */
+#define PCMON_SHM_LAYOUT_VERSION 6u
+#define PCMON_SHM_MAX_FANS 8
+#define PCMON_SHM_HISTORY 120
+#define PCMON_SHM_READ_RETRIES 1000
+
+/* One snapshot, flattened: fields follow SystemMetrics in declaration order */
+typedef struct pcmon_shm_sample {
+    uint64_t version;
+    int64_t timestamp;
+
+    uint32_t gpu_vram_total_mb;
+    uint32_t gpu_vram_used_mb;
+    uint32_t gpu_core_clock_mhz;
+    uint32_t gpu_memory_clock_mhz;
+    uint32_t gpu_temperature_c;
+    uint32_t gpu_power_draw_w;
+    uint32_t gpu_utilization_percent;
+    uint64_t gpu_memory_bandwidth_mbps;
+
+    uint32_t cpu_core_count;
+    uint32_t cpu_thread_count;
+    uint32_t cpu_base_clock_mhz;
+    uint32_t cpu_current_clock_mhz;
+    uint32_t cpu_temperature_c;
+    double cpu_utilization_percent;
+    uint32_t cpu_l3_cache_mb;
+    double cpu_utilization_mean_percent;
+    double cpu_utilization_min_percent;
+    double cpu_utilization_max_percent;
+    double cpu_utilization_p99_percent;
+    uint32_t cpu_effective_clock_mhz;
+    double cpu_performance_limit_percent;
+    uint32_t cpu_throttled_cores;
+    double cpu_throttled_seconds;
+    uint32_t cpu_frequency_loss_mhz;
+
+    uint64_t ram_total_mb;
+    uint64_t ram_used_mb;
+    uint32_t ram_speed_mhz;
+    uint32_t ram_latency_cl;
+    double ram_utilization_percent;
+
+    uint64_t storage_seq_read_mbps;
+    uint64_t storage_seq_write_mbps;
+    uint64_t storage_random_read_iops;
+    uint64_t storage_random_write_iops;
+    uint32_t storage_temperature_c;
+    double storage_health_percent;
+    uint64_t storage_read_mean_mbps;
+    uint64_t storage_read_min_mbps;
+    uint64_t storage_read_max_mbps;
+    uint64_t storage_read_p99_mbps;
+    uint64_t storage_write_mean_mbps;
+    uint64_t storage_write_min_mbps;
+    uint64_t storage_write_max_mbps;
+    uint64_t storage_write_p99_mbps;
+    double storage_volume_used_gb;
+    double storage_volume_capacity_gb;
+
+    uint64_t network_download_speed_kbps;
+    uint64_t network_upload_speed_kbps;
+    uint64_t network_total_received_mb;
+    uint64_t network_total_sent_mb;
+    uint64_t network_download_mean_kbps;
+    uint64_t network_download_min_kbps;
+    uint64_t network_download_max_kbps;
+    uint64_t network_download_p99_kbps;
+    uint64_t network_upload_mean_kbps;
+    uint64_t network_upload_min_kbps;
+    uint64_t network_upload_max_kbps;
+    uint64_t network_upload_p99_kbps;
+
+    uint32_t power_psu_wattage;
+    uint32_t power_system_power_w;
+    uint32_t power_cpu_power_w;
+    uint32_t power_gpu_power_w;
+    double power_efficiency_percent;
+    uint32_t power_ram_power_w;
+    double power_cpu_model_error_w;
+    double power_gpu_model_error_w;
+    double power_ram_model_error_w;
+    uint64_t power_cpu_model_samples;
+    uint64_t power_gpu_model_samples;
+    uint64_t power_ram_model_samples;
+
+    uint32_t thermal_cpu_temp_c;
+    uint32_t thermal_gpu_temp_c;
+    uint32_t thermal_motherboard_temp_c;
+    uint32_t thermal_case_temp_c;
+    uint32_t thermal_fan_count;     /* Valid entries in thermal_fan_speeds_rpm */
+    uint32_t thermal_fan_speeds_rpm[PCMON_SHM_MAX_FANS];
+} pcmon_shm_sample;
+
+typedef struct pcmon_shm_header {
+    uint32_t magic;
+    uint32_t layout_version;
+    uint32_t header_size;           /* Offset of the latest sample */
+    uint32_t sample_size;
+    uint32_t history_capacity;
+    uint32_t reserved;
+    volatile uint64_t sequence;     /* Seqlock: odd while the writer is updating */
+    uint64_t history_count;         /* Valid samples in the ring, at most history_capacity */
+    uint64_t history_next;          /* Ring slot the next sample goes to */
+    uint8_t padding[16];
+} pcmon_shm_header;
+
+typedef struct pcmon_shm_region {
+    pcmon_shm_header header;
+    pcmon_shm_sample latest;
+    pcmon_shm_sample history[PCMON_SHM_HISTORY];
+} pcmon_shm_region;
+
+typedef struct pcmon_shm_reader {
+    HANDLE mapping;
+    const pcmon_shm_region* region;
+} pcmon_shm_reader;
+
+/* Full barrier; also keeps the compiler from moving the copies across it */
+#define PCMON_SHM_BARRIER() MemoryBarrier()
+
+/* Returns 0 on success, -1 if pc_monitor isn't running, -2 on a layout mismatch */
+static inline int pcmon_shm_open(pcmon_shm_reader* reader) {
+    reader->mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, PCMON_SHM_NAME);
+    reader->region = NULL;
+    if (reader->mapping == NULL) return -1;
+
+    reader->region = (const pcmon_shm_region*)MapViewOfFile(reader->mapping, FILE_MAP_READ, 0, 0, sizeof(pcmon_shm_region));
+    if (reader->region == NULL) {
+        CloseHandle(reader->mapping);
+        reader->mapping = NULL;
+        return -1;
+    }
+
+    if (reader->region->header.magic != PCMON_SHM_MAGIC ||
+        reader->region->header.layout_version != PCMON_SHM_LAYOUT_VERSION ||
+        reader->region->header.sample_size != sizeof(pcmon_shm_sample) ||
+        reader->region->header.history_capacity != PCMON_SHM_HISTORY) {
+        UnmapViewOfFile(reader->region);
+        CloseHandle(reader->mapping);
+        reader->region = NULL;
+        reader->mapping = NULL;
+        return -2;
+    }
+    return 0;
+}
+
+static inline void pcmon_shm_close(pcmon_shm_reader* reader) {
+    if (reader->region != NULL) UnmapViewOfFile(reader->region);
+    if (reader->mapping != NULL) CloseHandle(reader->mapping);
+    reader->region = NULL;
+    reader->mapping = NULL;
+}
+
+/* Copies the latest sample. Returns 0 on success, -1 if no snapshot has been
+ * published yet, -3 if the writer kept it busy for every retry. */
+static inline int pcmon_shm_read_latest(const pcmon_shm_reader* reader, pcmon_shm_sample* out) {
+    const pcmon_shm_header* header = &reader->region->header;
+    int attempt;
+
+    for (attempt = 0; attempt < PCMON_SHM_READ_RETRIES; ++attempt) {
+        uint64_t before = header->sequence;
+        PCMON_SHM_BARRIER();
+        if (before & 1) continue;
+
+        memcpy(out, (const void*)&reader->region->latest, sizeof(*out));
+        PCMON_SHM_BARRIER();
+
+        if (header->sequence == before) {
+            return out->version != 0 ? 0 : -1;
+        }
+    }
+    return -3;
+}
+
+/* Copies up to max_samples of the most recent history, oldest first.
+ * Returns the number copied, or -3 if the writer kept it busy. */
+static inline int pcmon_shm_read_history(const pcmon_shm_reader* reader, pcmon_shm_sample* out, int max_samples) {
+    const pcmon_shm_header* header = &reader->region->header;
+    int attempt;
+
+    for (attempt = 0; attempt < PCMON_SHM_READ_RETRIES; ++attempt) {
+        uint64_t before = header->sequence;
+        uint64_t count, next;
+        int copied, i;
+        PCMON_SHM_BARRIER();
+        if (before & 1) continue;
+
+        count = header->history_count;
+        next = header->history_next;
+        copied = (count < (uint64_t)max_samples) ? (int)count : max_samples;
+        for (i = 0; i < copied; ++i) {
+            uint64_t slot = (next + PCMON_SHM_HISTORY - (uint64_t)copied + (uint64_t)i) % PCMON_SHM_HISTORY;
+            memcpy(&out[i], (const void*)&reader->region->history[slot], sizeof(out[i]));
+        }
+        PCMON_SHM_BARRIER();
+
+        if (header->sequence == before) return copied;
+    }
+    return -3;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PCMONITOR_SHM_H */
@@ -1,6 +1,10 @@
 #pragma once
 
 #include "metrics_types.h"
+#include "burst_window.h"
+#include "throttle_detector.h"
+#include "power_model.h"
+#include "sample_recording.h"
 #include <windows.h>
 #include <pdh.h>
 #include <pdhmsg.h>
@@ -18,6 +22,8 @@
 #include <vector>
 #include <string>
 #include <unordered_map>
+#include <mutex>
+#include <functional>
 
 #pragma comment(lib, "pdh.lib")
 
@@ -46,6 +52,8 @@ namespace PCMonitor {
         // Data collection
         std::chrono::milliseconds collection_interval_;
         std::ofstream log_file_;
+        std::string log_path_;
+        std::string log_line_;      // Reused for every row
         
         // Performance counters
         std::unordered_map<std::string, PDH_HCOUNTER> performance_counters_;
@@ -59,19 +67,86 @@ namespace PCMonitor {
         PowerMetrics power_metrics_;
         ThermalMetrics thermal_metrics_;
 
+        // Published snapshot (copied out of the metrics above once per cycle)
+        mutable std::mutex snapshot_mutex_;
+        MetricsSnapshot snapshot_;
+        std::atomic<uint64_t> snapshot_version_;
+
+        // Collector timings: accumulated by the monitoring thread, copied out
+        // under snapshot_mutex_ on publish
+        CollectorLatencies latency_work_;
+        CollectorLatencies collector_latencies_;
+
+        // Callbacks invoked on the monitoring thread after each publish
+        std::mutex listeners_mutex_;
+        std::vector<std::function<void(const MetricsSnapshot&)>> snapshot_listeners_;
+        std::vector<std::function<void(std::chrono::steady_clock::time_point)>> burst_listeners_;
+
         // Network session totals (raw byte counters from PDH)
         uint64_t total_bytes_received_;
         uint64_t total_bytes_sent_;
 
+        // Sub-interval burst sampling of the hot counters (CPU, disk,
+        // network) on its own PDH query, so the per-interval rates above
+        // stay interval averages. Disabled when burst_interval_ is zero.
+        enum BurstSeries : size_t {
+            BurstCpu,
+            BurstDiskRead,
+            BurstDiskWrite,
+            BurstNetReceive,
+            BurstNetSend,
+            BurstSeriesCount
+        };
+
+        std::chrono::milliseconds burst_interval_;
+        PDH_HQUERY burst_query_;
+        PDH_HCOUNTER burst_counters_[BurstSeriesCount];
+        BurstWindow burst_windows_[BurstSeriesCount];
+
+        ThrottleDetector throttle_;
+
+        // Power: estimated by a model calibrated against RAPL energy meters
+        // (package and DRAM) and NVML whenever they report
+        PowerModel power_model_;
+        std::vector<PDH_HCOUNTER> package_power_counters_;
+        std::vector<PDH_HCOUNTER> dram_power_counters_;
+        bool gpu_power_measured_;
+
         // Cached CPU topology (never changes at runtime)
         uint32_t cached_core_count_;
         uint32_t cached_thread_count_;
 
+        // Raw readings of the current cycle. Live, the Read*Inputs methods
+        // fill them before each collector derives its metrics; in a replay
+        // they come from the recording instead and nothing is read.
+        CollectorInputs inputs_;
+
+        // --record / --replay
+        std::string record_path_;
+        std::unique_ptr<RecordingWriter> recording_;
+        std::string replay_path_;
+        double replay_speed_;
+        std::unique_ptr<RecordingReader> replay_;
+        int64_t replay_unix_;       // Wall clock of the cycle being replayed
+
         // Private methods
+        bool InitializeCollectors();
+        bool InitializeReplay();
         bool InitializeNVML();
         bool InitializePDH();
         bool InitializeWMI();
+        bool InitializeBurstQuery();
+        void InitializeEnergyMeters();
+        double ReadEnergyMeters(const std::vector<PDH_HCOUNTER>& counters);
         void CacheCPUTopology();
+        double ReadLargeCounter(const char* name);
+
+        void ReadGPUInputs();
+        void ReadCPUInputs();
+        void ReadRAMInputs();
+        void ReadStorageInputs();
+        void ReadNetworkInputs();
+        void ReadPowerInputs();
         
         void CollectGPUMetrics();
         void CollectCPUMetrics();
@@ -81,8 +156,17 @@ namespace PCMonitor {
         void CollectPowerMetrics();
         void CollectThermalMetrics();
         
+        void CollectBurstSample();
+        void SleepSampling(std::chrono::milliseconds duration);
+        BurstSummary TakeBurst(BurstSeries series, double fallback);
+
+        void TimeCollector(CollectorId id, void (PerformanceMonitor::*collect)());
         void LogMetrics();
+        void PublishSnapshot();
+        void RunCycle();
+        void ApplyReplayRecord(const RecordingReader::Record& record, std::chrono::steady_clock::time_point time);
         void MonitoringLoop();
+        void ReplayLoop();
         
     public:
         PerformanceMonitor(std::chrono::milliseconds interval = std::chrono::milliseconds(1000));
@@ -100,10 +184,61 @@ namespace PCMonitor {
         const NetworkMetrics& GetNetworkMetrics() const { return network_metrics_; }
         const PowerMetrics& GetPowerMetrics() const { return power_metrics_; }
         const ThermalMetrics& GetThermalMetrics() const { return thermal_metrics_; }
+
+        // Consistent copy of the last published cycle (safe from any thread)
+        MetricsSnapshot GetSnapshot() const;
+        uint64_t GetSnapshotVersion() const { return snapshot_version_.load(std::memory_order_acquire); }
+        CollectorLatencies GetCollectorLatencies() const;
+
+        // Listeners run on the monitoring thread right after a snapshot is
+        // published, so they must be cheap (e.g. wake another thread).
+        void AddSnapshotListener(std::function<void(const MetricsSnapshot&)> listener);
+
+        // Publishes metrics produced elsewhere as the next snapshot, running
+        // the listeners on the calling thread (pc_monitor_bench). Only while
+        // the monitoring thread isn't running.
+        void PublishMetrics(const SystemMetrics& metrics);
+
+        // Run on the monitoring thread after every burst sample (--burst), for
+        // consumers that sample their own high-resolution series on the same tick
+        void AddBurstListener(std::function<void(std::chrono::steady_clock::time_point)> listener);
+        bool IsBurstSampling() const { return burst_query_ != nullptr; }
+
+        // Per-core throttling episodes; set its event listener before Start()
+        ThrottleDetector& GetThrottleDetector() { return throttle_; }
         
         // Configuration
         void SetCollectionInterval(std::chrono::milliseconds interval);
+        std::chrono::milliseconds GetCollectionInterval() const { return collection_interval_; }
+
+        // Samples CPU, disk and network every interval between collections
+        // and publishes mean/min/max/p99 per cycle. Set before Initialize();
+        // zero (the default) turns it off.
+        void SetBurstInterval(std::chrono::milliseconds interval);
         void SetLogFile(const std::string& filename);
+        const std::string& GetLogFile() const { return log_path_; }
+
+        // Where the calibrated power model is loaded from and saved to
+        // (default pc_monitor_power_model.txt). Set before Initialize().
+        void SetPowerModelFile(const std::string& filename);
+
+        // Records every collector input and burst sample to a file
+        // (sample_recording.h). Set before Initialize().
+        void SetRecordFile(const std::string& filename);
+
+        // Runs the pipeline from a recording instead of the system: no
+        // counters are opened, the interval and topology come from the file
+        // and the power model starts from its defaults and isn't saved.
+        // speed 1 keeps the recorded pace, 100 runs it 100x faster and 0 as
+        // fast as possible. Set before Initialize(); the thread stops once
+        // the recording ends.
+        void SetReplayFile(const std::string& filename, double speed);
+        bool IsReplaying() const { return !replay_path_.empty(); }
+
+        // Replays up to and including the next recorded cycle on the calling
+        // thread, unpaced; false once the recording ends. For pc_monitor_bench,
+        // after Initialize() and only while the monitoring thread isn't running.
+        bool ReplayCycle();
     };
 
 }
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <string>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace PCMonitor {
+
+    // Recursive least squares with exponential forgetting: fits y ~ theta.x
+    // one observation at a time in O(N^2), with no stored history.
+    //
+    // Forgetting divides the covariance by lambda on every update, so it
+    // grows without bound along any direction the data never excites (a
+    // constant or always-zero regressor). Each variance is therefore capped
+    // at max_variance, and an update that would make anything non-finite is
+    // dropped, so the coefficients can't wind up to overflow.
+    template <size_t N>
+    class RecursiveLeastSquares {
+    private:
+        double theta_[N];
+        double covariance_[N][N];
+        double forgetting_;
+        double max_variance_;
+
+    public:
+        RecursiveLeastSquares(const double (&initial)[N], double confidence, double forgetting, double max_variance)
+            : forgetting_(forgetting)
+            , max_variance_(max_variance)
+        {
+            Reset(initial, confidence);
+        }
+
+        // Starts from the given coefficients; a larger confidence (the
+        // initial covariance diagonal) lets early observations move them more
+        void Reset(const double (&initial)[N], double confidence) {
+            for (size_t i = 0; i < N; ++i) {
+                theta_[i] = initial[i];
+                for (size_t j = 0; j < N; ++j) {
+                    covariance_[i][j] = i == j ? confidence : 0.0;
+                }
+            }
+        }
+
+        double Predict(const double (&x)[N]) const {
+            double y = 0.0;
+            for (size_t i = 0; i < N; ++i) y += theta_[i] * x[i];
+            return y;
+        }
+
+        // Folds in one observation; returns the error of the prediction made
+        // before it (the a-priori residual)
+        double Update(const double (&x)[N], double y) {
+            double px[N];
+            double denominator = forgetting_;
+            for (size_t i = 0; i < N; ++i) {
+                px[i] = 0.0;
+                for (size_t j = 0; j < N; ++j) px[i] += covariance_[i][j] * x[j];
+                denominator += x[i] * px[i];
+            }
+
+            double error = y - Predict(x);
+            if (!std::isfinite(error) || !std::isfinite(denominator) || !(denominator > 0.0)) return error;
+
+            double theta[N];
+            for (size_t i = 0; i < N; ++i) {
+                theta[i] = theta_[i] + px[i] / denominator * error;
+                if (!std::isfinite(theta[i])) return error;
+            }
+
+            // P = (P - P x x' P / (lambda + x' P x)) / lambda; P stays symmetric
+            double covariance[N][N];
+            for (size_t i = 0; i < N; ++i) {
+                for (size_t j = 0; j < N; ++j) {
+                    covariance[i][j] = (covariance_[i][j] - px[i] * px[j] / denominator) / forgetting_;
+                    if (!std::isfinite(covariance[i][j])) return error;
+                }
+            }
+
+            // P = D P D with D scaling each over-cap variance back to the cap;
+            // keeps P symmetric and positive definite
+            double scale[N];
+            for (size_t i = 0; i < N; ++i) {
+                scale[i] = covariance[i][i] > max_variance_ ? std::sqrt(max_variance_ / covariance[i][i]) : 1.0;
+            }
+            for (size_t i = 0; i < N; ++i) {
+                theta_[i] = theta[i];
+                for (size_t j = 0; j < N; ++j) {
+                    covariance_[i][j] = covariance[i][j] * scale[i] * scale[j];
+                }
+            }
+            return error;
+        }
+
+        const double* GetCoefficients() const { return theta_; }
+        double GetVariance(size_t i) const { return covariance_[i][i]; }
+    };
+
+    // What the power estimates are computed from
+    struct PowerFeatures {
+        double cpu_utilization;     // 0..1
+        double cpu_clock_ghz;
+        double gpu_utilization;     // 0..1
+        double gpu_clock_ghz;
+        double ram_total_gb;
+        double ram_utilization;     // 0..1
+    };
+
+    // Linear power model per domain, calibrated online against whatever
+    // measurements the host has (RAPL package/DRAM energy meters, NVML).
+    //
+    //     cpu = a + b*util + c*util*GHz          (starts at 25 W + 100 W * util * GHz/3.7)
+    //     gpu = a + b*util + c*util*GHz          (starts at 30 W + 320 W * util)
+    //     ram = a*GB + b*GB*util                 (starts at 3 W per GB)
+    //
+    // Every measured interval refines that domain's coefficients by
+    // recursive least squares; domains without a measurement are estimated
+    // from the current coefficients. The fitted model is saved to a small
+    // text file and loaded at start, so a host without meters can use one
+    // fitted on a host with them. The mean absolute error of predictions
+    // made before each measurement is tracked per domain.
+    //
+    // Installed RAM never changes at runtime, so the RAM domain has only
+    // two independent regressors; a separate intercept next to a*GB would
+    // be collinear with it. Its third coefficient stays unused (zero).
+    class PowerModel {
+    public:
+        enum Domain : size_t {
+            Cpu,
+            Gpu,
+            Ram,
+            DomainCount
+        };
+
+        static constexpr size_t kFeatures = 3;
+        static constexpr double kForgetting = 0.999;    // ~1000 samples of memory
+        static constexpr double kMaxVariance = 1e4;     // Covariance cap (anti-windup)
+
+    private:
+        struct DomainFit {
+            RecursiveLeastSquares<kFeatures> fit;
+            double error_w;         // EWMA of |a-priori residual|
+            uint64_t samples;
+        };
+
+        std::string path_;
+        DomainFit domains_[DomainCount];
+
+        static void Features(Domain domain, const PowerFeatures& features, double (&x)[kFeatures]);
+
+    public:
+        explicit PowerModel(std::string path);
+
+        // An empty path keeps the model in memory only
+        void SetPath(std::string path) { path_ = std::move(path); }
+
+        // Loads coefficients saved by an earlier run; false if there are none.
+        // Save does file I/O, so it runs once at shutdown, never per sample.
+        bool Load();
+        bool Save();
+
+        double Estimate(Domain domain, const PowerFeatures& features) const;
+
+        // Calibrates a domain against a measured value (watts). Called on
+        // the monitoring thread; doesn't allocate or touch the disk.
+        void Fit(Domain domain, const PowerFeatures& features, double measured_w);
+
+        // NaN until the domain has been fitted to a measurement
+        double GetError(Domain domain) const {
+            return domains_[domain].samples > 0 ? domains_[domain].error_w : NAN;
+        }
+        uint64_t GetSamples(Domain domain) const { return domains_[domain].samples; }
+    };
+
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "metrics_types.h"
+#include <string>
+#include <vector>
+#include <mutex>
+
+namespace PCMonitor {
+
+    // Web server self-metrics exported alongside the snapshot
+    struct ServerStats {
+        uint64_t stream_subscribers = 0;            // /api/stream and /api/stream.bin clients
+        uint64_t subscriptions = 0;                 // /api/subscribe clients
+        uint64_t subscription_groups = 0;           // Distinct (fields, interval) combinations
+        uint64_t subscription_frames_encoded = 0;
+        uint64_t subscription_frames_sent = 0;
+
+        // /api/metrics and /api/metrics.bin encode-once caches (SnapshotCache)
+        uint64_t snapshot_encodes = 0;
+        uint64_t snapshot_cache_hits = 0;
+
+        // pc_monitor's own footprint (AgentPolicy::ReadUsage)
+        double agent_cpu_user_seconds = 0.0;
+        double agent_cpu_kernel_seconds = 0.0;
+        uint64_t agent_context_switches = 0;
+        uint64_t agent_working_set_bytes = 0;
+        uint64_t agent_memory_locked = 0;
+
+        // Anomaly detection (--anomaly)
+        uint64_t anomaly_series = 0;
+        uint64_t anomaly_evaluations = 0;
+        double anomaly_evaluation_seconds = 0.0;
+
+        // Correlation matrix (--correlations)
+        uint64_t correlation_series = 0;
+        uint64_t correlation_updates = 0;
+        double correlation_update_seconds = 0.0;
+
+        // Alert rules (--alerts)
+        uint64_t alert_rules = 0;
+        uint64_t alerts_firing = 0;
+        uint64_t alert_evaluations = 0;
+        double alert_evaluation_seconds = 0.0;
+        uint64_t alert_notifications = 0;
+        uint64_t alert_notifications_failed = 0;
+
+        // Event log and /api/events
+        uint64_t events_logged = 0;
+        uint64_t event_subscribers = 0;
+    };
+
+    // Prometheus text exposition (format 0.0.4) for /metrics.
+    //
+    // The document is laid out once as a template: a list of static text
+    // segments, each followed by one numeric slot. Rendering a scrape only
+    // formats the numbers into the caller's buffer. The template is rebuilt
+    // when the shape changes (e.g. a different number of fans).
+    class PrometheusExporter {
+    private:
+        enum class SlotKind : uint8_t {
+            Field,          // index into the flattened field list
+            Fan,            // fan index
+            BucketCount,    // collector * (buckets + 1) + bucket, cumulative
+            HistogramSum,   // collector
+            HistogramCount, // collector
+            Version,
+            Timestamp,
+            ServerStat      // index into the server stats table
+        };
+
+        struct Segment {
+            std::string text;   // Emitted before the value
+            SlotKind kind;
+            size_t index;
+        };
+
+        std::vector<const FieldInfo*> fields_;
+        std::vector<Segment> segments_;
+        std::string tail_;
+        size_t fan_count_;
+        bool built_;
+        std::mutex mutex_;
+
+        void BuildTemplate(size_t fan_count);
+        static void AppendNumber(std::string& out, double value);
+        static void AppendNumber(std::string& out, uint64_t value);
+
+    public:
+        PrometheusExporter();
+
+        void Render(const MetricsSnapshot& snapshot, const CollectorLatencies& latencies,
+                    const ServerStats& stats, std::string& out);
+
+        static const char* ContentType() { return "text/plain; version=0.0.4; charset=utf-8"; }
+    };
+
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace PCMonitor {
+
+    // Fixed-size quantile sketch (DDSketch with a dense, collapsing store).
+    //
+    // Values are counted in logarithmic bins, so any quantile comes back
+    // within kRelativeAccuracy of a value that was actually added. Sketches
+    // merge exactly by adding bin counts, which is what lets WindowStats keep
+    // one per time bucket and combine them at query time.
+    //
+    // The store is kBins contiguous bins (a span of about 28000x between the
+    // smallest and largest value kept apart). When the values span more than
+    // that, the lowest bins are folded together: high quantiles stay exact,
+    // only the lowest ones lose precision. Values below kMinValue, including
+    // zero and negatives, share one bin. No heap memory is used.
+    class QuantileSketch {
+    public:
+        static constexpr size_t kBins = 256;
+        static constexpr double kRelativeAccuracy = 0.02;
+        static constexpr double kMinValue = 1e-3;
+
+    private:
+        uint32_t bins_[kBins];
+        int32_t offset_;            // Bin index of bins_[0]
+        int32_t lowest_;            // Lowest and highest occupied bin index
+        int32_t highest_;
+        uint64_t zero_count_;       // Values below kMinValue
+        uint64_t count_;
+        double sum_;
+        double min_;
+        double max_;
+
+        void AddToBin(int32_t index, uint64_t count);
+        void Shift(int32_t offset);
+
+    public:
+        QuantileSketch();
+
+        void Clear();
+        void Add(double value);
+        void Merge(const QuantileSketch& other);
+
+        // q in [0, 1]; 0 for an empty sketch
+        double Quantile(double q) const;
+
+        uint64_t GetCount() const { return count_; }
+        double GetMin() const { return count_ ? min_ : 0.0; }
+        double GetMax() const { return count_ ? max_ : 0.0; }
+        double GetMean() const { return count_ ? sum_ / static_cast<double>(count_) : 0.0; }
+    };
+
+}
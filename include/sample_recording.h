@@ -0,0 +1,149 @@
+#pragma once
+
+#include <string>
+#include <fstream>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+namespace PCMonitor {
+
+    // Everything the collectors read from the system in one cycle, as read:
+    // NVML readings, PDH counter values, the memory status and the fullest
+    // volume's size. The collectors derive every metric from these, so
+    // feeding recorded inputs back reproduces the whole pipeline. NaN marks
+    // a read that failed; the metric then keeps its previous value.
+    struct CollectorInputs {
+        // GPU (NVML, or stand-in values without it)
+        double gpu_vram_total_mb;
+        double gpu_vram_used_mb;
+        double gpu_core_clock_mhz;
+        double gpu_memory_clock_mhz;
+        double gpu_temperature_c;
+        double gpu_power_draw_w;
+        double gpu_power_measured;          // 1 when power_draw_w came from NVML
+        double gpu_utilization_percent;
+        double gpu_memory_bandwidth_mbps;   // NaN: estimated from the memory clock
+
+        // CPU (PDH, ThrottleDetector summary)
+        double cpu_utilization_percent;
+        double cpu_frequency_mhz;
+        double cpu_effective_clock_mhz;
+        double cpu_performance_limit_percent;
+        double cpu_throttled_cores;
+        double cpu_throttled_seconds;
+        double cpu_frequency_loss_mhz;
+
+        // RAM (GlobalMemoryStatusEx)
+        double memory_total_bytes;
+        double memory_available_bytes;
+        double memory_load_percent;
+
+        // Storage (PDH, GetDiskFreeSpaceEx on the fullest fixed volume)
+        double disk_read_bytes_per_sec;
+        double disk_write_bytes_per_sec;
+        double volume_used_gb;
+        double volume_capacity_gb;
+
+        // Network (PDH, all interfaces)
+        double net_received_bytes_per_sec;
+        double net_sent_bytes_per_sec;
+
+        // RAPL energy meters, watts
+        double package_power_w;
+        double dram_power_w;
+    };
+
+    constexpr size_t kRecordedInputCount = sizeof(CollectorInputs) / sizeof(double);
+    constexpr size_t kRecordedBurstSeries = 5;  // CPU, disk read/write, network receive/send
+
+    static_assert(kRecordedInputCount <= 32, "cycle records keep a 32-bit change mask");
+
+    struct RecordingHeader {
+        uint32_t core_count;
+        uint32_t thread_count;
+        uint32_t interval_ms;
+        uint32_t burst_interval_ms;         // 0 when burst sampling was off
+        int64_t start_unix;                 // Wall clock at offset 0
+    };
+
+    // Sampler input recording (--record): a header, then one record per
+    // collection cycle and per burst sample, appended as they happen. A cycle
+    // stores only the inputs whose bits changed since the previous cycle, so
+    // the constant ones (memory size, clocks, stand-ins) cost nothing.
+    //
+    // Recording file (.pmrec, little-endian):
+    //   char magic[4] = "PMRC"; uint32 format_version = 1;
+    //   uint32 input_count; uint32 burst_series;
+    //   uint32 core_count; uint32 thread_count; uint32 interval_ms;
+    //   uint32 burst_interval_ms; int64 start_unix;
+    //   records: uint8 type; varint delta_us (since the previous record);
+    //     type 1 (cycle): uint32 changed; double value per set bit
+    //     type 2 (burst): uint8 present; double value per set bit
+    // varint is LEB128 (7 bits per byte, low bits first).
+    class RecordingWriter {
+    public:
+        static constexpr uint32_t kFormatVersion = 1;
+
+    private:
+        std::ofstream file_;
+        std::string record_;                // Reused for every record
+        CollectorInputs previous_;
+        bool have_previous_;
+        std::chrono::steady_clock::time_point start_;
+        uint64_t last_offset_us_;
+        uint64_t cycles_;
+        uint64_t bursts_;
+
+        void BeginRecord(uint8_t type, std::chrono::steady_clock::time_point time);
+
+    public:
+        RecordingWriter();
+
+        // Truncates the file and writes the header; offsets count from now
+        bool Open(const std::string& path, const RecordingHeader& header, std::string& error);
+        void Close();
+        bool IsOpen() const { return file_.is_open(); }
+
+        // Cycles are flushed as written, so a killed process keeps them
+        void WriteCycle(std::chrono::steady_clock::time_point time, const CollectorInputs& inputs);
+        void WriteBurst(std::chrono::steady_clock::time_point time, const double (&values)[kRecordedBurstSeries]);
+
+        uint64_t GetCycles() const { return cycles_; }
+        uint64_t GetBursts() const { return bursts_; }
+    };
+
+    class RecordingReader {
+    public:
+        enum class RecordType : uint8_t {
+            Cycle = 1,
+            Burst = 2
+        };
+
+        struct Record {
+            RecordType type;
+            uint64_t offset_us;                     // Since the start of the recording
+            CollectorInputs inputs;                 // Cycle: all inputs, changed or not
+            double burst[kRecordedBurstSeries];     // Burst: NaN where a series wasn't sampled
+        };
+
+    private:
+        std::ifstream file_;
+        RecordingHeader header_;
+        CollectorInputs current_;
+        uint64_t offset_us_;
+
+        bool ReadVarint(uint64_t& value);
+
+    public:
+        RecordingReader();
+
+        bool Open(const std::string& path, std::string& error);
+        const RecordingHeader& GetHeader() const { return header_; }
+
+        // Next record in file order; false at the end (a record cut short by
+        // a killed recorder ends the file too)
+        bool Next(Record& record);
+    };
+
+}
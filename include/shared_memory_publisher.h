@@ -0,0 +1,35 @@
+#pragma once
+
+#include "metrics_types.h"
+#include <cstdint>
+
+struct pcmon_shm_region;
+
+namespace PCMonitor {
+
+    class PerformanceMonitor;
+
+    // Writes every published snapshot into the named mapping described by
+    // pcmonitor_shm.h, for local readers that want metrics without HTTP.
+    // Only the monitoring thread writes, so the seqlock needs no writer lock.
+    class SharedMemoryPublisher {
+    private:
+        void* mapping_;                 // HANDLE
+        pcmon_shm_region* region_;
+
+        void Publish(const MetricsSnapshot& snapshot);
+
+    public:
+        SharedMemoryPublisher();
+        ~SharedMemoryPublisher();
+
+        // Creates the mapping and starts publishing from the monitor's
+        // snapshot listener. Must be called before the monitor starts and the
+        // publisher must outlive the monitor's running period.
+        bool Open(PerformanceMonitor& monitor);
+        void Close();
+
+        bool IsOpen() const { return region_ != nullptr; }
+    };
+
+}
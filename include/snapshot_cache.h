@@ -0,0 +1,62 @@
+#pragma once
+
+#include "metrics_types.h"
+#include <string>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+
+namespace PCMonitor {
+
+    class PerformanceMonitor;
+
+    // One serialized snapshot, shared read-only by every request that asks for
+    // the same version. Both full responses are prebuilt so serving is a send.
+    struct EncodedSnapshot {
+        uint64_t version;
+        std::string etag;           // Quoted entity tag, unique per process run
+        std::string body;
+        std::string response;       // 200 OK: headers + body
+        std::string not_modified;   // 304 Not Modified: headers only
+    };
+
+    // Encode-once cache keyed by snapshot version
+    class SnapshotCache {
+    public:
+        using Encoder = std::function<std::string(const MetricsSnapshot&)>;
+
+    private:
+        const PerformanceMonitor& monitor_;
+        Encoder encoder_;
+        std::string content_type_;
+        std::string etag_prefix_;
+
+        std::mutex mutex_;
+        std::shared_ptr<const EncodedSnapshot> current_;
+
+        std::atomic<uint64_t> encode_count_;
+        std::atomic<uint64_t> hit_count_;
+
+        std::shared_ptr<const EncodedSnapshot> Encode(const MetricsSnapshot& snapshot) const;
+
+    public:
+        SnapshotCache(const PerformanceMonitor& monitor, Encoder encoder, std::string content_type);
+
+        // Returns the encoding of the latest published snapshot, building it
+        // at most once per version no matter how many threads ask.
+        std::shared_ptr<const EncodedSnapshot> Get();
+
+        // Entity tag for a snapshot version, for responses derived from it
+        std::string MakeETag(uint64_t version) const;
+
+        // Builds an entry with both responses prebuilt around an encoded body
+        static std::shared_ptr<const EncodedSnapshot> MakeEntry(uint64_t version, std::string etag,
+                                                                std::string body, const std::string& content_type);
+
+        uint64_t GetEncodeCount() const { return encode_count_; }
+        uint64_t GetHitCount() const { return hit_count_; }
+    };
+
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "metrics_types.h"
+#include "snapshot_cache.h"
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace PCMonitor {
+
+    class PerformanceMonitor;
+
+    // Incremental snapshots for /api/metrics?since=<version> and the delta
+    // mode of /api/stream.
+    //
+    // The last few published snapshots are retained; a delta lists only the
+    // fields whose values differ between the requested base version and the
+    // latest one, along with "since" so clients can tell it from a full
+    // document. A base that has aged out of the window (or was never
+    // published) gets the full snapshot instead. Deltas are encoded at most
+    // once per (base, latest) pair.
+    class SnapshotDeltas {
+    public:
+        static constexpr size_t kRetainedSnapshots = 16;
+
+    private:
+        SnapshotCache& full_cache_;
+
+        std::mutex mutex_;
+        std::vector<MetricsSnapshot> retained_;     // Ring, oldest overwritten first
+        size_t next_slot_;
+        size_t retained_count_;
+
+        // Deltas to the newest retained snapshot, keyed by base version
+        uint64_t encoded_version_;
+        std::unordered_map<uint64_t, std::shared_ptr<const EncodedSnapshot>> encoded_;
+
+        void Retain(const MetricsSnapshot& snapshot);
+        std::string EncodeDelta(const MetricsSnapshot& base, const MetricsSnapshot& latest) const;
+
+    public:
+        // Full documents (and entity tags) come from the JSON cache
+        SnapshotDeltas(PerformanceMonitor& monitor, SnapshotCache& full_cache);
+
+        // Changes from the given version to the latest snapshot, or the full
+        // latest snapshot if that version is no longer retained
+        std::shared_ptr<const EncodedSnapshot> Get(uint64_t since);
+    };
+
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "metrics_types.h"
+#include "frame_sink.h"
+#include <string>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+
+namespace PCMonitor {
+
+    class PerformanceMonitor;
+    class ProjectionPlan;
+
+    // Per-client subscriptions for /api/subscribe: each client picks its own
+    // field selection and interval, delivered as Server-Sent Events.
+    //
+    // Subscribers with the same selection layout and interval form a group.
+    // A group is encoded once per tick and the frame buffer shared by all of
+    // its members, so the cost follows the number of distinct (fields, rate)
+    // combinations rather than the number of clients. A group ticks when its
+    // interval has elapsed and a newer snapshot exists; intervals shorter
+    // than the collection interval get every snapshot as it is published.
+    class SubscriptionManager {
+    public:
+        using SocketHandle = FrameSink::SocketHandle;
+
+        static constexpr uint32_t kMinIntervalMs = 50;
+        static constexpr uint32_t kMaxIntervalMs = 60 * 60 * 1000;
+
+    private:
+        struct Group {
+            std::shared_ptr<const ProjectionPlan> plan;
+            std::chrono::milliseconds interval;
+            std::chrono::steady_clock::time_point next_due;
+            uint64_t sent_version;                          // Snapshot in last_frame
+            std::shared_ptr<const std::string> last_frame;  // Also greets new members
+            std::vector<FrameSink> members;
+        };
+
+        struct PendingSubscriber {
+            SocketHandle socket;
+            std::shared_ptr<const ProjectionPlan> plan;
+            uint32_t interval_ms;
+        };
+
+        const PerformanceMonitor& monitor_;
+        std::atomic<bool> running_;
+        std::unique_ptr<std::thread> fanout_thread_;
+
+        // Shared with the monitoring and web server threads
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        uint64_t published_version_;
+        std::vector<PendingSubscriber> new_subscribers_;
+
+        // Owned by the fan-out thread, keyed by interval and plan signature
+        std::unordered_map<std::string, Group> groups_;
+
+        std::atomic<size_t> subscriber_count_;
+        std::atomic<size_t> group_count_;
+        std::atomic<uint64_t> frames_encoded_;
+        std::atomic<uint64_t> frames_sent_;
+
+        void FanOutLoop();
+        void AddToGroup(const PendingSubscriber& pending, std::chrono::steady_clock::time_point now);
+        std::shared_ptr<const std::string> EncodeFrame(const ProjectionPlan& plan, const MetricsSnapshot& snapshot) const;
+
+    public:
+        // Registers a snapshot listener, so the manager must outlive the
+        // monitor's running period.
+        explicit SubscriptionManager(PerformanceMonitor& monitor);
+        ~SubscriptionManager();
+
+        bool Start();
+        void Stop();
+
+        // Takes ownership of a connected socket whose SSE response headers
+        // have already been sent. The interval is clamped to the limits above.
+        void Subscribe(SocketHandle socket, std::shared_ptr<const ProjectionPlan> plan, uint32_t interval_ms);
+
+        size_t GetSubscriberCount() const { return subscriber_count_; }
+        size_t GetGroupCount() const { return group_count_; }
+
+        // Frames sent beyond frames encoded is the work saved by grouping
+        uint64_t GetFramesEncoded() const { return frames_encoded_; }
+        uint64_t GetFramesSent() const { return frames_sent_; }
+    };
+
+}
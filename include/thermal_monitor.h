@@ -21,7 +21,7 @@ namespace PCMonitor {
 
         bool InitializeWMI();
         bool EnumerateSensors();
-        std::vector<uint32_t> ReadFanSpeeds();
+        FanSpeeds ReadFanSpeeds();
 
     public:
         ThermalMonitor();
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <windows.h>
+#include <pdh.h>
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <functional>
+#include <cstdint>
+
+#pragma comment(lib, "pdh.lib")
+
+namespace PCMonitor {
+
+    // A core entering or leaving a throttling episode
+    struct ThrottleEvent {
+        int64_t timestamp;          // Unix seconds
+        uint32_t core;              // ThrottleDetector::GetCoreName()
+        bool throttled;             // false: episode over
+        double limit_percent;       // Lowest cap seen so far in the episode
+        double loss_mhz;            // Mean frequency lost to the cap
+        double seconds;             // Episode length (0 when it starts)
+    };
+
+    // Per-core thermal / power throttling from the processor performance
+    // counters.
+    //
+    // "% Performance Limit" is the share of the core's maximum frequency the
+    // firmware currently allows; anything below kThrottledBelowPercent is
+    // counted as throttled. "% Processor Performance" scaled by the rated
+    // maximum (CallNtPowerInformation) gives the effective clock, which unlike
+    // "Processor Frequency" follows turbo and throttling.
+    class ThrottleDetector {
+    public:
+        static constexpr double kThrottledBelowPercent = 99.5;
+
+        // Per-interval summary for CPUMetrics
+        struct Summary {
+            uint32_t effective_clock_mhz;       // Mean over cores
+            double performance_limit_percent;   // Lowest core
+            uint32_t throttled_cores;
+            double throttled_seconds;           // Since start, with any core throttled
+            uint32_t frequency_loss_mhz;        // Mean over cores
+        };
+
+    private:
+        struct Core {
+            PDH_HCOUNTER limit;
+            PDH_HCOUNTER performance;
+            double max_mhz;
+            bool throttled;
+            std::chrono::steady_clock::time_point since;
+            double lowest_limit;
+            double loss_total;
+            uint32_t loss_samples;
+        };
+
+        PDH_HQUERY query_;
+        std::vector<Core> cores_;
+        std::vector<std::string> names_;    // PDH instance, "<group>,<core>"
+
+        std::chrono::steady_clock::time_point last_sample_;
+        double throttled_seconds_;
+        std::function<void(const ThrottleEvent&)> event_listener_;
+
+    public:
+        ThrottleDetector();
+        ~ThrottleDetector();
+
+        ThrottleDetector(const ThrottleDetector&) = delete;
+        ThrottleDetector& operator=(const ThrottleDetector&) = delete;
+
+        // False when the counters aren't there (older Windows, some VMs)
+        bool Initialize();
+
+        // Called on the monitoring thread once per interval; without counters
+        // it reports fallback_mhz and no throttling
+        Summary Sample(uint32_t fallback_mhz);
+
+        // Called on the monitoring thread when an episode starts or ends
+        void SetEventListener(std::function<void(const ThrottleEvent&)> listener);
+
+        size_t GetCoreCount() const { return cores_.size(); }
+        const std::string& GetCoreName(uint32_t core) const { return names_[core]; }
+
+        // "timestamp":..,"core":..,"state":..,"limit_percent":..,"loss_mhz":..,"seconds":..
+        // (the members only, for EventStream::Publish)
+        void AppendEventJson(const ThrottleEvent& event, std::string& out) const;
+    };
+
+}
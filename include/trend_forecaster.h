@@ -0,0 +1,114 @@
+#pragma once
+
+#include "metrics_types.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <mutex>
+#include <chrono>
+#include <functional>
+#include <cstdint>
+
+namespace PCMonitor {
+
+    // A series becoming (or no longer) predicted to reach its limit within
+    // the horizon
+    struct ForecastEvent {
+        int64_t timestamp;      // Snapshot time (Unix seconds)
+        uint32_t series;        // TrendForecaster::GetSeriesName()
+        bool predicted;         // false: no longer expected within the horizon
+        double value;
+        double limit;
+        double seconds;         // Predicted time to the limit (predicted only)
+    };
+
+    // Time-to-limit forecasts for series that run out: memory, VRAM, the
+    // fullest volume and temperatures.
+    //
+    // Each series is fitted two ways on every snapshot, both O(1) per sample:
+    // a least-squares line over the last `window_seconds` (running sums over
+    // a ring, shifted as the oldest sample leaves) and Holt's double
+    // exponential smoothing (level plus trend). A series is predicted to
+    // reach its limit when both fits cross it within `horizon_seconds`,
+    // taking the later of the two crossings; it clears once that is more
+    // than half again the horizon away, or the fits no longer rise.
+    //
+    // Limits come from a paired field (ram.total_mb for ram.used_mb) or a
+    // fixed value; SetLimit() overrides either or adds a series.
+    class TrendForecaster {
+    public:
+        struct Settings {
+            uint32_t window_seconds = 600;
+            uint32_t horizon_seconds = 3600;
+            double holt_alpha = 0.1;        // Level weight of the newest sample
+            double holt_beta = 0.02;        // Trend weight of the newest change
+        };
+
+    private:
+        struct Series {
+            const FieldInfo* field;
+            const FieldInfo* limit_field;   // Null: fixed limit
+            double fixed_limit;
+
+            // Regression over x = 0 (oldest) .. count - 1 (newest)
+            uint32_t buffer;                // First slot in samples_
+            uint32_t head;                  // Oldest sample once full
+            uint32_t count;
+            double sum_y;
+            double sum_xy;
+
+            double level;
+            double trend;                   // Per sample
+            uint64_t samples;
+
+            // Latest results, for /api/forecasts
+            double value;
+            double limit;
+            double linear_slope;            // Per second
+            double linear_seconds;          // Infinity: not approaching
+            double holt_slope;
+            double holt_seconds;
+            bool predicted;
+        };
+
+        Settings settings_;
+        double interval_seconds_;
+        uint32_t window_;                   // Samples
+        uint32_t warmup_;                   // Samples before any verdict
+        std::vector<std::string> names_;
+        std::vector<Series> series_;
+        std::vector<double> samples_;       // series x window rings
+
+        mutable std::mutex mutex_;
+        int64_t latest_timestamp_;
+        std::function<void(const ForecastEvent&)> event_listener_;
+
+        void Update(Series& series, double value);
+
+    public:
+        // Windows are counted in snapshots of this interval
+        TrendForecaster(Settings settings, std::chrono::milliseconds interval);
+
+        // "series=limit", limit a number or a field ("gpu.vram_used_mb=gpu.vram_total_mb").
+        // Not safe once Add has started being called.
+        bool SetLimit(std::string_view spec, std::string& error);
+
+        // Called on the monitoring thread for every snapshot
+        void Add(const MetricsSnapshot& snapshot);
+
+        // Called on the monitoring thread for each state change
+        void SetEventListener(std::function<void(const ForecastEvent&)> listener);
+
+        size_t GetSeriesCount() const { return series_.size(); }
+        const std::string& GetSeriesName(uint32_t series) const { return names_[series]; }
+        const Settings& GetSettings() const { return settings_; }
+
+        // "timestamp":..,"series":..,"state":..,"value":..,"limit":..,"seconds":..
+        // (the members only, for EventStream::Publish)
+        void AppendEventJson(const ForecastEvent& event, std::string& out) const;
+
+        // {"timestamp":..,"series":[{"series":..,"linear":{..},"holt":{..},..},...]} for /api/forecasts
+        std::string GetStatusJson() const;
+    };
+
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "metrics_types.h"
+#include "quantile_sketch.h"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <mutex>
+#include <cstdint>
+
+namespace PCMonitor {
+
+    class PerformanceMonitor;
+
+    // Percentiles of every scalar metric over sliding windows, for
+    // /api/stats.
+    //
+    // Each window is a ring of time buckets holding one QuantileSketch per
+    // series; a query merges the buckets still inside the window. Windows
+    // therefore slide a bucket at a time: "1h" covers the current five
+    // minutes plus the eleven before them.
+    //
+    // Memory is fixed at construction: kBucketsPerSeries sketches of about
+    // 1 KB per series (roughly 45 KB per series, 2.7 MB for the full snapshot)
+    // whatever the sampling rate or uptime. GetMemoryBytes() reports it.
+    class WindowStats {
+    public:
+        struct Window {
+            const char* name;
+            uint32_t bucket_seconds;
+            uint32_t buckets;
+        };
+
+        static constexpr Window kWindows[] = {
+            { "1m", 10, 6 },
+            { "1h", 300, 12 },
+            { "24h", 3600, 24 },
+        };
+        static constexpr size_t kWindowCount = sizeof(kWindows) / sizeof(kWindows[0]);
+        static constexpr size_t kBucketsPerSeries = [] {
+            size_t buckets = 0;
+            for (const Window& window : kWindows) buckets += window.buckets;
+            return buckets;
+        }();
+        static constexpr size_t kMaxQuantiles = 16;
+
+    private:
+        struct Bucket {
+            int64_t epoch;          // Timestamp / bucket_seconds it was filled for
+            QuantileSketch sketch;
+        };
+
+        std::vector<const FieldInfo*> fields_;
+        std::vector<std::string> names_;    // "group.field"
+
+        mutable std::mutex mutex_;
+        std::vector<Bucket> buckets_;       // series x kBucketsPerSeries, windows in table order
+        int64_t latest_timestamp_;
+
+        void Add(const MetricsSnapshot& snapshot);
+
+    public:
+        explicit WindowStats(PerformanceMonitor& monitor);
+
+        // Appends the /api/stats document. Each filter is a comma-separated
+        // list, empty for the defaults: window names, series ("group.field"
+        // or a whole "group") and quantiles in [0, 1]. Returns false and
+        // describes the problem in error for an unknown name or bad number.
+        bool AppendJson(std::string_view windows, std::string_view series, std::string_view quantiles,
+                        std::string& out, std::string& error) const;
+
+        size_t GetSeriesCount() const { return names_.size(); }
+        size_t GetMemoryBytes() const { return buckets_.size() * sizeof(Bucket); }
+    };
+
+}
@@ -11,4 +11,14 @@
     }
     return originalFetch.call(this, input, init);
   };
+
+  // Same for EventSource so the /api/stream push channel reaches the backend
+  const OriginalEventSource = window.EventSource;
+  if (OriginalEventSource) {
+    window.EventSource = class extends OriginalEventSource {
+      constructor(url, config) {
+        super(typeof url === 'string' && url.startsWith('/api/') ? API_BASE + url : url, config);
+      }
+    };
+  }
 })();
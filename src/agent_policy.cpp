@@ -0,0 +1,186 @@
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+
+#include <windows.h>
+#include <psapi.h>
+#include <winternl.h>
+
+#include "agent_policy.h"
+#include <atomic>
+#include <charconv>
+#include <mutex>
+#include <vector>
+
+#pragma comment(lib, "ntdll.lib")
+#pragma comment(lib, "psapi.lib")
+
+namespace PCMonitor {
+
+    namespace {
+
+        AgentSettings g_settings;
+        std::atomic<bool> g_memory_locked(false);
+
+        // Thread entries follow each process entry in a SystemProcessInformation
+        // snapshot; winternl.h leaves the context switch count unnamed
+        struct ThreadEntry {
+            LARGE_INTEGER kernel_time;
+            LARGE_INTEGER user_time;
+            LARGE_INTEGER create_time;
+            ULONG wait_time;
+            PVOID start_address;
+            CLIENT_ID client_id;
+            LONG priority;
+            LONG base_priority;
+            ULONG context_switches;
+            ULONG thread_state;
+            ULONG wait_reason;
+        };
+
+        double FileTimeSeconds(const FILETIME& time) {
+            ULARGE_INTEGER ticks;
+            ticks.LowPart = time.dwLowDateTime;
+            ticks.HighPart = time.dwHighDateTime;
+            return static_cast<double>(ticks.QuadPart) / 1e7;   // 100 ns units
+        }
+
+        uint64_t CountContextSwitches() {
+            // Reused between reads; only self-monitoring calls this
+            static std::mutex mutex;
+            static std::vector<uint8_t> buffer(256 * 1024);
+            std::lock_guard<std::mutex> lock(mutex);
+
+            ULONG needed = 0;
+            NTSTATUS status;
+            while ((status = NtQuerySystemInformation(SystemProcessInformation, buffer.data(),
+                                                      static_cast<ULONG>(buffer.size()), &needed)) < 0) {
+                if (needed <= buffer.size()) return 0;
+                buffer.resize(needed + 64 * 1024);  // Processes come and go between calls
+            }
+
+            HANDLE self = reinterpret_cast<HANDLE>(static_cast<ULONG_PTR>(GetCurrentProcessId()));
+            const uint8_t* entry = buffer.data();
+            for (;;) {
+                auto process = reinterpret_cast<const SYSTEM_PROCESS_INFORMATION*>(entry);
+                if (process->UniqueProcessId == self) {
+                    auto threads = reinterpret_cast<const ThreadEntry*>(process + 1);
+                    uint64_t switches = 0;
+                    for (ULONG i = 0; i < process->NumberOfThreads; ++i) {
+                        switches += threads[i].context_switches;
+                    }
+                    return switches;
+                }
+                if (process->NextEntryOffset == 0) return 0;
+                entry += process->NextEntryOffset;
+            }
+        }
+
+    }
+
+    void AgentPolicy::Configure(const AgentSettings& settings) {
+        g_settings = settings;
+    }
+
+    const AgentSettings& AgentPolicy::GetSettings() {
+        return g_settings;
+    }
+
+    void AgentPolicy::ApplyToCurrentThread(ThreadRole role) {
+        HANDLE thread = GetCurrentThread();
+
+        uint64_t cpus = role == ThreadRole::Sampler ? g_settings.sampler_cpus : g_settings.worker_cpus;
+        if (cpus != 0) {
+            SetThreadAffinityMask(thread, static_cast<DWORD_PTR>(cpus));
+        }
+
+        if (role == ThreadRole::Sampler) {
+            if (g_settings.realtime_sampler) {
+                SetThreadPriority(thread, THREAD_PRIORITY_TIME_CRITICAL);
+            }
+            return;
+        }
+
+        switch (g_settings.worker_priority) {
+            case WorkerPriority::Normal:
+                break;
+            case WorkerPriority::Low:
+                SetThreadPriority(thread, THREAD_PRIORITY_BELOW_NORMAL);
+                break;
+            case WorkerPriority::Idle:
+                SetThreadPriority(thread, THREAD_PRIORITY_IDLE);
+                break;
+        }
+    }
+
+    bool AgentPolicy::LockWorkingSet() {
+        PROCESS_MEMORY_COUNTERS counters = {};
+        if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+            return false;
+        }
+
+        // Some headroom over what warm-up touched; the maximum stays soft
+        SIZE_T minimum = counters.WorkingSetSize + counters.WorkingSetSize / 4;
+        SIZE_T maximum = minimum * 2;
+        bool locked = SetProcessWorkingSetSizeEx(GetCurrentProcess(), minimum, maximum,
+                                                 QUOTA_LIMITS_HARDWS_MIN_ENABLE | QUOTA_LIMITS_HARDWS_MAX_DISABLE) != 0;
+        g_memory_locked = locked;
+        return locked;
+    }
+
+    AgentUsage AgentPolicy::ReadUsage() {
+        AgentUsage usage;
+
+        FILETIME created, exited, kernel, user;
+        if (GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user)) {
+            usage.user_seconds = FileTimeSeconds(user);
+            usage.kernel_seconds = FileTimeSeconds(kernel);
+        }
+
+        PROCESS_MEMORY_COUNTERS counters = {};
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+            usage.working_set_bytes = counters.WorkingSetSize;
+        }
+
+        usage.context_switches = CountContextSwitches();
+        usage.memory_locked = g_memory_locked;
+        return usage;
+    }
+
+    bool AgentPolicy::ParseCpuList(std::string_view text, uint64_t& mask) {
+        mask = 0;
+        if (text.empty()) return false;
+
+        if (text.size() > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+            auto result = std::from_chars(text.data() + 2, text.data() + text.size(), mask, 16);
+            return result.ec == std::errc() && result.ptr == text.data() + text.size() && mask != 0;
+        }
+
+        while (!text.empty()) {
+            size_t comma = text.find(',');
+            std::string_view item = text.substr(0, comma);
+            text.remove_prefix(comma == std::string_view::npos ? text.size() : comma + 1);
+
+            size_t dash = item.find('-');
+            std::string_view first_text = item.substr(0, dash);
+            std::string_view last_text = dash == std::string_view::npos ? first_text : item.substr(dash + 1);
+
+            unsigned first = 0;
+            unsigned last = 0;
+            auto first_result = std::from_chars(first_text.data(), first_text.data() + first_text.size(), first);
+            auto last_result = std::from_chars(last_text.data(), last_text.data() + last_text.size(), last);
+            if (first_text.empty() || last_text.empty() ||
+                first_result.ec != std::errc() || first_result.ptr != first_text.data() + first_text.size() ||
+                last_result.ec != std::errc() || last_result.ptr != last_text.data() + last_text.size() ||
+                first > last || last >= 64) {
+                return false;
+            }
+
+            for (unsigned cpu = first; cpu <= last; ++cpu) {
+                mask |= uint64_t(1) << cpu;
+            }
+        }
+        return mask != 0;
+    }
+
+}
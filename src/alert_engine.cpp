@@ -0,0 +1,355 @@
+#include "alert_engine.h"
+#include "metrics_projection.h"
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+namespace PCMonitor {
+
+    namespace {
+
+        std::string_view Trim(std::string_view text) {
+            while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) text.remove_prefix(1);
+            while (!text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '\r')) text.remove_suffix(1);
+            return text;
+        }
+
+        // Removes and returns the next run of characters up to a space or one of stops
+        std::string_view NextToken(std::string_view& text, std::string_view stops = "") {
+            text = Trim(text);
+            size_t end = 0;
+            while (end < text.size() && text[end] != ' ' && text[end] != '\t' &&
+                   stops.find(text[end]) == std::string_view::npos) {
+                end++;
+            }
+            std::string_view token = text.substr(0, end);
+            text.remove_prefix(end);
+            return token;
+        }
+
+        bool ParseNumber(std::string_view text, double& value) {
+            auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+            return result.ec == std::errc() && result.ptr == text.data() + text.size();
+        }
+
+        // "500ms", "30s", "5m", "1h" or a bare number of seconds
+        bool ParseDuration(std::string_view text, std::chrono::milliseconds& duration) {
+            double scale = 1000.0;
+            if (text.size() > 2 && text.substr(text.size() - 2) == "ms") {
+                scale = 1.0;
+                text.remove_suffix(2);
+            } else if (!text.empty() && (text.back() == 's' || text.back() == 'm' || text.back() == 'h')) {
+                scale = text.back() == 's' ? 1000.0 : text.back() == 'm' ? 60000.0 : 3600000.0;
+                text.remove_suffix(1);
+            }
+
+            double amount = 0.0;
+            if (!ParseNumber(text, amount) || amount < 0.0) return false;
+            duration = std::chrono::milliseconds(static_cast<int64_t>(amount * scale));
+            return true;
+        }
+
+        bool Holds(AlertEngine::Compare compare, double value, double limit) {
+            switch (compare) {
+                case AlertEngine::Compare::Greater: return value > limit;
+                case AlertEngine::Compare::GreaterEqual: return value >= limit;
+                case AlertEngine::Compare::Less: return value < limit;
+                case AlertEngine::Compare::LessEqual: return value <= limit;
+            }
+            return false;
+        }
+
+        void AppendEscaped(std::string& out, const std::string& text) {
+            for (char c : text) {
+                if (c == '\\' || c == '"') out += '\\';
+                out += c;
+            }
+        }
+
+    }
+
+    AlertEngine::AlertEngine(std::chrono::milliseconds interval)
+        : interval_(interval.count() > 0 ? interval : std::chrono::milliseconds(1000))
+        , tick_(0)
+        , evaluations_(0)
+        , last_evaluation_ns_(0)
+        , firing_count_(0)
+    {
+    }
+
+    uint32_t AlertEngine::AddSignal(const FieldInfo* field, Aggregate aggregate, uint32_t window) {
+        for (size_t i = 0; i < signals_.size(); ++i) {
+            const Signal& existing = signals_[i];
+            if (existing.field == field && existing.aggregate == aggregate && existing.window == window) {
+                return static_cast<uint32_t>(i);
+            }
+        }
+
+        Signal signal{ field, aggregate, window, static_cast<uint32_t>(values_.size()), 0, 0, 0.0, 0.0 };
+        if (aggregate != Aggregate::Last) {
+            values_.resize(values_.size() + window, 0.0);
+            sequence_.resize(values_.size(), 0);
+        }
+        signals_.push_back(signal);
+        return static_cast<uint32_t>(signals_.size() - 1);
+    }
+
+    bool AlertEngine::AddRule(std::string_view text, std::string& error) {
+        std::string_view rest = Trim(text);
+        std::string_view name = rest;
+
+        size_t colon = rest.find(':');
+        if (colon != std::string_view::npos) {
+            name = Trim(rest.substr(0, colon));
+            rest.remove_prefix(colon + 1);
+            if (name.empty()) {
+                error = "empty rule name";
+                return false;
+            }
+        }
+
+        // Operand: a field, or aggregate(field, window)
+        Aggregate aggregate = Aggregate::Last;
+        uint32_t window = 1;
+        std::string_view operand = NextToken(rest, "(<>=");
+        if (!rest.empty() && rest.front() == '(') {
+            if (operand == "avg") aggregate = Aggregate::Avg;
+            else if (operand == "min") aggregate = Aggregate::Min;
+            else if (operand == "max") aggregate = Aggregate::Max;
+            else {
+                error = "unknown function '" + std::string(operand) + "' (avg, min or max)";
+                return false;
+            }
+
+            size_t close = rest.find(')');
+            size_t comma = rest.find(',');
+            if (close == std::string_view::npos || comma == std::string_view::npos || comma > close) {
+                error = "expected " + std::string(operand) + "(field, duration)";
+                return false;
+            }
+
+            std::chrono::milliseconds duration;
+            std::string_view duration_text = Trim(rest.substr(comma + 1, close - comma - 1));
+            if (!ParseDuration(duration_text, duration) || duration < interval_) {
+                error = "window '" + std::string(duration_text) + "' must be a duration of at least one sample";
+                return false;
+            }
+            window = static_cast<uint32_t>((duration.count() + interval_.count() - 1) / interval_.count());
+            operand = Trim(rest.substr(1, comma - 1));
+            rest.remove_prefix(close + 1);
+        }
+
+        const FieldInfo* field = FindScalarField(operand);
+        if (!field) {
+            error = "unknown field '" + std::string(operand) + "' (expected group.field, e.g. cpu.temperature_c)";
+            return false;
+        }
+
+        Rule rule{ 0, Compare::Greater, 0.0, 0.0, 0, 0, false };
+
+        rest = Trim(rest);
+        if (rest.substr(0, 2) == ">=") rule.compare = Compare::GreaterEqual;
+        else if (rest.substr(0, 2) == "<=") rule.compare = Compare::LessEqual;
+        else if (rest.substr(0, 1) == ">") rule.compare = Compare::Greater;
+        else if (rest.substr(0, 1) == "<") rule.compare = Compare::Less;
+        else {
+            error = "expected >, >=, < or <= after " + std::string(operand);
+            return false;
+        }
+        rest.remove_prefix(rule.compare == Compare::Greater || rule.compare == Compare::Less ? 1 : 2);
+
+        std::string_view threshold = NextToken(rest);
+        if (!ParseNumber(threshold, rule.threshold)) {
+            error = "invalid threshold '" + std::string(threshold) + "'";
+            return false;
+        }
+        rule.clear = rule.threshold;
+
+        // Optional clauses, in any order
+        for (std::string_view keyword = NextToken(rest); !keyword.empty(); keyword = NextToken(rest)) {
+            std::string_view argument = NextToken(rest);
+            if (keyword == "for") {
+                std::chrono::milliseconds duration;
+                if (!ParseDuration(argument, duration)) {
+                    error = "invalid duration '" + std::string(argument) + "'";
+                    return false;
+                }
+                rule.for_ticks = static_cast<uint32_t>((duration.count() + interval_.count() - 1) / interval_.count());
+            } else if (keyword == "clear") {
+                if (!ParseNumber(argument, rule.clear)) {
+                    error = "invalid clear value '" + std::string(argument) + "'";
+                    return false;
+                }
+            } else {
+                error = "unexpected '" + std::string(keyword) + "' (expected 'for' or 'clear')";
+                return false;
+            }
+        }
+
+        // The clear level has to lie on the resolved side of the threshold
+        bool above = rule.compare == Compare::Greater || rule.compare == Compare::GreaterEqual;
+        if (above ? rule.clear > rule.threshold : rule.clear < rule.threshold) {
+            error = "clear value must be on the other side of the threshold";
+            return false;
+        }
+
+        rule.signal = AddSignal(field, aggregate, window);
+        rules_.push_back(rule);
+        names_.emplace_back(name);
+        texts_.emplace_back(Trim(text));
+        return true;
+    }
+
+    bool AlertEngine::LoadFile(const std::string& path, std::string& error) {
+        std::ifstream file(path);
+        if (!file.is_open()) {
+            error = "cannot open " + path;
+            return false;
+        }
+
+        std::string line;
+        for (int number = 1; std::getline(file, line); ++number) {
+            std::string_view rule = Trim(line);
+            if (rule.empty() || rule.front() == '#') continue;
+
+            if (!AddRule(rule, error)) {
+                error = path + ":" + std::to_string(number) + ": " + error;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void AlertEngine::SetEventListener(std::function<void(const AlertEvent&)> listener) {
+        event_listener_ = std::move(listener);
+    }
+
+    void AlertEngine::UpdateSignal(Signal& signal, double sample) {
+        double* values = values_.data() + signal.buffer;
+        uint64_t* sequence = sequence_.data() + signal.buffer;
+        const uint32_t window = signal.window;
+
+        switch (signal.aggregate) {
+            case Aggregate::Last:
+                signal.value = sample;
+                return;
+
+            case Aggregate::Avg:
+                if (signal.size == window) {
+                    signal.sum -= values[signal.head];
+                } else {
+                    signal.size++;
+                }
+                values[signal.head] = sample;
+                signal.sum += sample;
+                signal.head = (signal.head + 1) % window;
+
+                // Re-add once per lap so rounding in the running sum can't build up
+                if (signal.head == 0) {
+                    signal.sum = 0.0;
+                    for (uint32_t i = 0; i < signal.size; ++i) signal.sum += values[i];
+                }
+                signal.value = signal.sum / signal.size;
+                return;
+
+            case Aggregate::Min:
+            case Aggregate::Max: {
+                // Monotonic deque in a ring: the front is the extreme of the window
+                bool max = signal.aggregate == Aggregate::Max;
+                while (signal.size > 0 && sequence[signal.head] + window <= tick_) {
+                    signal.head = (signal.head + 1) % window;
+                    signal.size--;
+                }
+                while (signal.size > 0) {
+                    double back = values[(signal.head + signal.size - 1) % window];
+                    if (max ? back > sample : back < sample) break;
+                    signal.size--;
+                }
+
+                uint32_t slot = (signal.head + signal.size) % window;
+                values[slot] = sample;
+                sequence[slot] = tick_;
+                signal.size++;
+                signal.value = values[signal.head];
+                return;
+            }
+        }
+    }
+
+    void AlertEngine::Evaluate(const MetricsSnapshot& snapshot) {
+        auto start = std::chrono::steady_clock::now();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        tick_++;
+
+        // A field with no value (NaN) leaves its signals where they were
+        for (Signal& signal : signals_) {
+            double sample = ReadScalarField(snapshot.metrics, *signal.field);
+            if (!std::isnan(sample)) UpdateSignal(signal, sample);
+        }
+
+        size_t firing = 0;
+        for (size_t i = 0; i < rules_.size(); ++i) {
+            Rule& rule = rules_[i];
+            double value = signals_[rule.signal].value;
+
+            bool changed = false;
+            if (!rule.firing) {
+                rule.pending_ticks = Holds(rule.compare, value, rule.threshold) ? rule.pending_ticks + 1 : 0;
+                changed = rule.pending_ticks > rule.for_ticks;
+            } else {
+                changed = !Holds(rule.compare, value, rule.clear);
+                if (changed) rule.pending_ticks = 0;
+            }
+
+            if (changed) {
+                rule.firing = !rule.firing;
+                if (event_listener_) {
+                    event_listener_(AlertEvent{ snapshot.timestamp, static_cast<uint32_t>(i), rule.firing,
+                                                value, rule.firing ? rule.threshold : rule.clear });
+                }
+            }
+            if (rule.firing) firing++;
+        }
+
+        firing_count_ = firing;
+        evaluations_++;
+        last_evaluation_ns_ = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    void AlertEngine::AppendEventJson(const AlertEvent& event, std::string& out) const {
+        char numbers[96];
+        snprintf(numbers, sizeof(numbers), "\"value\":%.3f,\"threshold\":%.3f", event.value, event.threshold);
+
+        out += "\"timestamp\":" + std::to_string(event.timestamp);
+        out += ",\"rule\":\"";
+        AppendEscaped(out, names_[event.rule]);
+        out += event.firing ? "\",\"state\":\"firing\"," : "\",\"state\":\"resolved\",";
+        out += numbers;
+    }
+
+    std::string AlertEngine::GetStatusJson() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        std::string json = "{\"rules\":[";
+        for (size_t i = 0; i < rules_.size(); ++i) {
+            const Rule& rule = rules_[i];
+            const char* state = rule.firing ? "firing" : rule.pending_ticks > 0 ? "pending" : "ok";
+
+            char value[48];
+            snprintf(value, sizeof(value), "%.3f", signals_[rule.signal].value);
+
+            if (i > 0) json += ",";
+            json += "{\"name\":\"";
+            AppendEscaped(json, names_[i]);
+            json += "\",\"rule\":\"";
+            AppendEscaped(json, texts_[i]);
+            json += std::string("\",\"state\":\"") + state + "\",\"value\":" + value + "}";
+        }
+        json += "]}";
+        return json;
+    }
+
+}
@@ -0,0 +1,242 @@
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <windows.h>
+
+#include "alert_notifier.h"
+#include "agent_policy.h"
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#pragma comment(lib, "ws2_32.lib")
+
+namespace PCMonitor {
+
+    namespace {
+
+        constexpr DWORD kWebhookTimeoutMs = 2000;
+
+        // One argument as CommandLineToArgvW (and the C runtime) will split it
+        // back out: quoted, with quotes and the backslashes before them escaped
+        void AppendQuoted(std::string& line, const std::string& value) {
+            line += '"';
+            size_t backslashes = 0;
+            for (char c : value) {
+                if (c == '\\') {
+                    backslashes++;
+                    continue;
+                }
+                // Backslashes double only when a quote follows them
+                line.append(c == '"' ? backslashes * 2 + 1 : backslashes, '\\');
+                backslashes = 0;
+                line += c;
+            }
+            // ...including the closing one
+            line.append(backslashes * 2, '\\');
+            line += '"';
+        }
+
+    }
+
+    AlertNotifier::AlertNotifier(Settings settings)
+        : settings_(std::move(settings))
+        , running_(false)
+        , delivered_(0)
+        , failed_(0)
+    {
+    }
+
+    AlertNotifier::~AlertNotifier() {
+        Stop();
+    }
+
+    bool AlertNotifier::Start(std::string& error) {
+        if (running_) return false;
+
+        if (!settings_.webhook_url.empty()) {
+            const std::string scheme = "http://";
+            if (settings_.webhook_url.compare(0, scheme.size(), scheme) != 0) {
+                error = "webhook URL must start with http://";
+                return false;
+            }
+
+            std::string authority = settings_.webhook_url.substr(scheme.size());
+            size_t slash = authority.find('/');
+            path_ = slash == std::string::npos ? "/" : authority.substr(slash);
+            authority = authority.substr(0, slash);
+
+            size_t colon = authority.find(':');
+            host_ = authority.substr(0, colon);
+            port_ = colon == std::string::npos ? "80" : authority.substr(colon + 1);
+            if (host_.empty() || port_.empty()) {
+                error = "webhook URL must be http://host[:port][/path]";
+                return false;
+            }
+
+            WSADATA wsaData;
+            if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+                error = "WSAStartup failed";
+                return false;
+            }
+        }
+
+        running_ = true;
+        worker_thread_ = std::make_unique<std::thread>(&AlertNotifier::WorkerLoop, this);
+        return true;
+    }
+
+    void AlertNotifier::Stop() {
+        if (!running_) return;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_ = false;
+        }
+        cv_.notify_all();
+
+        if (worker_thread_ && worker_thread_->joinable()) {
+            worker_thread_->join();
+        }
+        worker_thread_.reset();
+        queue_.clear();
+
+        if (!settings_.webhook_url.empty()) {
+            WSACleanup();
+        }
+    }
+
+    void AlertNotifier::Notify(Notification notification) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!running_ || queue_.size() >= kMaxQueued) {
+                failed_++;
+                return;
+            }
+            queue_.push_back(std::move(notification));
+        }
+        cv_.notify_one();
+    }
+
+    void AlertNotifier::WorkerLoop() {
+        AgentPolicy::ApplyToCurrentThread(ThreadRole::Worker);
+
+        while (running_) {
+            Notification notification;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this] { return !running_ || !queue_.empty(); });
+                if (!running_) break;
+
+                notification = std::move(queue_.front());
+                queue_.pop_front();
+            }
+
+            if (!settings_.webhook_url.empty()) {
+                if (PostWebhook(notification.json)) delivered_++; else failed_++;
+            }
+            if (!settings_.command.empty()) {
+                if (RunCommand(notification)) delivered_++; else failed_++;
+            }
+        }
+    }
+
+    bool AlertNotifier::PostWebhook(const std::string& body) {
+        addrinfo hints = {};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_protocol = IPPROTO_TCP;
+
+        addrinfo* addresses = nullptr;
+        if (getaddrinfo(host_.c_str(), port_.c_str(), &hints, &addresses) != 0) {
+            return false;
+        }
+
+        SOCKET socket = INVALID_SOCKET;
+        for (addrinfo* address = addresses; address; address = address->ai_next) {
+            socket = ::socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+            if (socket == INVALID_SOCKET) continue;
+            if (connect(socket, address->ai_addr, static_cast<int>(address->ai_addrlen)) == 0) break;
+            closesocket(socket);
+            socket = INVALID_SOCKET;
+        }
+        freeaddrinfo(addresses);
+        if (socket == INVALID_SOCKET) return false;
+
+        DWORD timeout = kWebhookTimeoutMs;
+        setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+        setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+
+        std::string request = "POST " + path_ + " HTTP/1.1\r\n"
+                              "Host: " + host_ + "\r\n"
+                              "Content-Type: application/json\r\n"
+                              "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                              "Connection: close\r\n\r\n" + body;
+
+        bool sent = true;
+        for (size_t offset = 0; offset < request.size() && sent;) {
+            int count = send(socket, request.data() + offset, static_cast<int>(request.size() - offset), 0);
+            sent = count > 0;
+            if (sent) offset += static_cast<size_t>(count);
+        }
+
+        // Only the status line matters: "HTTP/1.x 2xx"
+        char status[16] = {};
+        int received = 0;
+        while (sent && received < 12) {
+            int count = recv(socket, status + received, 12 - received, 0);
+            if (count <= 0) break;
+            received += count;
+        }
+        closesocket(socket);
+
+        return received >= 10 && std::string(status, 5) == "HTTP/" && status[9] == '2';
+    }
+
+    bool AlertNotifier::RunCommand(const Notification& notification) {
+        // Placeholders are replaced in one pass, so text inside a value is never
+        // taken for another placeholder, and each becomes exactly one argument
+        const std::pair<const char*, const std::string*> placeholders[] = {
+            { "{rule}", &notification.rule },
+            { "{state}", &notification.state },
+            { "{value}", &notification.value },
+            { "{json}", &notification.json }
+        };
+
+        const std::string& pattern = settings_.command;
+        std::string command;
+        for (size_t at = 0; at < pattern.size();) {
+            bool replaced = false;
+            for (const auto& placeholder : placeholders) {
+                size_t length = strlen(placeholder.first);
+                if (pattern.compare(at, length, placeholder.first) == 0) {
+                    AppendQuoted(command, *placeholder.second);
+                    at += length;
+                    replaced = true;
+                    break;
+                }
+            }
+            if (!replaced) command += pattern[at++];
+        }
+
+        // CreateProcess may write to the command line buffer
+        std::vector<char> line(command.begin(), command.end());
+        line.push_back('\0');
+
+        STARTUPINFOA startup = {};
+        startup.cb = sizeof(startup);
+        PROCESS_INFORMATION process = {};
+        if (!CreateProcessA(nullptr, line.data(), nullptr, nullptr, FALSE, CREATE_NO_WINDOW,
+                            nullptr, nullptr, &startup, &process)) {
+            return false;
+        }
+
+        CloseHandle(process.hThread);
+        CloseHandle(process.hProcess);
+        return true;
+    }
+
+}
@@ -0,0 +1,128 @@
+#include "anomaly_detector.h"
+#include "metrics_projection.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+namespace PCMonitor {
+
+    AnomalyDetector::AnomalyDetector(Settings settings, std::vector<std::string> extra_series)
+        : settings_(settings)
+        , evaluations_(0)
+        , last_evaluation_ns_(0)
+    {
+        ListScalarSeries(fields_, names_);
+        for (std::string& name : extra_series) {
+            names_.push_back(std::move(name));
+        }
+
+        size_t series = names_.size();
+        mean_.assign(series, 0.0);
+        variance_.assign(series, 0.0);
+        count_.assign(series, 0);
+        anomalous_.assign(series, 0);
+        values_.assign(series, 0.0);
+        if (settings_.season_seconds > 0) {
+            season_.assign(series * kSeasonBuckets, 0.0);
+            season_seen_.assign(series * kSeasonBuckets, 0);
+        }
+    }
+
+    void AnomalyDetector::SetEventListener(std::function<void(const AnomalyEvent&)> listener) {
+        event_listener_ = std::move(listener);
+    }
+
+    void AnomalyDetector::Evaluate(const MetricsSnapshot& snapshot, const float* extra_values) {
+        auto start = std::chrono::steady_clock::now();
+
+        size_t field_count = fields_.size();
+        size_t series = names_.size();
+        for (size_t i = 0; i < field_count; ++i) {
+            values_[i] = ReadScalarField(snapshot.metrics, *fields_[i]);
+        }
+        for (size_t i = field_count; i < series; ++i) {
+            values_[i] = extra_values ? static_cast<double>(extra_values[i - field_count]) : NAN;
+        }
+
+        size_t bucket = 0;
+        if (settings_.season_seconds > 0) {
+            uint64_t phase = static_cast<uint64_t>(snapshot.timestamp) % settings_.season_seconds;
+            bucket = static_cast<size_t>(phase * kSeasonBuckets / settings_.season_seconds);
+        }
+
+        const double alpha = settings_.alpha;
+        const double enter = settings_.z_threshold;
+        const double leave = settings_.z_threshold * settings_.clear_ratio;
+
+        for (size_t i = 0; i < series; ++i) {
+            double value = values_[i];
+            if (std::isnan(value)) continue;
+
+            // Residual against the seasonal slot, which learns slowly on its own
+            double baseline = 0.0;
+            if (!season_.empty()) {
+                size_t slot = i * kSeasonBuckets + bucket;
+                if (!season_seen_[slot]) {
+                    season_[slot] = value;
+                    season_seen_[slot] = 1;
+                }
+                baseline = season_[slot];
+                season_[slot] += settings_.season_alpha * (value - baseline);
+            }
+            double residual = value - baseline;
+
+            if (count_[i] == 0) {
+                mean_[i] = residual;
+                count_[i] = 1;
+                continue;
+            }
+
+            // Score against the state before this sample, then fold it in
+            // (West's incremental EW variance). The deviation has a floor so
+            // series that sat perfectly flat don't flag their first wobble.
+            double deviation = residual - mean_[i];
+            double floor = 0.01 * std::fabs(mean_[i] + baseline) + 1e-3;
+            double stddev = std::sqrt(variance_[i]);
+            double z = deviation / (stddev > floor ? stddev : floor);
+
+            double expected = mean_[i] + baseline;
+            double increment = alpha * deviation;
+            mean_[i] += increment;
+            variance_[i] = (1.0 - alpha) * (variance_[i] + deviation * increment);
+            if (count_[i] < settings_.warmup_samples) {
+                count_[i]++;
+                continue;
+            }
+
+            double magnitude = std::fabs(z);
+            bool was_anomalous = anomalous_[i] != 0;
+            if (was_anomalous ? magnitude < leave : magnitude > enter) {
+                anomalous_[i] = was_anomalous ? 0 : 1;
+                if (event_listener_) {
+                    event_listener_(AnomalyEvent{ snapshot.timestamp, static_cast<uint32_t>(i), !was_anomalous,
+                                                  static_cast<float>(value), static_cast<float>(expected), static_cast<float>(z) });
+                }
+            }
+        }
+
+        evaluations_++;
+        last_evaluation_ns_ = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    void AnomalyDetector::AppendEventJson(const AnomalyEvent& event, std::string& out) const {
+        char numbers[160];
+        snprintf(numbers, sizeof(numbers), "\"value\":%.3f,\"expected\":%.3f,\"z\":%.2f",
+                 event.value, event.expected, event.z);
+
+        out += "\"timestamp\":" + std::to_string(event.timestamp);
+        out += ",\"series\":\"";
+        for (char c : names_[event.series]) {
+            if (c == '\\' || c == '"') out += '\\';
+            out += c;
+        }
+        out += event.anomalous ? "\",\"state\":\"anomaly\"," : "\",\"state\":\"normal\",";
+        out += numbers;
+    }
+
+}
@@ -0,0 +1,265 @@
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+
+#include <windows.h>
+
+#include "asset_cache.h"
+#include "agent_policy.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <cstdio>
+
+#ifdef ZLIB_AVAILABLE
+#include <zlib.h>
+#endif
+
+namespace PCMonitor {
+
+    namespace {
+
+        const char* ContentTypeFor(const std::filesystem::path& file) {
+            std::string ext = file.extension().string();
+            if (ext == ".html" || ext == ".htm") return "text/html; charset=utf-8";
+            if (ext == ".js") return "application/javascript; charset=utf-8";
+            if (ext == ".css") return "text/css; charset=utf-8";
+            if (ext == ".json") return "application/json";
+            if (ext == ".svg") return "image/svg+xml";
+            if (ext == ".png") return "image/png";
+            if (ext == ".ico") return "image/x-icon";
+            return "application/octet-stream";
+        }
+
+        std::string HashContent(const std::string& data) {
+            uint64_t hash = 14695981039346656037ULL;
+            for (unsigned char c : data) {
+                hash ^= c;
+                hash *= 1099511628211ULL;
+            }
+            char hex[17];
+            snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+            return hex;
+        }
+
+        bool ReadWholeFile(const std::filesystem::path& file, std::string& out) {
+            std::ifstream in(file, std::ios::binary | std::ios::ate);
+            if (!in.is_open()) return false;
+
+            std::streamsize size = in.tellg();
+            in.seekg(0);
+            out.resize(static_cast<size_t>(size));
+            return size == 0 || static_cast<bool>(in.read(&out[0], size));
+        }
+
+#ifdef ZLIB_AVAILABLE
+        bool IsCompressible(const std::string& content_type) {
+            return content_type.compare(0, 5, "text/") == 0 ||
+                   content_type.find("javascript") != std::string::npos ||
+                   content_type.find("json") != std::string::npos ||
+                   content_type.find("svg") != std::string::npos;
+        }
+
+        std::string GzipCompress(const std::string& input) {
+            z_stream zs = {};
+            // windowBits 15 + 16 selects the gzip wrapper
+            if (deflateInit2(&zs, Z_BEST_COMPRESSION, Z_DEFLATED, 15 + 16, 9, Z_DEFAULT_STRATEGY) != Z_OK) {
+                return std::string();
+            }
+
+            std::string output;
+            output.resize(deflateBound(&zs, static_cast<uLong>(input.size())));
+            zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+            zs.avail_in = static_cast<uInt>(input.size());
+            zs.next_out = reinterpret_cast<Bytef*>(&output[0]);
+            zs.avail_out = static_cast<uInt>(output.size());
+
+            int result = deflate(&zs, Z_FINISH);
+            output.resize(zs.total_out);
+            deflateEnd(&zs);
+
+            return result == Z_STREAM_END ? output : std::string();
+        }
+#endif
+
+    }
+
+    AssetCache::AssetCache(const std::string& root, bool dev_mode)
+        : root_(root)
+        , dev_mode_(dev_mode)
+        , assets_(std::make_shared<const AssetMap>())
+        , watching_(false)
+    {
+    }
+
+    AssetCache::~AssetCache() {
+        StopWatching();
+    }
+
+    bool AssetCache::Load() {
+        std::error_code ec;
+        if (!std::filesystem::is_directory(root_, ec)) {
+            return false;
+        }
+
+        LoadedAssets loaded;
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(root_, ec)) {
+            if (!entry.is_regular_file()) continue;
+
+            auto asset = std::make_shared<StaticAsset>();
+            if (!ReadWholeFile(entry.path(), asset->body)) {
+                std::cerr << "Failed to read web asset " << entry.path().string() << std::endl;
+                continue;
+            }
+
+            asset->path = "/" + std::filesystem::relative(entry.path(), root_).generic_string();
+            asset->content_type = ContentTypeFor(entry.path());
+            loaded[asset->path] = asset;
+        }
+
+        // Stamp references first: a page's hash must cover the stamped URLs
+        StampAssetUrls(loaded);
+
+        auto assets = std::make_shared<AssetMap>();
+        for (auto& item : loaded) {
+            StaticAsset& asset = *item.second;
+            asset.hash = HashContent(asset.body);
+
+#ifdef ZLIB_AVAILABLE
+            if (IsCompressible(asset.content_type) && asset.body.size() > 1024) {
+                asset.gzip_body = GzipCompress(asset.body);
+                if (asset.gzip_body.size() >= asset.body.size()) {
+                    asset.gzip_body.clear();
+                }
+            }
+#endif
+
+            BuildHeaders(asset);
+            (*assets)[item.first] = item.second;
+        }
+
+        // The dashboard is also the site root
+        auto dashboard = assets->find("/dashboard.html");
+        if (dashboard != assets->end()) {
+            (*assets)["/"] = dashboard->second;
+            (*assets)["/index.html"] = dashboard->second;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        assets_ = assets;
+        return true;
+    }
+
+    void AssetCache::StampAssetUrls(LoadedAssets& assets) const {
+        if (dev_mode_) return; // Plain URLs so edits show up on a normal refresh
+
+        for (auto& page : assets) {
+            if (page.second->content_type.compare(0, 9, "text/html") != 0) continue;
+            std::string& html = page.second->body;
+
+            for (const auto& target : assets) {
+                if (target.first == page.first) continue;
+
+                // Only exact src="name" / href="name" references are rewritten
+                std::string version = "?v=" + HashContent(target.second->body);
+                for (const char* attribute : { "src=\"", "href=\"" }) {
+                    std::string needle = attribute + target.first.substr(1) + "\"";
+                    size_t pos = html.find(needle);
+                    while (pos != std::string::npos) {
+                        html.insert(pos + needle.size() - 1, version);
+                        pos = html.find(needle, pos + needle.size() + version.size());
+                    }
+                }
+            }
+        }
+    }
+
+    void AssetCache::BuildHeaders(StaticAsset& asset) const {
+        asset.etag[0] = "\"" + asset.hash + "\"";
+        asset.etag[1] = "\"" + asset.hash + "-gz\"";
+
+        for (int gzip = 0; gzip < 2; ++gzip) {
+            const std::string& body = gzip ? asset.gzip_body : asset.body;
+
+            std::string common;
+            common += "Content-Type: " + asset.content_type + "\r\n";
+            if (gzip) common += "Content-Encoding: gzip\r\n";
+            common += "Vary: Accept-Encoding\r\n";
+            common += "ETag: " + asset.etag[gzip] + "\r\n";
+            common += "Access-Control-Allow-Origin: *\r\n";
+
+            for (int immutable = 0; immutable < 2; ++immutable) {
+                std::string& headers = asset.headers[gzip][immutable];
+                headers = "HTTP/1.1 200 OK\r\n" + common;
+                headers += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+                headers += (immutable && !dev_mode_)
+                    ? "Cache-Control: public, max-age=31536000, immutable\r\n"
+                    : "Cache-Control: no-cache\r\n";
+                headers += "\r\n";
+            }
+
+            asset.not_modified[gzip] = "HTTP/1.1 304 Not Modified\r\n" + common + "\r\n";
+        }
+    }
+
+    std::shared_ptr<const StaticAsset> AssetCache::Find(const std::string& path) const {
+        std::shared_ptr<const AssetMap> assets;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            assets = assets_;
+        }
+
+        auto it = assets->find(path);
+        return it != assets->end() ? it->second : nullptr;
+    }
+
+    size_t AssetCache::GetAssetCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return assets_->size();
+    }
+
+    bool AssetCache::StartWatching() {
+        if (watching_) return false;
+
+        watching_ = true;
+        watch_thread_ = std::make_unique<std::thread>(&AssetCache::WatchLoop, this);
+        return true;
+    }
+
+    void AssetCache::StopWatching() {
+        if (!watching_) return;
+
+        watching_ = false;
+        if (watch_thread_ && watch_thread_->joinable()) {
+            watch_thread_->join();
+        }
+        watch_thread_.reset();
+    }
+
+    void AssetCache::WatchLoop() {
+        AgentPolicy::ApplyToCurrentThread(ThreadRole::Worker);
+
+        HANDLE change = FindFirstChangeNotificationA(root_.c_str(), TRUE,
+            FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE);
+        if (change == INVALID_HANDLE_VALUE) {
+            std::cerr << "Failed to watch " << root_ << " for changes" << std::endl;
+            return;
+        }
+
+        while (watching_) {
+            // Short waits so StopWatching() doesn't block for long
+            if (WaitForSingleObject(change, 500) != WAIT_OBJECT_0) continue;
+
+            // Editors often write in several steps; let them finish
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            if (Load()) {
+                std::cout << "Reloaded web assets from " << root_ << std::endl;
+            }
+
+            if (!FindNextChangeNotification(change)) break;
+        }
+
+        FindCloseChangeNotification(change);
+    }
+
+}
@@ -0,0 +1,153 @@
+#include "binary_codec.h"
+#include <cstring>
+
+namespace PCMonitor {
+
+    namespace {
+
+        // Minimal CBOR writer covering the types the field tables use
+        class CborWriter {
+        private:
+            std::string& out_;
+
+            void WriteHead(uint8_t major, uint64_t value) {
+                uint8_t type = static_cast<uint8_t>(major << 5);
+                if (value < 24) {
+                    out_ += static_cast<char>(type | value);
+                } else if (value <= 0xFF) {
+                    out_ += static_cast<char>(type | 24);
+                    WriteBigEndian(value, 1);
+                } else if (value <= 0xFFFF) {
+                    out_ += static_cast<char>(type | 25);
+                    WriteBigEndian(value, 2);
+                } else if (value <= 0xFFFFFFFFull) {
+                    out_ += static_cast<char>(type | 26);
+                    WriteBigEndian(value, 4);
+                } else {
+                    out_ += static_cast<char>(type | 27);
+                    WriteBigEndian(value, 8);
+                }
+            }
+
+            void WriteBigEndian(uint64_t value, int bytes) {
+                for (int i = bytes - 1; i >= 0; --i) {
+                    out_ += static_cast<char>((value >> (i * 8)) & 0xFF);
+                }
+            }
+
+        public:
+            explicit CborWriter(std::string& out) : out_(out) {}
+
+            void Unsigned(uint64_t value) { WriteHead(0, value); }
+
+            void Signed(int64_t value) {
+                if (value >= 0) {
+                    WriteHead(0, static_cast<uint64_t>(value));
+                } else {
+                    WriteHead(1, static_cast<uint64_t>(-1 - value));
+                }
+            }
+
+            void Float32(double value) {
+                float narrow = static_cast<float>(value);
+                uint32_t bits;
+                memcpy(&bits, &narrow, sizeof(bits));
+                out_ += static_cast<char>(0xFA);
+                WriteBigEndian(bits, 4);
+            }
+
+            void Array(size_t count) { WriteHead(4, count); }
+
+            // Field values, by declared type
+            void Value(uint32_t value) { Unsigned(value); }
+            void Value(uint64_t value) { Unsigned(value); }
+            void Value(double value) { Float32(value); }
+
+            void Value(const FanSpeeds& values) {
+                Array(values.size());
+                for (uint32_t value : values) {
+                    Unsigned(value);
+                }
+            }
+        };
+
+        const char* TypeName(FieldType type) {
+            switch (type) {
+                case FieldType::U32: return "u32";
+                case FieldType::U64: return "u64";
+                case FieldType::F64: return "f32";  // Narrowed on the wire
+                case FieldType::U32Array: return "u32[]";
+            }
+            return "unknown";
+        }
+
+    }
+
+    std::string EncodeMetricsCbor(const MetricsSnapshot& snapshot) {
+        const size_t group_count = sizeof(kMetricGroups) / sizeof(kMetricGroups[0]);
+
+        std::string out;
+        out.reserve(256);
+        CborWriter writer(out);
+
+        writer.Array(3 + group_count);
+        writer.Unsigned(kBinarySchemaVersion);
+        writer.Unsigned(snapshot.version);
+        writer.Signed(snapshot.timestamp);
+
+        VisitGroups(snapshot.metrics, [&writer](const FieldGroup& group, const auto& metrics) {
+            writer.Array(group.field_count);
+            VisitFields(metrics, [&writer](const char*, const auto& value) {
+                writer.Value(value);
+            });
+        });
+
+        return out;
+    }
+
+    std::string GenerateSchemaJson() {
+        std::string json;
+        json.reserve(4096);
+
+        json += "{\n";
+        json += "  \"format\": \"cbor\",\n";
+        json += "  \"schema_version\": " + std::to_string(kBinarySchemaVersion) + ",\n";
+        json += "  \"layout\": [\"schema_version\", \"version\", \"timestamp\"";
+        for (const FieldGroup& group : kMetricGroups) {
+            json += ", \"";
+            json += group.name;
+            json += "\"";
+        }
+        json += "],\n";
+        json += "  \"stream_framing\": \"u32le length prefix per payload\",\n";
+        json += "  \"groups\": [\n";
+
+        const size_t group_count = sizeof(kMetricGroups) / sizeof(kMetricGroups[0]);
+        for (size_t g = 0; g < group_count; ++g) {
+            const FieldGroup& group = kMetricGroups[g];
+            json += "    { \"name\": \"";
+            json += group.name;
+            json += "\", \"fields\": [\n";
+
+            for (size_t i = 0; i < group.field_count; ++i) {
+                const FieldInfo& field = group.fields[i];
+                json += "      { \"name\": \"";
+                json += field.name;
+                json += "\", \"type\": \"";
+                json += TypeName(field.type);
+                json += "\", \"unit\": \"";
+                json += field.unit;
+                json += "\" }";
+                json += (i + 1 < group.field_count) ? ",\n" : "\n";
+            }
+
+            json += "    ] }";
+            json += (g + 1 < group_count) ? ",\n" : "\n";
+        }
+
+        json += "  ]\n";
+        json += "}";
+        return json;
+    }
+
+}
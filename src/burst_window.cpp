@@ -0,0 +1,59 @@
+#include "burst_window.h"
+#include <algorithm>
+
+namespace PCMonitor {
+
+    BurstWindow::BurstWindow()
+        : samples_()
+        , stored_(0)
+        , count_(0)
+        , sum_(0.0)
+        , min_(0.0)
+        , max_(0.0)
+        , random_state_(0x9E3779B97F4A7C15ull)
+    {
+    }
+
+    void BurstWindow::Add(double value) {
+        if (count_ == 0) {
+            min_ = value;
+            max_ = value;
+        } else {
+            if (value < min_) min_ = value;
+            if (value > max_) max_ = value;
+        }
+        sum_ += value;
+        count_++;
+
+        if (stored_ < kCapacity) {
+            samples_[stored_++] = value;
+            return;
+        }
+
+        // Reservoir sampling: sample n replaces a random slot with probability kCapacity / n
+        random_state_ ^= random_state_ << 13;
+        random_state_ ^= random_state_ >> 7;
+        random_state_ ^= random_state_ << 17;
+        uint64_t slot = random_state_ % count_;
+        if (slot < kCapacity) {
+            samples_[slot] = value;
+        }
+    }
+
+    BurstSummary BurstWindow::Take(double fallback) {
+        if (count_ == 0) {
+            return BurstSummary{ fallback, fallback, fallback, fallback };
+        }
+
+        // Nearest rank; the samples are discarded afterwards, so select in place
+        size_t rank = (stored_ * 99 + 99) / 100 - 1;
+        std::nth_element(samples_, samples_ + rank, samples_ + stored_);
+
+        BurstSummary summary{ sum_ / static_cast<double>(count_), min_, max_, samples_[rank] };
+        stored_ = 0;
+        count_ = 0;
+        sum_ = 0.0;
+        return summary;
+    }
+
+}
@@ -0,0 +1,227 @@
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+
+#include <winsock2.h>
+
+#include "chunked_response.h"
+#include "agent_policy.h"
+#include <cstdio>
+
+#ifdef ZLIB_AVAILABLE
+#include <zlib.h>
+#endif
+
+#pragma comment(lib, "ws2_32.lib")
+
+namespace PCMonitor {
+
+    namespace {
+
+        bool SendAll(SOCKET socket, const std::string& data) {
+            size_t offset = 0;
+            while (offset < data.size()) {
+                int sent = send(socket, data.data() + offset, static_cast<int>(data.size() - offset), 0);
+                if (sent == SOCKET_ERROR || sent == 0) return false;
+                offset += static_cast<size_t>(sent);
+            }
+            return true;
+        }
+
+    }
+
+#ifdef ZLIB_AVAILABLE
+    struct ChunkedEncoder::Deflater {
+        z_stream stream = {};
+
+        bool Init() {
+            // Default level: this runs per request, unlike the one-off asset compression
+            return deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+        }
+
+        ~Deflater() { deflateEnd(&stream); }
+
+        // Runs the compressor over input, appending whatever it emits
+        void Run(std::string_view input, int flush, std::string& out) {
+            stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+            stream.avail_in = static_cast<uInt>(input.size());
+
+            char buffer[16 * 1024];
+            do {
+                stream.next_out = reinterpret_cast<Bytef*>(buffer);
+                stream.avail_out = sizeof(buffer);
+                deflate(&stream, flush);
+                out.append(buffer, sizeof(buffer) - stream.avail_out);
+            } while (stream.avail_out == 0);
+        }
+    };
+#else
+    struct ChunkedEncoder::Deflater {};
+#endif
+
+    ChunkedEncoder::ChunkedEncoder(bool chunked, bool gzip)
+        : chunked_(chunked)
+    {
+#ifdef ZLIB_AVAILABLE
+        if (gzip) {
+            deflater_ = std::make_unique<Deflater>();
+            if (!deflater_->Init()) {
+                deflater_.reset();
+            }
+        }
+#else
+        (void)gzip;
+#endif
+    }
+
+    ChunkedEncoder::~ChunkedEncoder() = default;
+
+    void ChunkedEncoder::AppendChunk(std::string_view data, std::string& out) const {
+        if (data.empty()) return;   // An empty chunk would end the body
+        if (!chunked_) {
+            out.append(data);
+            return;
+        }
+
+        char size[20];
+        int length = snprintf(size, sizeof(size), "%zx\r\n", data.size());
+        out.append(size, static_cast<size_t>(length));
+        out.append(data);
+        out += "\r\n";
+    }
+
+    void ChunkedEncoder::Write(std::string_view data, std::string& out) {
+#ifdef ZLIB_AVAILABLE
+        if (deflater_) {
+            compressed_.clear();
+            deflater_->Run(data, Z_NO_FLUSH, compressed_);
+            AppendChunk(compressed_, out);
+            return;
+        }
+#endif
+        AppendChunk(data, out);
+    }
+
+    void ChunkedEncoder::Finish(std::string& out) {
+#ifdef ZLIB_AVAILABLE
+        if (deflater_) {
+            compressed_.clear();
+            deflater_->Run(std::string_view(), Z_FINISH, compressed_);
+            AppendChunk(compressed_, out);
+        }
+#endif
+        if (chunked_) {
+            out += "0\r\n\r\n";
+        }
+    }
+
+    ChunkedResponder::ChunkedResponder()
+        : running_(false)
+        , responses_sent_(0)
+    {
+    }
+
+    ChunkedResponder::~ChunkedResponder() {
+        Stop();
+    }
+
+    bool ChunkedResponder::SupportsGzip() {
+#ifdef ZLIB_AVAILABLE
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    bool ChunkedResponder::Start() {
+        if (running_) return false;
+
+        running_ = true;
+        worker_thread_ = std::make_unique<std::thread>(&ChunkedResponder::WorkerLoop, this);
+        return true;
+    }
+
+    void ChunkedResponder::Stop() {
+        if (!running_) return;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_ = false;
+        }
+        cv_.notify_all();
+
+        if (worker_thread_ && worker_thread_->joinable()) {
+            worker_thread_->join();
+        }
+        worker_thread_.reset();
+
+        for (const Job& job : jobs_) {
+            closesocket(static_cast<SOCKET>(job.socket));
+        }
+        jobs_.clear();
+    }
+
+    void ChunkedResponder::Submit(SocketHandle socket, std::string headers, BodyGenerator generator, bool chunked, bool gzip) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!running_) {
+                closesocket(static_cast<SOCKET>(socket));
+                return;
+            }
+            jobs_.push_back(Job{ socket, std::move(headers), std::move(generator), chunked, gzip });
+        }
+        cv_.notify_one();
+    }
+
+    void ChunkedResponder::WorkerLoop() {
+        AgentPolicy::ApplyToCurrentThread(ThreadRole::Worker);
+
+        while (running_) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this] { return !running_ || !jobs_.empty(); });
+                if (!running_) break;
+
+                job = std::move(jobs_.front());
+                jobs_.pop_front();
+            }
+
+            Respond(job);
+            closesocket(static_cast<SOCKET>(job.socket));
+            responses_sent_++;
+        }
+    }
+
+    void ChunkedResponder::Respond(Job& job) {
+        SOCKET socket = static_cast<SOCKET>(job.socket);
+        ChunkedEncoder encoder(job.chunked, job.gzip);
+
+        std::string wire = job.headers;
+        if (job.chunked) wire += "Transfer-Encoding: chunked\r\n";
+        if (encoder.IsGzip()) wire += "Content-Encoding: gzip\r\n";
+        wire += "Connection: close\r\n\r\n";
+        if (!SendAll(socket, wire)) return;
+
+        // The same two buffers are reused for every piece
+        std::string piece;
+        piece.reserve(kChunkBytes + 1024);
+        wire.reserve(kChunkBytes + 1024);
+
+        bool more = true;
+        while (more && running_) {
+            piece.clear();
+            more = job.generator(piece);
+
+            wire.clear();
+            encoder.Write(piece, wire);
+            if (!SendAll(socket, wire)) return;   // Client went away
+        }
+        if (more) return;   // Shutting down mid-body: just close
+
+        wire.clear();
+        encoder.Finish(wire);
+        SendAll(socket, wire);
+    }
+
+}
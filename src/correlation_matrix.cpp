@@ -0,0 +1,214 @@
+#include "correlation_matrix.h"
+#include "metrics_projection.h"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+namespace PCMonitor {
+
+    namespace {
+
+        // Adds in[i]*in[j] - out[i]*out[j] to every packed pair i <= j. The
+        // inner loop runs over contiguous memory with no dependencies.
+        void UpdateProducts(double* products, const double* in, const double* out, size_t series) {
+            for (size_t i = 0; i < series; ++i) {
+                const double a = in[i];
+                const double b = out[i];
+                const size_t length = series - i;
+                const double* in_row = in + i;
+                const double* out_row = out + i;
+                for (size_t j = 0; j < length; ++j) {
+                    products[j] += a * in_row[j] - b * out_row[j];
+                }
+                products += length;
+            }
+        }
+
+        void AppendName(std::string& out, const std::string& name) {
+            out += '"';
+            for (char c : name) {
+                if (c == '\\' || c == '"') out += '\\';
+                out += c;
+            }
+            out += '"';
+        }
+
+        struct Pair {
+            float r;
+            float covariance;
+            uint32_t a;
+            uint32_t b;
+        };
+
+    }
+
+    CorrelationMatrix::CorrelationMatrix(size_t window, std::vector<std::string> extra_series)
+        : window_(window < 3 ? 3 : window)
+        , count_(0)
+        , head_(0)
+        , since_rebuild_(0)
+        , latest_timestamp_(0)
+        , updates_(0)
+        , last_update_ns_(0)
+    {
+        ListScalarSeries(fields_, names_);
+        for (std::string& name : extra_series) {
+            names_.push_back(std::move(name));
+        }
+
+        size_t series = names_.size();
+        samples_.assign(window_ * series, 0.0f);
+        offsets_.assign(series, 0.0);
+        sums_.assign(series, 0.0);
+        products_.assign(series * (series + 1) / 2, 0.0);
+        held_.assign(series, 0.0f);
+        entering_.assign(series, 0.0);
+        leaving_.assign(series, 0.0);
+    }
+
+    void CorrelationMatrix::Add(const MetricsSnapshot& snapshot, const float* extra_values) {
+        auto start = std::chrono::steady_clock::now();
+
+        size_t field_count = fields_.size();
+        size_t series = names_.size();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        latest_timestamp_ = snapshot.timestamp;
+
+        for (size_t i = 0; i < series; ++i) {
+            double value = i < field_count ? ReadScalarField(snapshot.metrics, *fields_[i])
+                         : extra_values ? static_cast<double>(extra_values[i - field_count]) : NAN;
+            if (std::isfinite(value)) {
+                held_[i] = static_cast<float>(value);
+            }
+        }
+
+        // The very first sample sets the offsets until the first rebuild
+        if (count_ == 0) {
+            for (size_t i = 0; i < series; ++i) offsets_[i] = held_[i];
+        }
+
+        float* row = &samples_[head_ * series];
+        bool full = count_ == window_;
+        for (size_t i = 0; i < series; ++i) {
+            leaving_[i] = full ? row[i] - offsets_[i] : 0.0;
+            row[i] = held_[i];
+            entering_[i] = held_[i] - offsets_[i];
+            sums_[i] += entering_[i] - leaving_[i];
+        }
+        UpdateProducts(products_.data(), entering_.data(), leaving_.data(), series);
+
+        head_ = (head_ + 1) % window_;
+        if (!full) count_++;
+        if (++since_rebuild_ >= window_) {
+            Rebuild();
+        }
+
+        updates_++;
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        last_update_ns_ = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    }
+
+    // Recenters on the window mean and recomputes the sums from the retained
+    // samples: O(window * n^2), once per window
+    void CorrelationMatrix::Rebuild() {
+        size_t series = names_.size();
+        since_rebuild_ = 0;
+
+        std::fill(offsets_.begin(), offsets_.end(), 0.0);
+        for (size_t s = 0; s < count_; ++s) {
+            const float* row = &samples_[s * series];
+            for (size_t i = 0; i < series; ++i) offsets_[i] += row[i];
+        }
+        for (double& offset : offsets_) offset /= static_cast<double>(count_);
+
+        std::fill(sums_.begin(), sums_.end(), 0.0);
+        std::fill(products_.begin(), products_.end(), 0.0);
+        std::fill(leaving_.begin(), leaving_.end(), 0.0);
+        for (size_t s = 0; s < count_; ++s) {
+            const float* row = &samples_[s * series];
+            for (size_t i = 0; i < series; ++i) {
+                entering_[i] = row[i] - offsets_[i];
+                sums_[i] += entering_[i];
+            }
+            UpdateProducts(products_.data(), entering_.data(), leaving_.data(), series);
+        }
+    }
+
+    bool CorrelationMatrix::AppendJson(std::string_view series, std::string_view top, std::string& out,
+                                       std::string& error) const {
+        size_t limit = kDefaultTop;
+        if (!top.empty()) {
+            auto result = std::from_chars(top.data(), top.data() + top.size(), limit);
+            if (result.ec != std::errc() || result.ptr != top.data() + top.size() || limit == 0 || limit > kMaxTop) {
+                error = "top must be a number from 1 to " + std::to_string(kMaxTop);
+                return false;
+            }
+        }
+
+        size_t series_count = names_.size();
+        std::vector<bool> selected;
+        if (!MatchSeries(series, names_, selected, error)) {
+            return false;
+        }
+
+        std::vector<Pair> pairs;
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        // Population statistics of the centered values
+        double n = static_cast<double>(count_);
+        std::vector<double> means(series_count, 0.0);
+        std::vector<double> deviations(series_count, 0.0);
+        size_t diagonal = 0;
+        for (size_t i = 0; i < series_count; ++i) {
+            if (count_ >= 3) {
+                means[i] = sums_[i] / n;
+                double variance = products_[diagonal] / n - means[i] * means[i];
+                // Flat, up to float rounding of the stored samples
+                double floor = 1e-12 * (1.0 + offsets_[i] * offsets_[i]);
+                deviations[i] = variance > floor ? std::sqrt(variance) : 0.0;
+            }
+            diagonal += series_count - i;
+        }
+
+        const double* row = products_.data();
+        for (size_t i = 0; i < series_count; ++i) {
+            for (size_t j = i + 1; j < series_count; ++j) {
+                if (deviations[i] == 0.0 || deviations[j] == 0.0 || !(selected[i] || selected[j])) continue;
+                double covariance = row[j - i] / n - means[i] * means[j];
+                double r = covariance / (deviations[i] * deviations[j]);
+                r = r > 1.0 ? 1.0 : (r < -1.0 ? -1.0 : r);
+                pairs.push_back({ static_cast<float>(r), static_cast<float>(covariance),
+                                  static_cast<uint32_t>(i), static_cast<uint32_t>(j) });
+            }
+            row += series_count - i;
+        }
+
+        if (limit > pairs.size()) limit = pairs.size();
+        std::partial_sort(pairs.begin(), pairs.begin() + limit, pairs.end(), [](const Pair& x, const Pair& y) {
+            return std::fabs(x.r) > std::fabs(y.r);
+        });
+
+        out += "{\"timestamp\":" + std::to_string(latest_timestamp_);
+        out += ",\"window\":" + std::to_string(window_);
+        out += ",\"samples\":" + std::to_string(count_);
+        out += ",\"series\":" + std::to_string(series_count);
+        out += ",\"pairs\":[";
+        for (size_t k = 0; k < limit; ++k) {
+            const Pair& pair = pairs[k];
+            out += k == 0 ? "{\"a\":" : ",{\"a\":";
+            AppendName(out, names_[pair.a]);
+            out += ",\"b\":";
+            AppendName(out, names_[pair.b]);
+
+            char numbers[64];
+            snprintf(numbers, sizeof(numbers), ",\"r\":%.3f,\"covariance\":%.6g}", pair.r, pair.covariance);
+            out += numbers;
+        }
+        out += "]}";
+        return true;
+    }
+
+}
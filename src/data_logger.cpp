@@ -1,5 +1,7 @@
 #include "data_logger.h"
 #include "performance_monitor.h"
+#include "metrics_serializer.h"
+#include "agent_policy.h"
 #include <iomanip>
 #include <sstream>
 #include <filesystem>
@@ -7,6 +9,47 @@
 
 namespace PCMonitor {
 
+    namespace {
+
+        // <path>.<YYYYmmdd_HHMMSS> for a log being moved aside
+        std::string BackupName(const std::string& path) {
+            auto now = std::chrono::system_clock::now();
+            auto time_t = std::chrono::system_clock::to_time_t(now);
+            std::ostringstream backup_name;
+            backup_name << path << "." << std::put_time(std::localtime(&time_t), "%Y%m%d_%H%M%S");
+            return backup_name.str();
+        }
+
+    }
+
+    bool OpenCsvLog(std::ofstream& file, const std::string& path) {
+        const std::string& header = GetCsvHeader();
+
+        std::string first_line;
+        {
+            std::ifstream existing(path, std::ios::binary);
+            if (existing.is_open()) std::getline(existing, first_line);
+        }
+
+        if (!first_line.empty() && first_line + "\n" != header) {
+            try {
+                std::filesystem::rename(path, BackupName(path));
+            } catch (const std::exception& e) {
+                std::cerr << "Failed to move aside log with old columns: " << e.what() << std::endl;
+            }
+        }
+
+        file.open(path, std::ios::app | std::ios::binary);
+        if (!file.is_open()) return false;
+
+        file.seekp(0, std::ios::end);
+        if (file.tellp() == 0) {
+            file.write(header.data(), static_cast<std::streamsize>(header.size()));
+            file.flush();
+        }
+        return true;
+    }
+
     DataLogger::DataLogger(const std::string& log_path, size_t max_size_mb, bool rotate)
         : log_path_(log_path)
         , max_file_size_(max_size_mb * 1024 * 1024)
@@ -26,8 +69,6 @@ namespace PCMonitor {
             return false;
         }
         
-        WriteHeader();
-        
         // Start async logging thread
         logging_active_ = true;
         logging_thread_ = std::make_unique<std::thread>(&DataLogger::LoggingLoop, this);
@@ -36,19 +77,7 @@ namespace PCMonitor {
     }
 
     bool DataLogger::OpenLogFile() {
-        log_file_.open(log_path_, std::ios::app | std::ios::binary);
-        return log_file_.is_open();
-    }
-
-    void DataLogger::WriteHeader() {
-        if (log_file_.tellp() == 0) { // File is empty, write header
-            log_file_ << "Timestamp,CPU_Usage_%,CPU_Temp_C,CPU_Clock_MHz,"
-                      << "GPU_Usage_%,GPU_Temp_C,GPU_Clock_MHz,GPU_VRAM_Used_MB,"
-                      << "RAM_Usage_%,RAM_Used_MB,"
-                      << "Storage_Read_MBps,Storage_Write_MBps,"
-                      << "System_Power_W,PSU_Efficiency_%,"
-                      << "Case_Temp_C,Fan1_RPM,Fan2_RPM,Fan3_RPM\n";
-        }
+        return OpenCsvLog(log_file_, log_path_);
     }
 
     void DataLogger::LogMetrics(const SystemMetrics& metrics) {
@@ -66,6 +95,11 @@ namespace PCMonitor {
     }
 
     void DataLogger::LoggingLoop() {
+        AgentPolicy::ApplyToCurrentThread(ThreadRole::Worker);
+
+        std::string log_line;
+        log_line.reserve(1024);
+
         while (logging_active_) {
             std::unique_lock<std::mutex> lock(queue_mutex_);
             queue_cv_.wait(lock, [this] { return !log_queue_.empty() || !logging_active_; });
@@ -75,8 +109,9 @@ namespace PCMonitor {
                 log_queue_.pop();
                 lock.unlock();
                 
-                std::string log_line = FormatLogEntry(entry);
-                log_file_ << log_line;
+                log_line.clear();
+                FormatLogEntry(entry, log_line);
+                log_file_.write(log_line.data(), static_cast<std::streamsize>(log_line.size()));
                 log_file_.flush();
                 
                 bytes_written_ += log_line.length();
@@ -93,50 +128,22 @@ namespace PCMonitor {
         }
     }
 
-    std::string DataLogger::FormatLogEntry(const LogEntry& entry) {
-        std::ostringstream oss;
+    void DataLogger::FormatLogEntry(const LogEntry& entry, std::string& out) {
         auto time_t = std::chrono::system_clock::to_time_t(entry.timestamp);
-        
-        oss << std::put_time(std::localtime(&time_t), "%Y-%m-%d %H:%M:%S") << ","
-            << std::fixed << std::setprecision(2) << entry.metrics.ram.utilization_percent << ","
-            << entry.metrics.ram.used_mb << ","
-            << entry.metrics.storage.seq_read_mbps << ","
-            << entry.metrics.storage.seq_write_mbps << ","
-            << entry.metrics.power.system_power_w << ","
-            << std::fixed << std::setprecision(2) << entry.metrics.power.efficiency_percent << ","
-            << entry.metrics.thermal.case_temp_c << ",";
-        
-        // Fan speeds (up to 3 fans)
-        for (size_t i = 0; i < 3; ++i) {
-            if (i < entry.metrics.thermal.fan_speeds_rpm.size()) {
-                oss << entry.metrics.thermal.fan_speeds_rpm[i];
-            } else {
-                oss << "0";
-            }
-            if (i < 2) oss << ",";
-        }
-        oss << "\n";
-        
-        return oss.str();
+        WriteCsvRow(static_cast<int64_t>(time_t), entry.metrics, out);
     }
 
     void DataLogger::RotateLogFile() {
         log_file_.close();
         
         // Create timestamped backup
-        auto now = std::chrono::system_clock::now();
-        auto time_t = std::chrono::system_clock::to_time_t(now);
-        std::ostringstream backup_name;
-        backup_name << log_path_ << "." << std::put_time(std::localtime(&time_t), "%Y%m%d_%H%M%S");
-        
         try {
-            std::filesystem::rename(log_path_, backup_name.str());
+            std::filesystem::rename(log_path_, BackupName(log_path_));
         } catch (const std::exception& e) {
             std::cerr << "Failed to rotate log file: " << e.what() << std::endl;
         }
         
         OpenLogFile();
-        WriteHeader();
     }
 
     void DataLogger::Shutdown() {
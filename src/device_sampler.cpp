@@ -0,0 +1,89 @@
+#include "device_sampler.h"
+#include <cstring>
+#include <limits>
+
+namespace PCMonitor {
+
+    DeviceSampler::DeviceSampler()
+        : query_(nullptr)
+    {
+    }
+
+    DeviceSampler::~DeviceSampler() {
+        if (query_) {
+            PdhCloseQuery(query_);
+        }
+    }
+
+    bool DeviceSampler::Initialize() {
+        if (query_) return true;
+        if (PdhOpenQuery(nullptr, 0, &query_) != ERROR_SUCCESS) {
+            query_ = nullptr;
+            return false;
+        }
+
+        AddInstances("\\Processor(*)\\% Processor Time", "cpu.");
+        AddInstances("\\PhysicalDisk(*)\\Disk Bytes/sec", "disk.");
+        AddInstances("\\Network Interface(*)\\Bytes Total/sec", "net.");
+
+        values_.assign(names_.size(), std::numeric_limits<float>::quiet_NaN());
+
+        // Rate counters need a first collection as their baseline
+        PdhCollectQueryData(query_);
+        return !names_.empty();
+    }
+
+    void DeviceSampler::AddInstances(const char* wildcard_path, const char* prefix) {
+        DWORD length = 0;
+        if (PdhExpandWildCardPathA(nullptr, wildcard_path, nullptr, &length, 0) != static_cast<PDH_STATUS>(PDH_MORE_DATA)) {
+            return;
+        }
+
+        // Double-NUL-terminated list of full counter paths, one per instance
+        std::vector<char> paths(length + 2);
+        if (PdhExpandWildCardPathA(nullptr, wildcard_path, paths.data(), &length, 0) != ERROR_SUCCESS) {
+            return;
+        }
+
+        for (const char* path = paths.data(); *path && names_.size() < kMaxSeries; path += strlen(path) + 1) {
+            std::string_view full(path);
+            size_t open = full.find('(');
+            size_t close = full.rfind(')');
+            if (open == std::string_view::npos || close == std::string_view::npos || close <= open) continue;
+
+            PDH_HCOUNTER counter;
+            if (PdhAddCounterA(query_, path, 0, &counter) != ERROR_SUCCESS) continue;
+
+            std::string instance(full.substr(open + 1, close - open - 1));
+            if (instance == "_Total") instance = "total";
+            for (char& c : instance) {
+                if (c == ' ') c = '_';
+            }
+
+            counters_.push_back(counter);
+            names_.push_back(prefix + instance);
+        }
+    }
+
+    void DeviceSampler::Sample() {
+        if (!query_) return;
+        PdhCollectQueryData(query_);
+
+        PDH_FMT_COUNTERVALUE counter_val;
+        for (size_t i = 0; i < counters_.size(); ++i) {
+            if (PdhGetFormattedCounterValue(counters_[i], PDH_FMT_DOUBLE, nullptr, &counter_val) == ERROR_SUCCESS) {
+                values_[i] = static_cast<float>(counter_val.doubleValue);
+            } else {
+                values_[i] = std::numeric_limits<float>::quiet_NaN();
+            }
+        }
+    }
+
+    int DeviceSampler::FindSeries(std::string_view name) const {
+        for (size_t i = 0; i < names_.size(); ++i) {
+            if (names_[i] == name) return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+}
@@ -0,0 +1,204 @@
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+
+#include <winsock2.h>
+
+#include "event_stream.h"
+#include "agent_policy.h"
+#include <algorithm>
+#include <iostream>
+
+#pragma comment(lib, "ws2_32.lib")
+
+namespace PCMonitor {
+
+    EventStream::EventStream(std::string log_path)
+        : log_path_(std::move(log_path))
+        , running_(false)
+        , events_(kRetainedEvents)
+        , next_id_(1)
+        , logged_id_(0)
+        , subscriber_count_(0)
+        , events_logged_(0)
+    {
+    }
+
+    EventStream::~EventStream() {
+        Stop();
+    }
+
+    bool EventStream::Start() {
+        if (running_) return false;
+
+        log_.open(log_path_, std::ios::app | std::ios::binary);
+        if (!log_.is_open()) {
+            std::cerr << "Failed to open event log " << log_path_ << std::endl;
+        }
+
+        logged_id_ = GetLatestId();
+        running_ = true;
+        stream_thread_ = std::make_unique<std::thread>(&EventStream::StreamLoop, this);
+        return true;
+    }
+
+    void EventStream::Stop() {
+        if (!running_) return;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_ = false;
+        }
+        cv_.notify_all();
+
+        if (stream_thread_ && stream_thread_->joinable()) {
+            stream_thread_->join();
+        }
+        stream_thread_.reset();
+
+        for (FrameSink& sink : subscribers_) {
+            sink.Close();
+        }
+        subscribers_.clear();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const PendingSubscriber& pending : new_subscribers_) {
+            closesocket(static_cast<SOCKET>(pending.socket));
+        }
+        new_subscribers_.clear();
+        subscriber_count_ = 0;
+        log_.close();
+    }
+
+    void EventStream::AddSubscriber(FrameSink::SocketHandle socket, uint64_t since) {
+        FrameSink::MakeNonBlocking(socket);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!running_) {
+                closesocket(static_cast<SOCKET>(socket));
+                return;
+            }
+            new_subscribers_.push_back(PendingSubscriber{ socket, since });
+        }
+        cv_.notify_one();
+    }
+
+    void EventStream::Publish(std::string_view type, std::string_view members) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            Event& event = events_[next_id_ % kRetainedEvents];
+            event.id = next_id_++;
+            event.type.assign(type.data(), type.size());
+            event.json = "{\"id\":" + std::to_string(event.id) + ",\"type\":\"" + event.type + "\",";
+            event.json.append(members.data(), members.size());
+            event.json += '}';
+        }
+        cv_.notify_one();
+    }
+
+    uint64_t EventStream::GetLatestId() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return next_id_ - 1;
+    }
+
+    void EventStream::CopyEventsSince(uint64_t since) {
+        scratch_.clear();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint64_t latest = next_id_ - 1;
+        uint64_t oldest = latest >= kRetainedEvents ? latest - kRetainedEvents + 1 : 1;
+        for (uint64_t id = since + 1 > oldest ? since + 1 : oldest; id <= latest; ++id) {
+            scratch_.push_back(events_[id % kRetainedEvents]);
+        }
+    }
+
+    void EventStream::LogNewEvents(uint64_t latest) {
+        if (latest <= logged_id_) return;
+
+        CopyEventsSince(logged_id_);
+        logged_id_ = latest;
+
+        for (const Event& event : scratch_) {
+            if (log_.is_open()) {
+                log_.write(event.json.data(), static_cast<std::streamsize>(event.json.size()));
+                log_.put('\n');
+            }
+            std::cout << "🔔 " << event.json << std::endl;
+            events_logged_++;
+        }
+        log_.flush();
+    }
+
+    std::shared_ptr<const std::string> EventStream::FrameSince(uint64_t since) {
+        auto& frame = frames_[since];
+        if (frame) return frame;
+
+        CopyEventsSince(since);
+
+        std::string text;
+        for (const Event& event : scratch_) {
+            text += "id: " + std::to_string(event.id) + "\nevent: " + event.type + "\ndata: ";
+            text += event.json;
+            text += "\n\n";
+        }
+        frame = std::make_shared<const std::string>(std::move(text));
+        return frame;
+    }
+
+    void EventStream::StreamLoop() {
+        AgentPolicy::ApplyToCurrentThread(ThreadRole::Worker);
+
+        bool pending_writes = false;
+        uint64_t queued_id = 0;
+
+        while (running_) {
+            std::vector<PendingSubscriber> added;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                auto timeout = pending_writes ? std::chrono::milliseconds(20) : std::chrono::milliseconds(1000);
+                cv_.wait_for(lock, timeout, [this, queued_id] {
+                    return !running_ || next_id_ - 1 != queued_id || !new_subscribers_.empty();
+                });
+
+                if (!running_) break;
+
+                added.swap(new_subscribers_);
+            }
+
+            uint64_t latest = GetLatestId();
+            LogNewEvents(latest);
+
+            size_t first_added = subscribers_.size();
+            for (const PendingSubscriber& pending : added) {
+                subscribers_.emplace_back(pending.socket, pending.since < latest ? pending.since : latest);
+            }
+
+            // Everyone who is behind gets what they've missed, in one frame;
+            // without new events only the new clients need one
+            frames_.clear();
+            for (size_t i = latest != queued_id ? 0 : first_added; i < subscribers_.size(); ++i) {
+                uint64_t since = subscribers_[i].GetFrameVersion();
+                if (since < latest) {
+                    subscribers_[i].Queue(FrameSince(since), latest);
+                }
+            }
+            queued_id = latest;
+
+            pending_writes = false;
+            for (FrameSink& sink : subscribers_) {
+                if (!sink.Flush()) {
+                    sink.Close();
+                } else if (sink.HasPendingWrites()) {
+                    pending_writes = true;
+                }
+            }
+
+            auto closed = std::remove_if(subscribers_.begin(), subscribers_.end(),
+                                         [](const FrameSink& sink) { return !sink.IsOpen(); });
+            subscribers_.erase(closed, subscribers_.end());
+            subscriber_count_ = subscribers_.size();
+        }
+    }
+
+}
@@ -0,0 +1,374 @@
+#include "flight_recorder.h"
+#include "device_sampler.h"
+#include "agent_policy.h"
+#include <charconv>
+#include <algorithm>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+namespace PCMonitor {
+
+    namespace {
+
+        template <typename T>
+        void WriteValue(std::ofstream& out, T value) {
+            out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+
+        const char* SourceName(TriggerSource source) {
+            switch (source) {
+                case TriggerSource::Threshold: return "threshold";
+                case TriggerSource::Api: return "api";
+                case TriggerSource::Signal: return "signal";
+            }
+            return "unknown";
+        }
+
+        // Paths and counter instance names may contain backslashes
+        std::string JsonString(const std::string& text) {
+            std::string quoted = "\"";
+            for (char c : text) {
+                if (c == '\\' || c == '"') quoted += '\\';
+                quoted += c;
+            }
+            quoted += '"';
+            return quoted;
+        }
+
+    }
+
+    FlightRecorder::FlightRecorder(const DeviceSampler& devices, Settings settings)
+        : devices_(devices)
+        , settings_(std::move(settings))
+        , period_ms_(0)
+        , series_count_(0)
+        , capacity_(0)
+        , post_samples_(0)
+        , active_(&rings_[0])
+        , next_slot_(0)
+        , stored_(0)
+        , capturing_(false)
+        , post_remaining_(0)
+        , pending_()
+        , trigger_series_(-1)
+        , trigger_above_(true)
+        , trigger_value_(0.0f)
+        , trigger_armed_(true)
+        , requested_(0)
+        , last_api_trigger_ms_(0)
+        , spare_ready_(false)
+        , capturing_flag_(false)
+        , running_(false)
+        , spare_(&rings_[1])
+        , has_capture_(false)
+        , capture_()
+        , captures_written_(0)
+        , triggers_dropped_(0)
+    {
+    }
+
+    FlightRecorder::~FlightRecorder() {
+        Stop();
+    }
+
+    bool FlightRecorder::ParseTrigger() {
+        const std::string& text = settings_.trigger;
+        if (text.empty()) return true;
+
+        size_t op = text.find_first_of("<>");
+        if (op == std::string::npos || op == 0) return false;
+
+        float value = 0.0f;
+        const char* first = text.data() + op + 1;
+        const char* last = text.data() + text.size();
+        auto result = std::from_chars(first, last, value);
+        if (result.ec != std::errc() || result.ptr != last) return false;
+
+        trigger_series_ = devices_.FindSeries(std::string_view(text).substr(0, op));
+        trigger_above_ = text[op] == '>';
+        trigger_value_ = value;
+        return trigger_series_ >= 0;
+    }
+
+    bool FlightRecorder::Start(std::chrono::milliseconds period) {
+        if (running_ || period.count() <= 0) return false;
+
+        if (!ParseTrigger()) {
+            std::cerr << "Flight recorder trigger '" << settings_.trigger
+                      << "' doesn't name a recorded series (e.g. cpu.total>95)" << std::endl;
+            trigger_series_ = -1;
+        }
+
+        period_ms_ = static_cast<uint32_t>(period.count());
+        series_count_ = devices_.GetSeriesCount();
+        post_samples_ = settings_.post_seconds * 1000u / period_ms_;
+        capacity_ = settings_.pre_seconds * 1000u / period_ms_ + post_samples_ + 1;
+
+        // Both rings up front: the sampler only ever swaps pointers
+        for (Ring& ring : rings_) {
+            ring.times_us.assign(capacity_, 0);
+            ring.values.assign(capacity_ * series_count_, 0.0f);
+        }
+        active_ = &rings_[0];
+        spare_ = &rings_[1];
+        next_slot_ = 0;
+        stored_ = 0;
+        epoch_ = std::chrono::steady_clock::now();
+        spare_ready_ = true;
+
+        running_ = true;
+        writer_thread_ = std::make_unique<std::thread>(&FlightRecorder::WriterLoop, this);
+        return true;
+    }
+
+    void FlightRecorder::Stop() {
+        if (!running_) return;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_ = false;
+        }
+        cv_.notify_all();
+
+        if (writer_thread_ && writer_thread_->joinable()) {
+            writer_thread_->join();
+        }
+        writer_thread_.reset();
+    }
+
+    FlightRecorder::TriggerResult FlightRecorder::RequestTrigger(TriggerSource source) {
+        if (!running_ || capturing_flag_ || !spare_ready_) {
+            triggers_dropped_++;
+            return TriggerResult::Busy;
+        }
+
+        // The endpoint is unauthenticated: without a limit any client could
+        // keep the disk busy writing captures
+        if (source == TriggerSource::Api) {
+            int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+            int64_t last_ms = last_api_trigger_ms_.load();
+            if ((last_ms != 0 && now_ms - last_ms < kApiTriggerIntervalSeconds * 1000) ||
+                !last_api_trigger_ms_.compare_exchange_strong(last_ms, now_ms)) {
+                triggers_dropped_++;
+                return TriggerResult::RateLimited;
+            }
+        }
+
+        requested_.store(static_cast<uint32_t>(source) + 1, std::memory_order_release);
+        return TriggerResult::Accepted;
+    }
+
+    void FlightRecorder::Record(std::chrono::steady_clock::time_point time) {
+        if (!running_) return;
+
+        size_t slot = next_slot_;
+        active_->times_us[slot] = std::chrono::duration_cast<std::chrono::microseconds>(time - epoch_).count();
+        memcpy(&active_->values[slot * series_count_], devices_.GetValues(), series_count_ * sizeof(float));
+        next_slot_ = (next_slot_ + 1) % capacity_;
+        if (stored_ < capacity_) stored_++;
+
+        if (capturing_) {
+            if (post_remaining_ == 0 || --post_remaining_ == 0) {
+                FreezeCapture();
+            }
+            return;
+        }
+
+        uint32_t requested = requested_.exchange(0, std::memory_order_acquire);
+        if (requested != 0) {
+            BeginCapture(static_cast<TriggerSource>(requested - 1), time);
+            return;
+        }
+
+        if (trigger_series_ >= 0) {
+            float value = devices_.GetValues()[trigger_series_];
+            bool crossed = trigger_above_ ? value > trigger_value_ : value < trigger_value_;
+            if (crossed && trigger_armed_) {
+                BeginCapture(TriggerSource::Threshold, time);
+            }
+            trigger_armed_ = !crossed;
+        }
+    }
+
+    void FlightRecorder::BeginCapture(TriggerSource source, std::chrono::steady_clock::time_point time) {
+        if (!spare_ready_) {
+            triggers_dropped_++;
+            return;
+        }
+
+        auto since_trigger = std::chrono::steady_clock::now() - time;
+        auto unix_now = std::chrono::system_clock::now().time_since_epoch();
+        pending_.trigger_time_us = std::chrono::duration_cast<std::chrono::microseconds>(time - epoch_).count();
+        pending_.trigger_unix_us = std::chrono::duration_cast<std::chrono::microseconds>(unix_now - since_trigger).count();
+        pending_.source = source;
+
+        capturing_ = true;
+        capturing_flag_ = true;
+        post_remaining_ = post_samples_;
+        if (post_remaining_ == 0) {
+            FreezeCapture();
+        }
+    }
+
+    void FlightRecorder::FreezeCapture() {
+        pending_.ring = active_;
+        pending_.count = stored_;
+        pending_.first_slot = stored_ < capacity_ ? 0 : next_slot_;
+        pending_.trigger_index = stored_ - 1 - post_samples_;
+
+        {
+            // The writer only holds the lock to swap pointers, never while writing
+            std::lock_guard<std::mutex> lock(mutex_);
+            active_ = spare_;
+            spare_ = nullptr;
+            capture_ = pending_;
+            has_capture_ = true;
+        }
+        spare_ready_ = false;
+        cv_.notify_one();
+
+        next_slot_ = 0;
+        stored_ = 0;
+        capturing_ = false;
+        capturing_flag_ = false;
+    }
+
+    void FlightRecorder::WriterLoop() {
+        AgentPolicy::ApplyToCurrentThread(ThreadRole::Worker);
+
+        for (;;) {
+            Capture capture;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this] { return !running_ || has_capture_; });
+                if (!has_capture_) break;
+                capture = capture_;
+                has_capture_ = false;
+            }
+
+            std::string path;
+            if (WriteCapture(capture, path)) {
+                captures_written_++;
+                std::cout << "Flight recorder: wrote " << capture.count << " samples ("
+                          << SourceName(capture.source) << " trigger) to " << path << std::endl;
+                PruneCaptures();
+            } else {
+                std::cerr << "Flight recorder: failed to write " << path << std::endl;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                spare_ = capture.ring;
+                if (!path.empty()) last_capture_ = path;
+            }
+            spare_ready_ = true;
+        }
+    }
+
+    bool FlightRecorder::WriteCapture(const Capture& capture, std::string& path) const {
+        std::time_t seconds = static_cast<std::time_t>(capture.trigger_unix_us / 1000000);
+        std::tm local = {};
+        localtime_s(&local, &seconds);
+        char name[64];
+        strftime(name, sizeof(name), "flight_%Y%m%d_%H%M%S", &local);
+
+        path = settings_.directory + "\\" + name + "_" + std::to_string(captures_written_.load() + 1) + ".pmfr";
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) return false;
+
+        out.write("PMFR", 4);
+        WriteValue<uint32_t>(out, kFormatVersion);
+        WriteValue<uint32_t>(out, static_cast<uint32_t>(series_count_));
+        WriteValue<uint32_t>(out, static_cast<uint32_t>(capture.count));
+        WriteValue<uint32_t>(out, static_cast<uint32_t>(capture.trigger_index));
+        WriteValue<uint32_t>(out, period_ms_ * 1000u);
+        WriteValue<int64_t>(out, capture.trigger_unix_us);
+        WriteValue<uint32_t>(out, static_cast<uint32_t>(capture.source));
+        WriteValue<uint32_t>(out, 0);
+
+        for (const std::string& series : devices_.GetSeriesNames()) {
+            WriteValue<uint16_t>(out, static_cast<uint16_t>(series.size()));
+            out.write(series.data(), static_cast<std::streamsize>(series.size()));
+        }
+
+        const Ring& ring = *capture.ring;
+        for (size_t i = 0; i < capture.count; ++i) {
+            size_t slot = (capture.first_slot + i) % capacity_;
+            WriteValue<int64_t>(out, ring.times_us[slot] - capture.trigger_time_us);
+            out.write(reinterpret_cast<const char*>(&ring.values[slot * series_count_]),
+                      static_cast<std::streamsize>(series_count_ * sizeof(float)));
+        }
+
+        return out.good();
+    }
+
+    // Deletes the oldest captures in the directory, earlier runs' included,
+    // until max_captures remain
+    void FlightRecorder::PruneCaptures() const {
+        if (settings_.max_captures == 0) return;
+
+        struct CaptureFile {
+            std::filesystem::path path;
+            std::filesystem::file_time_type written;
+        };
+        std::vector<CaptureFile> files;
+
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator(settings_.directory, ec)) {
+            const std::filesystem::path& file = entry.path();
+            if (file.extension() != ".pmfr" || file.filename().string().rfind("flight_", 0) != 0) continue;
+            if (!entry.is_regular_file(ec)) continue;
+            files.push_back({ file, entry.last_write_time(ec) });
+        }
+        if (files.size() <= settings_.max_captures) return;
+
+        std::sort(files.begin(), files.end(), [](const CaptureFile& a, const CaptureFile& b) {
+            return a.written < b.written;
+        });
+        for (size_t i = 0; i + settings_.max_captures < files.size(); ++i) {
+            if (!std::filesystem::remove(files[i].path, ec)) {
+                std::cerr << "Flight recorder: failed to delete " << files[i].path.string() << std::endl;
+            }
+        }
+    }
+
+    FlightRecorder::Status FlightRecorder::GetStatus() const {
+        Status status;
+        status.running = running_;
+        status.capturing = capturing_flag_;
+        status.series = series_count_;
+        status.period_ms = period_ms_;
+        status.captures_written = captures_written_;
+        status.triggers_dropped = triggers_dropped_;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            status.last_capture = last_capture_;
+        }
+        return status;
+    }
+
+    std::string FlightRecorder::GetStatusJson() const {
+        Status status = GetStatus();
+
+        std::string json = "{\"running\":";
+        json += status.running ? "true" : "false";
+        json += ",\"capturing\":";
+        json += status.capturing ? "true" : "false";
+        json += ",\"series\":" + std::to_string(status.series);
+        json += ",\"period_ms\":" + std::to_string(status.period_ms);
+        json += ",\"pre_seconds\":" + std::to_string(settings_.pre_seconds);
+        json += ",\"post_seconds\":" + std::to_string(settings_.post_seconds);
+        json += ",\"trigger\":" + JsonString(trigger_series_ >= 0 ? settings_.trigger : std::string());
+        json += ",\"max_captures\":" + std::to_string(settings_.max_captures);
+        json += ",\"captures_written\":" + std::to_string(status.captures_written);
+        json += ",\"triggers_dropped\":" + std::to_string(status.triggers_dropped);
+        json += ",\"last_capture\":" + JsonString(status.last_capture) + "}";
+        return json;
+    }
+
+}
@@ -0,0 +1,83 @@
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+
+#include <winsock2.h>
+
+#include "frame_sink.h"
+
+#pragma comment(lib, "ws2_32.lib")
+
+namespace PCMonitor {
+
+    FrameSink::FrameSink(SocketHandle socket, uint64_t since)
+        : socket_(socket)
+        , bytes_sent_(0)
+        , frame_version_(since)
+        , next_version_(0)
+    {
+    }
+
+    void FrameSink::MakeNonBlocking(SocketHandle socket) {
+        // Writes are non-blocking so one stalled client can't hold up the rest
+        u_long non_blocking = 1;
+        ioctlsocket(static_cast<SOCKET>(socket), FIONBIO, &non_blocking);
+    }
+
+    bool FrameSink::Queue(std::shared_ptr<const std::string> frame, uint64_t version) {
+        if (!frame) return false;
+
+        if (!frame_) {
+            frame_ = std::move(frame);
+            frame_version_ = version;
+            bytes_sent_ = 0;
+            return false;
+        }
+
+        // Still writing an older frame: keep only the newest one behind it
+        bool replaced = next_ != nullptr;
+        next_ = std::move(frame);
+        next_version_ = version;
+        return replaced;
+    }
+
+    bool FrameSink::Flush() {
+        SOCKET socket = static_cast<SOCKET>(socket_);
+
+        while (frame_) {
+            const std::string& frame = *frame_;
+            int remaining = static_cast<int>(frame.size() - bytes_sent_);
+            int sent = send(socket, frame.data() + bytes_sent_, remaining, 0);
+
+            if (sent == SOCKET_ERROR) {
+                return WSAGetLastError() == WSAEWOULDBLOCK;
+            }
+
+            bytes_sent_ += static_cast<size_t>(sent);
+            if (bytes_sent_ == frame.size()) {
+                frame_ = std::move(next_);
+                next_.reset();
+                bytes_sent_ = 0;
+                if (frame_) {
+                    frame_version_ = next_version_;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    void FrameSink::Close() {
+        if (IsOpen()) {
+            closesocket(static_cast<SOCKET>(socket_));
+            socket_ = static_cast<SocketHandle>(INVALID_SOCKET);
+        }
+        frame_.reset();
+        next_.reset();
+    }
+
+    bool FrameSink::IsOpen() const {
+        return socket_ != static_cast<SocketHandle>(INVALID_SOCKET);
+    }
+
+}
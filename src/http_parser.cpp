@@ -0,0 +1,266 @@
+#include "http_parser.h"
+#include <cstring>
+
+namespace PCMonitor {
+
+    namespace {
+
+        char ToLower(char c) {
+            return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+        }
+
+        std::string_view Trim(std::string_view text) {
+            size_t begin = 0;
+            size_t end = text.size();
+            while (begin < end && (text[begin] == ' ' || text[begin] == '\t')) ++begin;
+            while (end > begin && (text[end - 1] == ' ' || text[end - 1] == '\t')) --end;
+            return text.substr(begin, end - begin);
+        }
+
+        bool IsTokenChar(char c) {
+            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+                   std::strchr("!#$%&'*+-.^_`|~", c) != nullptr;
+        }
+
+        bool IsToken(std::string_view text) {
+            if (text.empty()) return false;
+            for (char c : text) {
+                if (!IsTokenChar(c)) return false;
+            }
+            return true;
+        }
+
+        // True if a comma-separated header value lists the token
+        bool HasToken(std::string_view list, std::string_view token) {
+            while (!list.empty()) {
+                size_t comma = list.find(',');
+                if (EqualsIgnoreCase(Trim(list.substr(0, comma)), token)) return true;
+                if (comma == std::string_view::npos) break;
+                list.remove_prefix(comma + 1);
+            }
+            return false;
+        }
+
+        // Splits off the next line, without its CRLF (or bare LF)
+        std::string_view NextLine(std::string_view& text) {
+            size_t newline = text.find('\n');
+            std::string_view line = text.substr(0, newline);
+            text.remove_prefix(newline == std::string_view::npos ? text.size() : newline + 1);
+            if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+            return line;
+        }
+
+    }
+
+    bool EqualsIgnoreCase(std::string_view a, std::string_view b) {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (ToLower(a[i]) != ToLower(b[i])) return false;
+        }
+        return true;
+    }
+
+    bool PercentDecode(std::string_view encoded, std::string& out) {
+        auto hex = [](char c) -> int {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+            return -1;
+        };
+
+        out.clear();
+        out.reserve(encoded.size());
+        for (size_t i = 0; i < encoded.size(); ++i) {
+            char c = encoded[i];
+            if (c == '+') {
+                out += ' ';
+            } else if (c == '%') {
+                if (i + 2 >= encoded.size()) return false;
+                int high = hex(encoded[i + 1]);
+                int low = hex(encoded[i + 2]);
+                if (high < 0 || low < 0) return false;
+                out += static_cast<char>(high * 16 + low);
+                i += 2;
+            } else {
+                out += c;
+            }
+        }
+        return true;
+    }
+
+    std::string_view HttpRequest::Header(std::string_view name) const {
+        for (size_t i = 0; i < header_count; ++i) {
+            if (EqualsIgnoreCase(headers[i].name, name)) return headers[i].value;
+        }
+        return std::string_view();
+    }
+
+    bool HttpRequest::QueryParam(std::string_view name, std::string_view& value) const {
+        std::string_view rest = query;
+        while (!rest.empty()) {
+            size_t amp = rest.find('&');
+            std::string_view pair = rest.substr(0, amp);
+            size_t equals = pair.find('=');
+
+            if (pair.substr(0, equals) == name) {
+                value = equals == std::string_view::npos ? std::string_view() : pair.substr(equals + 1);
+                return true;
+            }
+            if (amp == std::string_view::npos) break;
+            rest.remove_prefix(amp + 1);
+        }
+        return false;
+    }
+
+    HttpParser::HttpParser()
+        : scanned_(0)
+        , head_start_(0)
+    {
+    }
+
+    HttpParser::Result HttpParser::Parse(const char* data, size_t size, HttpRequest& request, size_t& consumed) {
+        consumed = 0;
+
+        // Look for the blank line ending the head, resuming where the last call stopped
+        size_t head_end = 0;
+        size_t pos = scanned_;
+        while (pos < size) {
+            const void* newline = std::memchr(data + pos, '\n', size - pos);
+            if (!newline) break;
+
+            size_t line_end = static_cast<const char*>(newline) - data;
+            bool blank = line_end == pos || (line_end == pos + 1 && data[pos] == '\r');
+            if (blank) {
+                if (pos == head_start_) {
+                    head_start_ = line_end + 1;  // Stray CRLF between requests: skip it
+                } else {
+                    head_end = line_end + 1;
+                    break;
+                }
+            }
+            pos = line_end + 1;
+        }
+
+        if (head_end == 0) {
+            scanned_ = pos;
+            return size >= kMaxHeaderBytes ? Result::TooLarge : Result::Incomplete;
+        }
+        if (head_end > kMaxHeaderBytes) {
+            Reset();
+            return Result::TooLarge;
+        }
+
+        Result result = ParseHead(data + head_start_, head_end - head_start_, request);
+        if (result != Result::Complete) {
+            Reset();
+            return result;
+        }
+
+        // Bodies are accepted (and skipped) only with an explicit length
+        if (!request.Header("Transfer-Encoding").empty()) {
+            Reset();
+            return Result::Invalid;
+        }
+
+        // One Content-Length of digits only: an empty, signed, listed or
+        // repeated one could frame the body differently than a proxy did
+        size_t body_length = 0;
+        bool have_length = false;
+        for (size_t i = 0; i < request.header_count; ++i) {
+            if (!EqualsIgnoreCase(request.headers[i].name, "Content-Length")) continue;
+
+            std::string_view length_header = request.headers[i].value;
+            if (have_length || length_header.empty()) {
+                Reset();
+                return Result::Invalid;
+            }
+            have_length = true;
+            for (char c : length_header) {
+                if (c < '0' || c > '9') {
+                    Reset();
+                    return Result::Invalid;
+                }
+                body_length = body_length * 10 + static_cast<size_t>(c - '0');
+                if (body_length > kMaxRequestBytes) {
+                    Reset();
+                    return Result::TooLarge;
+                }
+            }
+        }
+
+        if (head_end + body_length > kMaxRequestBytes) {
+            Reset();
+            return Result::TooLarge;
+        }
+        if (size < head_end + body_length) {
+            // Head is complete; resume at its blank line once the body arrives
+            scanned_ = pos;
+            return Result::Incomplete;
+        }
+
+        request.body = std::string_view(data + head_end, body_length);
+        consumed = head_end + body_length;
+        Reset();
+        return Result::Complete;
+    }
+
+    HttpParser::Result HttpParser::ParseHead(const char* data, size_t head_size, HttpRequest& request) {
+        std::string_view head(data, head_size);
+        request.header_count = 0;
+        request.body = std::string_view();
+
+        // Request line: method SP target SP version
+        std::string_view line = NextLine(head);
+        size_t first_space = line.find(' ');
+        size_t second_space = line.find(' ', first_space + 1);
+        if (first_space == std::string_view::npos || second_space == std::string_view::npos ||
+            line.find(' ', second_space + 1) != std::string_view::npos) {
+            return Result::Invalid;
+        }
+
+        request.method = line.substr(0, first_space);
+        request.target = line.substr(first_space + 1, second_space - first_space - 1);
+        request.version = line.substr(second_space + 1);
+
+        if (!IsToken(request.method) || request.target.empty() || request.target[0] != '/') {
+            return Result::Invalid;
+        }
+        if (request.version != "HTTP/1.1" && request.version != "HTTP/1.0") {
+            return Result::Invalid;
+        }
+
+        std::string_view target = request.target.substr(0, request.target.find('#'));
+        size_t question = target.find('?');
+        request.path = target.substr(0, question);
+        request.query = question == std::string_view::npos ? std::string_view() : target.substr(question + 1);
+
+        // Header lines until the blank line that ends the head
+        while (!head.empty()) {
+            line = NextLine(head);
+            if (line.empty()) break;
+
+            // Obsolete line folding is rejected rather than unfolded in place
+            if (line[0] == ' ' || line[0] == '\t') return Result::Invalid;
+
+            size_t colon = line.find(':');
+            if (colon == std::string_view::npos || !IsToken(line.substr(0, colon))) {
+                return Result::Invalid;
+            }
+            if (request.header_count == HttpRequest::kMaxHeaders) {
+                return Result::TooLarge;
+            }
+
+            HttpHeader& header = request.headers[request.header_count++];
+            header.name = line.substr(0, colon);
+            header.value = Trim(line.substr(colon + 1));
+        }
+
+        std::string_view connection = request.Header("Connection");
+        request.keep_alive = (request.version == "HTTP/1.1")
+            ? !HasToken(connection, "close")
+            : HasToken(connection, "keep-alive");
+
+        return Result::Complete;
+    }
+
+}
@@ -0,0 +1,178 @@
+#include "log_export.h"
+#include <fstream>
+#include <vector>
+#include <ctime>
+#include <cstdio>
+#include <memory>
+
+namespace PCMonitor {
+
+    namespace {
+
+        // Rows start with a local "YYYY-MM-DD HH:MM:SS" time, which sorts as text
+        constexpr size_t kTimestampLength = 19;
+
+        std::string FormatLocalTime(int64_t unix_seconds) {
+            std::time_t time = static_cast<std::time_t>(unix_seconds);
+            std::tm local = {};
+            localtime_s(&local, &time);
+
+            char buffer[32];
+            strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &local);
+            return buffer;
+        }
+
+        bool IsJsonNumber(const std::string& text) {
+            size_t i = (!text.empty() && text[0] == '-') ? 1 : 0;
+            bool digits = false;
+            bool dot = false;
+            for (; i < text.size(); ++i) {
+                if (text[i] >= '0' && text[i] <= '9') {
+                    digits = true;
+                } else if (text[i] == '.' && !dot && digits) {
+                    dot = true;
+                } else {
+                    return false;
+                }
+            }
+            return digits && text.back() != '.';
+        }
+
+        void AppendJsonString(std::string& out, const std::string& text) {
+            out += '"';
+            for (char c : text) {
+                if (c == '"' || c == '\\') {
+                    out += '\\';
+                    out += c;
+                } else if (static_cast<unsigned char>(c) < 0x20) {
+                    char escape[8];
+                    snprintf(escape, sizeof(escape), "\\u%04x", static_cast<unsigned>(c));
+                    out += escape;
+                } else {
+                    out += c;
+                }
+            }
+            out += '"';
+        }
+
+        void SplitColumns(const std::string& line, std::vector<std::string>& columns) {
+            columns.clear();
+            size_t start = 0;
+            for (;;) {
+                size_t comma = line.find(',', start);
+                columns.push_back(line.substr(start, comma - start));
+                if (comma == std::string::npos) break;
+                start = comma + 1;
+            }
+        }
+
+        // Walks the log file one row at a time, shared by both output formats
+        class LogRowReader {
+        private:
+            std::ifstream in_;
+            std::string from_;
+            std::string to_;
+
+        public:
+            std::string line;
+
+            LogRowReader(const std::string& path, ExportRange range)
+                : in_(path, std::ios::binary)
+            {
+                if (range.from > 0) from_ = FormatLocalTime(range.from);
+                if (range.to > 0) to_ = FormatLocalTime(range.to);
+            }
+
+            // Next header or in-range data row into line; false at end of file
+            bool Next(bool& is_header) {
+                while (in_.is_open() && std::getline(in_, line)) {
+                    if (!line.empty() && line.back() == '\r') line.pop_back();
+                    if (line.empty()) continue;
+
+                    is_header = line.compare(0, 10, "Timestamp,") == 0;
+                    if (is_header) return true;
+
+                    std::string stamp = line.substr(0, kTimestampLength);
+                    if (!from_.empty() && stamp < from_) continue;
+                    if (!to_.empty() && stamp > to_) continue;
+                    return true;
+                }
+                return false;
+            }
+        };
+
+    }
+
+    BodyGenerator MakeCsvExport(const std::string& log_path, ExportRange range) {
+        auto reader = std::make_shared<LogRowReader>(log_path, range);
+        auto header_sent = std::make_shared<bool>(false);
+
+        return [reader, header_sent](std::string& out) {
+            bool is_header = false;
+            while (out.size() < ChunkedResponder::kChunkBytes) {
+                if (!reader->Next(is_header)) return false;
+                if (is_header) {
+                    if (*header_sent) continue;
+                    *header_sent = true;
+                }
+                out += reader->line;
+                out += '\n';
+            }
+            return true;
+        };
+    }
+
+    BodyGenerator MakeJsonHistory(const std::string& log_path, ExportRange range) {
+        struct State {
+            LogRowReader reader;
+            std::vector<std::string> names;     // From the latest header row
+            std::vector<std::string> values;
+            bool started = false;
+            bool first_row = true;
+
+            State(const std::string& path, ExportRange range) : reader(path, range) {}
+        };
+        auto state = std::make_shared<State>(log_path, range);
+
+        return [state](std::string& out) {
+            if (!state->started) {
+                out += '[';
+                state->started = true;
+            }
+
+            bool is_header = false;
+            while (out.size() < ChunkedResponder::kChunkBytes) {
+                if (!state->reader.Next(is_header)) {
+                    out += "]";
+                    return false;
+                }
+
+                // Older runs may have logged different columns
+                if (is_header) {
+                    SplitColumns(state->reader.line, state->names);
+                    continue;
+                }
+
+                SplitColumns(state->reader.line, state->values);
+                out += state->first_row ? "\n{" : ",\n{";
+                state->first_row = false;
+
+                for (size_t i = 0; i < state->values.size(); ++i) {
+                    if (i > 0) out += ',';
+                    AppendJsonString(out, i < state->names.size() ? state->names[i] : "column_" + std::to_string(i));
+                    out += ':';
+                    if (i > 0 && IsJsonNumber(state->values[i])) {
+                        out += state->values[i];
+                    } else if (i > 0 && state->values[i].empty()) {
+                        out += "null";      // e.g. a fan column with no fan
+                    } else {
+                        AppendJsonString(out, state->values[i]);
+                    }
+                }
+                out += '}';
+            }
+            return true;
+        };
+    }
+
+}
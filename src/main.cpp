@@ -12,6 +12,30 @@
 
 // Now we can include other headers
 #include "performance_monitor.h"
+#include "metrics_stream.h"
+#include "snapshot_cache.h"
+#include "asset_cache.h"
+#include "binary_codec.h"
+#include "metrics_serializer.h"
+#include "prometheus_exporter.h"
+#include "http_parser.h"
+#include "metrics_projection.h"
+#include "snapshot_deltas.h"
+#include "subscription_manager.h"
+#include "shared_memory_publisher.h"
+#include "pcmonitor_shm.h"
+#include "chunked_response.h"
+#include "log_export.h"
+#include "agent_policy.h"
+#include "device_sampler.h"
+#include "flight_recorder.h"
+#include "anomaly_detector.h"
+#include "event_stream.h"
+#include "alert_engine.h"
+#include "alert_notifier.h"
+#include "window_stats.h"
+#include "correlation_matrix.h"
+#include "trend_forecaster.h"
 #include <iostream>
 #include <thread>
 #include <chrono>
@@ -20,11 +44,17 @@
 #include <fstream>
 #include <sstream>
 #include <atomic>
+#include <cstring>
+#include <charconv>
+#include <string_view>
+#include <vector>
+#include <memory>
 
 #pragma comment(lib, "ws2_32.lib")
 
 // Global variables
 PCMonitor::PerformanceMonitor* g_monitor = nullptr;
+PCMonitor::FlightRecorder* g_flight_recorder = nullptr;
 std::atomic<bool> g_web_server_running(false);
 
 // Signal handler for graceful shutdown (Ctrl+C)
@@ -38,89 +68,16 @@ void SignalHandler(int signal) {
     exit(0);
 }
 
-// Helper to format a double with 1 decimal place without ostringstream
-static std::string to_fixed1(double val) {
-    char buf[32];
-    snprintf(buf, sizeof(buf), "%.1f", val);
-    return buf;
+// Ctrl+Break: freeze the flight recorder (only flags the sampler thread)
+void FlightSignalHandler(int) {
+    if (g_flight_recorder) {
+        g_flight_recorder->RequestTrigger(PCMonitor::TriggerSource::Signal);
+    }
+    signal(SIGBREAK, FlightSignalHandler);
 }
 
-// Generate JSON response with current metrics
-std::string GenerateJsonResponse(const PCMonitor::PerformanceMonitor& monitor) {
-    const auto& gpu = monitor.GetGPUMetrics();
-    const auto& cpu = monitor.GetCPUMetrics();
-    const auto& ram = monitor.GetRAMMetrics();
-    const auto& storage = monitor.GetStorageMetrics();
-    const auto& network = monitor.GetNetworkMetrics();
-    const auto& power = monitor.GetPowerMetrics();
-    const auto& thermal = monitor.GetThermalMetrics();
-
-    std::string json;
-    json.reserve(2048);
-
-    json += "{\n";
-    json += "  \"timestamp\": " + std::to_string(std::time(nullptr)) + ",\n";
-    json += "  \"gpu\": {\n";
-    json += "    \"vram_used_mb\": " + std::to_string(gpu.vram_used_mb) + ",\n";
-    json += "    \"vram_total_mb\": " + std::to_string(gpu.vram_total_mb) + ",\n";
-    json += "    \"core_clock_mhz\": " + std::to_string(gpu.core_clock_mhz) + ",\n";
-    json += "    \"temperature_c\": " + std::to_string(gpu.temperature_c) + ",\n";
-    json += "    \"utilization_percent\": " + std::to_string(gpu.utilization_percent) + ",\n";
-    json += "    \"power_draw_w\": " + std::to_string(gpu.power_draw_w) + "\n";
-    json += "  },\n";
-    json += "  \"cpu\": {\n";
-    json += "    \"utilization_percent\": " + to_fixed1(cpu.utilization_percent) + ",\n";
-    json += "    \"temperature_c\": " + std::to_string(cpu.temperature_c) + ",\n";
-    json += "    \"current_clock_mhz\": " + std::to_string(cpu.current_clock_mhz) + ",\n";
-    json += "    \"core_count\": " + std::to_string(cpu.core_count) + ",\n";
-    json += "    \"thread_count\": " + std::to_string(cpu.thread_count) + "\n";
-    json += "  },\n";
-    json += "  \"ram\": {\n";
-    json += "    \"used_mb\": " + std::to_string(ram.used_mb) + ",\n";
-    json += "    \"total_mb\": " + std::to_string(ram.total_mb) + ",\n";
-    json += "    \"utilization_percent\": " + to_fixed1(ram.utilization_percent) + ",\n";
-    json += "    \"speed_mhz\": " + std::to_string(ram.speed_mhz) + "\n";
-    json += "  },\n";
-    json += "  \"storage\": {\n";
-    json += "    \"seq_read_mbps\": " + std::to_string(storage.seq_read_mbps) + ",\n";
-    json += "    \"seq_write_mbps\": " + std::to_string(storage.seq_write_mbps) + ",\n";
-    json += "    \"random_read_iops\": " + std::to_string(storage.random_read_iops) + ",\n";
-    json += "    \"random_write_iops\": " + std::to_string(storage.random_write_iops) + "\n";
-    json += "  },\n";
-    json += "  \"network\": {\n";
-    json += "    \"download_speed_kbps\": " + std::to_string(network.download_speed_kbps) + ",\n";
-    json += "    \"upload_speed_kbps\": " + std::to_string(network.upload_speed_kbps) + ",\n";
-    json += "    \"total_received_mb\": " + std::to_string(network.total_received_mb) + ",\n";
-    json += "    \"total_sent_mb\": " + std::to_string(network.total_sent_mb) + "\n";
-    json += "  },\n";
-    json += "  \"power\": {\n";
-    json += "    \"system_power_w\": " + std::to_string(power.system_power_w) + ",\n";
-    json += "    \"cpu_power_w\": " + std::to_string(power.cpu_power_w) + ",\n";
-    json += "    \"gpu_power_w\": " + std::to_string(power.gpu_power_w) + ",\n";
-    json += "    \"psu_wattage\": " + std::to_string(power.psu_wattage) + ",\n";
-    json += "    \"efficiency_percent\": " + to_fixed1(power.efficiency_percent) + "\n";
-    json += "  },\n";
-    json += "  \"thermal\": {\n";
-    json += "    \"cpu_temp_c\": " + std::to_string(thermal.cpu_temp_c) + ",\n";
-    json += "    \"gpu_temp_c\": " + std::to_string(thermal.gpu_temp_c) + ",\n";
-    json += "    \"case_temp_c\": " + std::to_string(thermal.case_temp_c) + ",\n";
-    json += "    \"fan_speeds_rpm\": [";
-    for (size_t i = 0; i < thermal.fan_speeds_rpm.size(); ++i) {
-        json += std::to_string(thermal.fan_speeds_rpm[i]);
-        if (i < thermal.fan_speeds_rpm.size() - 1) json += ",";
-    }
-    json += "]\n";
-    json += "  }\n";
-    json += "}";
-
-    return json;
-}
-
-// Read HTML file
-std::string ReadHTMLFile(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        return R"(<!DOCTYPE html>
+// Built-in page served when web/dashboard.html isn't available
+const char* const kFallbackDashboardHTML = R"(<!DOCTYPE html>
 <html>
 <head>
     <title>PC Monitor</title>
@@ -180,12 +137,6 @@ std::string ReadHTMLFile(const std::string& filename) {
     <div id="content">Loading...</div>
 </body>
 </html>)";
-    }
-    
-    std::ostringstream content;
-    content << file.rdbuf();
-    return content.str();
-}
 
 // Create HTTP response
 std::string CreateHTTPResponse(const std::string& content, const std::string& content_type = "text/html") {
@@ -201,24 +152,605 @@ std::string CreateHTTPResponse(const std::string& content, const std::string& co
     return response;
 }
 
-// Handle HTTP request
-std::string HandleRequest(const std::string& request, const PCMonitor::PerformanceMonitor& monitor) {
-    if (request.find("GET /api/metrics") != std::string::npos) {
-        std::string json = GenerateJsonResponse(monitor);
-        return CreateHTTPResponse(json, "application/json");
+// True unless the client omits gzip or explicitly refuses it with q=0
+bool AcceptsGzip(std::string_view accept_encoding) {
+    size_t pos = accept_encoding.find("gzip");
+    if (pos == std::string_view::npos) return false;
+
+    size_t end = accept_encoding.find(',', pos);
+    size_t q = accept_encoding.find("q=", pos);
+    if (q == std::string_view::npos || q > end) return true;
+
+    std::string_view weight = accept_encoding.substr(q + 2, end == std::string_view::npos ? end : end - q - 2);
+    return weight.find_first_not_of("0. ") != std::string_view::npos;
+}
+
+// True if an If-None-Match header value lists the tag (or is "*"). The list
+// may hold several tags, weak ones as W/"..."; used for snapshots and assets.
+bool MatchesETag(std::string_view if_none_match, const std::string& etag) {
+    return !if_none_match.empty() && (if_none_match == "*" || if_none_match.find(etag) != std::string_view::npos);
+}
+
+// Sends headers and body in one gathered write straight from the cached buffers
+void SendGathered(SOCKET socket, const std::string& head, const std::string& body) {
+    WSABUF buffers[2];
+    buffers[0].buf = const_cast<char*>(head.data());
+    buffers[0].len = static_cast<ULONG>(head.size());
+    buffers[1].buf = const_cast<char*>(body.data());
+    buffers[1].len = static_cast<ULONG>(body.size());
+
+    DWORD sent = 0;
+    WSASend(socket, buffers, body.empty() ? 1 : 2, &sent, 0, nullptr, nullptr);
+}
+
+void SendString(SOCKET socket, const std::string& response) {
+    send(socket, response.data(), static_cast<int>(response.length()), 0);
+}
+
+// Serve a file from the in-memory asset cache
+void ServeAsset(SOCKET socket, const PCMonitor::StaticAsset& asset, const PCMonitor::HttpRequest& request) {
+    int gzip = (!asset.gzip_body.empty() && AcceptsGzip(request.Header("Accept-Encoding"))) ? 1 : 0;
+
+    if (MatchesETag(request.Header("If-None-Match"), asset.etag[gzip])) {
+        SendString(socket, asset.not_modified[gzip]);
+        return;
     }
-    else if (request.find("GET / ") != std::string::npos || request.find("GET /index.html") != std::string::npos) {
-        std::string html = ReadHTMLFile("web/dashboard.html");
-        return CreateHTTPResponse(html, "text/html");
+
+    // Requests naming the current content hash may be cached forever
+    std::string_view version;
+    int immutable = (request.QueryParam("v", version) && version == asset.hash) ? 1 : 0;
+    SendGathered(socket, asset.headers[gzip][immutable], gzip ? asset.gzip_body : asset.body);
+}
+
+// Handle requests no route or asset claimed
+std::string HandleRequest(const PCMonitor::HttpRequest& request) {
+    if (request.path == "/" || request.path == "/index.html") {
+        return CreateHTTPResponse(kFallbackDashboardHTML, "text/html");
     }
     else {
-        std::string notFound = "<html><body><h1>404 Not Found</h1><p>Available endpoints:</p><ul><li><a href=\"/\">/</a> - Dashboard</li><li><a href=\"/api/metrics\">/api/metrics</a> - JSON API</li></ul></body></html>";
+        std::string notFound = "<html><body><h1>404 Not Found</h1><p>Available endpoints:</p><ul><li><a href=\"/\">/</a> - Dashboard</li><li><a href=\"/api/metrics\">/api/metrics</a> - JSON API</li><li><a href=\"/api/stream\">/api/stream</a> - Live stream (SSE)</li><li><a href=\"/api/metrics.bin\">/api/metrics.bin</a> - CBOR snapshot</li><li><a href=\"/api/stream.bin\">/api/stream.bin</a> - CBOR stream</li><li><a href=\"/api/schema\">/api/schema</a> - Binary layout</li><li><a href=\"/metrics\">/metrics</a> - Prometheus</li><li><a href=\"/api/history\">/api/history</a> - Logged history (JSON)</li><li><a href=\"/api/export.csv\">/api/export.csv</a> - Logged history (CSV)</li></ul></body></html>";
         return "HTTP/1.1 404 Not Found\r\nContent-Type: text/html\r\nContent-Length: " + std::to_string(notFound.length()) + "\r\n\r\n" + notFound;
     }
 }
 
+// Bodiless error response; the connection is closed after it
+std::string CreateErrorResponse(const char* status, const char* extra_headers = "") {
+    std::string response = "HTTP/1.1 ";
+    response += status;
+    response += "\r\nContent-Length: 0\r\nConnection: close\r\n";
+    response += extra_headers;
+    response += "\r\n";
+    return response;
+}
+
+// 400 with a one-line explanation for the client
+std::string CreateBadRequest(const std::string& message) {
+    std::string body = message + "\n";
+    return "HTTP/1.1 400 Bad Request\r\nContent-Type: text/plain\r\nContent-Length: " +
+           std::to_string(body.size()) + "\r\nAccess-Control-Allow-Origin: *\r\n\r\n" + body;
+}
+
+// Server-Sent Events handshake; the socket is then handed to the stream
+const char* const kStreamResponseHeaders =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/event-stream\r\n"
+    "Cache-Control: no-cache\r\n"
+    "Connection: keep-alive\r\n"
+    "Access-Control-Allow-Origin: *\r\n"
+    "\r\n"
+    "retry: 2000\n\n";
+
+// Binary stream: u32 little-endian length + CBOR payload per snapshot until close
+const char* const kBinaryStreamResponseHeaders =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: application/octet-stream\r\n"
+    "Cache-Control: no-cache\r\n"
+    "Connection: close\r\n"
+    "Access-Control-Allow-Origin: *\r\n"
+    "\r\n";
+
+// Everything the web server thread serves from
+struct WebServerContext {
+    const PCMonitor::PerformanceMonitor& monitor;
+    PCMonitor::PrometheusExporter& exporter;
+    PCMonitor::SnapshotCache& json_cache;
+    PCMonitor::SnapshotCache& binary_cache;
+    PCMonitor::SnapshotDeltas& deltas;
+    const PCMonitor::WindowStats& window_stats;
+    PCMonitor::MetricsStream& json_stream;
+    PCMonitor::MetricsStream& binary_stream;
+    PCMonitor::SubscriptionManager& subscriptions;
+    PCMonitor::ChunkedResponder& responder;
+    const PCMonitor::AssetCache& assets;
+    PCMonitor::FlightRecorder* flight_recorder;     // Null unless --flight-recorder
+    PCMonitor::AnomalyDetector* anomalies;          // Null unless --anomaly
+    const PCMonitor::CorrelationMatrix* correlations;   // Null unless --correlations
+    PCMonitor::AlertEngine* alerts;                 // Null unless --alerts
+    const PCMonitor::TrendForecaster* forecasts;    // Null unless --forecast
+    PCMonitor::AlertNotifier* notifier;             // Null without a webhook or command
+    PCMonitor::EventStream* events;                 // Null unless one of the above or --throttle-events
+    std::string schema_response;
+    std::string scrape_buffer;  // Reused across /metrics scrapes
+    PCMonitor::ProjectionCache projections;
+    std::string projection_buffer;
+};
+
+// What happened to the connection a request arrived on
+enum class RouteResult {
+    Served,     // Response sent; keep reading requests if the client allows
+    HandedOff   // Socket now belongs to a stream; stop touching it
+};
+
+// Serve the latest snapshot from prebuilt per-version buffers: no encoding or copying here
+void ServeSnapshot(SOCKET socket, PCMonitor::SnapshotCache& cache, const PCMonitor::HttpRequest& request) {
+    auto entry = cache.Get();
+    bool not_modified = MatchesETag(request.Header("If-None-Match"), entry->etag);
+    SendString(socket, not_modified ? entry->not_modified : entry->response);
+}
+
+// Hand a long-lived connection to a stream, which owns the socket from here
+RouteResult Subscribe(SOCKET socket, PCMonitor::MetricsStream& stream, const char* headers,
+                      bool deltas = false, uint64_t since = 0) {
+    send(socket, headers, static_cast<int>(strlen(headers)), 0);
+    stream.AddSubscriber(static_cast<PCMonitor::MetricsStream::SocketHandle>(socket), deltas, since);
+    return RouteResult::HandedOff;
+}
+
+// Snapshot version from a query parameter or header; 0 if absent or malformed
+uint64_t ParseVersion(std::string_view text) {
+    uint64_t version = 0;
+    auto result = std::from_chars(text.data(), text.data() + text.size(), version);
+    return (result.ec == std::errc() && result.ptr == text.data() + text.size()) ? version : 0;
+}
+
+// /api/metrics?fields=...: only the selected fields are written, through a
+// plan compiled once per distinct selection
+void ServeProjection(SOCKET socket, std::string_view fields, const PCMonitor::HttpRequest& request, WebServerContext& context) {
+    std::string error;
+    auto plan = context.projections.Get(fields, error);
+    if (!plan) {
+        SendString(socket, CreateBadRequest("Invalid fields parameter: " + error));
+        return;
+    }
+
+    // Same version, same selection (it's part of the URL): same tag
+    PCMonitor::MetricsSnapshot snapshot = context.monitor.GetSnapshot();
+    std::string etag = context.json_cache.MakeETag(snapshot.version);
+
+    bool not_modified = MatchesETag(request.Header("If-None-Match"), etag);
+    std::string headers = not_modified ? "HTTP/1.1 304 Not Modified\r\n" : "HTTP/1.1 200 OK\r\n";
+    headers += "Content-Type: application/json\r\n";
+    headers += "ETag: " + etag + "\r\n";
+    headers += "Access-Control-Allow-Origin: *\r\n";
+    headers += "Access-Control-Expose-Headers: ETag\r\n";
+    headers += "Cache-Control: no-cache\r\n";
+
+    if (not_modified) {
+        headers += "\r\n";
+        SendString(socket, headers);
+        return;
+    }
+
+    context.projection_buffer.clear();
+    plan->Write(snapshot, context.projection_buffer);
+    headers += "Content-Length: " + std::to_string(context.projection_buffer.size()) + "\r\n\r\n";
+    SendGathered(socket, headers, context.projection_buffer);
+}
+
+RouteResult RouteJsonMetrics(SOCKET socket, const PCMonitor::HttpRequest& request, WebServerContext& context) {
+    std::string_view fields, since;
+    if (request.QueryParam("fields", fields)) {
+        ServeProjection(socket, fields, request, context);
+    } else if (request.QueryParam("since", since)) {
+        // Changed fields only, or the full document if that version aged out
+        auto entry = context.deltas.Get(ParseVersion(since));
+        bool not_modified = MatchesETag(request.Header("If-None-Match"), entry->etag);
+        SendString(socket, not_modified ? entry->not_modified : entry->response);
+    } else {
+        ServeSnapshot(socket, context.json_cache, request);
+    }
+    return RouteResult::Served;
+}
+
+RouteResult RouteBinaryMetrics(SOCKET socket, const PCMonitor::HttpRequest& request, WebServerContext& context) {
+    ServeSnapshot(socket, context.binary_cache, request);
+    return RouteResult::Served;
+}
+
+// ?delta=1 streams changed fields only; a reconnecting EventSource resumes
+// from its Last-Event-ID (the snapshot version) instead of a full document
+RouteResult RouteJsonStream(SOCKET socket, const PCMonitor::HttpRequest& request, WebServerContext& context) {
+    std::string_view delta, since;
+    bool deltas = request.QueryParam("delta", delta) && delta != "0";
+    uint64_t base = request.QueryParam("since", since) ? ParseVersion(since) : ParseVersion(request.Header("Last-Event-ID"));
+    return Subscribe(socket, context.json_stream, kStreamResponseHeaders, deltas, base);
+}
+
+RouteResult RouteBinaryStream(SOCKET socket, const PCMonitor::HttpRequest&, WebServerContext& context) {
+    return Subscribe(socket, context.binary_stream, kBinaryStreamResponseHeaders);
+}
+
+// Per-client SSE subscription: ?fields= as for /api/metrics (default all)
+// and ?interval_ms= (default 1000). Identical subscriptions share encodings.
+RouteResult RouteSubscribe(SOCKET socket, const PCMonitor::HttpRequest& request, WebServerContext& context) {
+    std::string_view fields = "*";
+    request.QueryParam("fields", fields);
+
+    uint32_t interval_ms = 1000;
+    std::string_view interval;
+    if (request.QueryParam("interval_ms", interval)) {
+        auto result = std::from_chars(interval.data(), interval.data() + interval.size(), interval_ms);
+        if (result.ec != std::errc() || result.ptr != interval.data() + interval.size() ||
+            interval_ms < PCMonitor::SubscriptionManager::kMinIntervalMs ||
+            interval_ms > PCMonitor::SubscriptionManager::kMaxIntervalMs) {
+            SendString(socket, CreateBadRequest("Invalid interval_ms: expected " +
+                                                std::to_string(PCMonitor::SubscriptionManager::kMinIntervalMs) + " to " +
+                                                std::to_string(PCMonitor::SubscriptionManager::kMaxIntervalMs)));
+            return RouteResult::Served;
+        }
+    }
+
+    std::string error;
+    auto plan = context.projections.Get(fields, error);
+    if (!plan) {
+        SendString(socket, CreateBadRequest("Invalid fields parameter: " + error));
+        return RouteResult::Served;
+    }
+
+    send(socket, kStreamResponseHeaders, static_cast<int>(strlen(kStreamResponseHeaders)), 0);
+    context.subscriptions.Subscribe(static_cast<PCMonitor::SubscriptionManager::SocketHandle>(socket), std::move(plan), interval_ms);
+    return RouteResult::HandedOff;
+}
+
+RouteResult RouteSchema(SOCKET socket, const PCMonitor::HttpRequest&, WebServerContext& context) {
+    SendString(socket, context.schema_response);
+    return RouteResult::Served;
+}
+
+// Prometheus scrape: the exporter only rewrites numbers into its template
+RouteResult RoutePrometheus(SOCKET socket, const PCMonitor::HttpRequest&, WebServerContext& context) {
+    PCMonitor::ServerStats stats;
+    stats.stream_subscribers = context.json_stream.GetSubscriberCount() + context.binary_stream.GetSubscriberCount();
+    stats.subscriptions = context.subscriptions.GetSubscriberCount();
+    stats.subscription_groups = context.subscriptions.GetGroupCount();
+    stats.subscription_frames_encoded = context.subscriptions.GetFramesEncoded();
+    stats.subscription_frames_sent = context.subscriptions.GetFramesSent();
+    stats.snapshot_encodes = context.json_cache.GetEncodeCount() + context.binary_cache.GetEncodeCount();
+    stats.snapshot_cache_hits = context.json_cache.GetHitCount() + context.binary_cache.GetHitCount();
+
+    PCMonitor::AgentUsage usage = PCMonitor::AgentPolicy::ReadUsage();
+    stats.agent_cpu_user_seconds = usage.user_seconds;
+    stats.agent_cpu_kernel_seconds = usage.kernel_seconds;
+    stats.agent_context_switches = usage.context_switches;
+    stats.agent_working_set_bytes = usage.working_set_bytes;
+    stats.agent_memory_locked = usage.memory_locked ? 1 : 0;
+
+    if (context.anomalies) {
+        stats.anomaly_series = context.anomalies->GetSeriesCount();
+        stats.anomaly_evaluations = context.anomalies->GetEvaluations();
+        stats.anomaly_evaluation_seconds = context.anomalies->GetLastEvaluationSeconds();
+    }
+    if (context.correlations) {
+        stats.correlation_series = context.correlations->GetSeriesCount();
+        stats.correlation_updates = context.correlations->GetUpdates();
+        stats.correlation_update_seconds = context.correlations->GetLastUpdateSeconds();
+    }
+    if (context.alerts) {
+        stats.alert_rules = context.alerts->GetRuleCount();
+        stats.alerts_firing = context.alerts->GetFiringCount();
+        stats.alert_evaluations = context.alerts->GetEvaluations();
+        stats.alert_evaluation_seconds = context.alerts->GetLastEvaluationSeconds();
+    }
+    if (context.notifier) {
+        stats.alert_notifications = context.notifier->GetDelivered();
+        stats.alert_notifications_failed = context.notifier->GetFailed();
+    }
+    if (context.events) {
+        stats.events_logged = context.events->GetEventsLogged();
+        stats.event_subscribers = context.events->GetSubscriberCount();
+    }
+
+    context.exporter.Render(context.monitor.GetSnapshot(), context.monitor.GetCollectorLatencies(), stats, context.scrape_buffer);
+
+    std::string headers = "HTTP/1.1 200 OK\r\n";
+    headers += "Content-Type: ";
+    headers += PCMonitor::PrometheusExporter::ContentType();
+    headers += "\r\nContent-Length: " + std::to_string(context.scrape_buffer.size()) + "\r\n";
+    headers += "Cache-Control: no-cache\r\n\r\n";
+    SendGathered(socket, headers, context.scrape_buffer);
+    return RouteResult::Served;
+}
+
+// Generated bodies of unbounded size are streamed in chunks (gzipped if the
+// client accepts it) from the responder's thread, which owns the socket
+RouteResult SubmitGenerated(SOCKET socket, const PCMonitor::HttpRequest& request, WebServerContext& context,
+                            const char* content_type, const char* extra_headers, PCMonitor::BodyGenerator generator) {
+    bool chunked = request.version == "HTTP/1.1";
+    bool gzip = PCMonitor::ChunkedResponder::SupportsGzip() && AcceptsGzip(request.Header("Accept-Encoding"));
+
+    std::string headers = "HTTP/1.1 200 OK\r\n";
+    headers += "Content-Type: ";
+    headers += content_type;
+    headers += "\r\nAccess-Control-Allow-Origin: *\r\n";
+    headers += "Cache-Control: no-cache\r\n";
+    headers += "Vary: Accept-Encoding\r\n";
+    headers += extra_headers;
+
+    context.responder.Submit(static_cast<PCMonitor::ChunkedResponder::SocketHandle>(socket),
+                             std::move(headers), std::move(generator), chunked, gzip);
+    return RouteResult::HandedOff;
+}
+
+// ?from= and ?to= in Unix seconds; either may be omitted
+PCMonitor::ExportRange GetExportRange(const PCMonitor::HttpRequest& request) {
+    std::string_view from, to;
+    PCMonitor::ExportRange range{ 0, 0 };
+    if (request.QueryParam("from", from)) range.from = static_cast<int64_t>(ParseVersion(from));
+    if (request.QueryParam("to", to)) range.to = static_cast<int64_t>(ParseVersion(to));
+    return range;
+}
+
+RouteResult RouteHistory(SOCKET socket, const PCMonitor::HttpRequest& request, WebServerContext& context) {
+    return SubmitGenerated(socket, request, context, "application/json", "",
+                           PCMonitor::MakeJsonHistory(context.monitor.GetLogFile(), GetExportRange(request)));
+}
+
+RouteResult RouteExportCsv(SOCKET socket, const PCMonitor::HttpRequest& request, WebServerContext& context) {
+    return SubmitGenerated(socket, request, context, "text/csv; charset=utf-8",
+                           "Content-Disposition: attachment; filename=\"pc_monitor_log.csv\"\r\n",
+                           PCMonitor::MakeCsvExport(context.monitor.GetLogFile(), GetExportRange(request)));
+}
+
+// Percentiles over the sliding windows: ?window=1h&series=cpu,ram.used_mb&q=0.5,0.99
+RouteResult RouteStats(SOCKET socket, const PCMonitor::HttpRequest& request, WebServerContext& context) {
+    std::string filters[3];
+    const char* const names[3] = { "window", "series", "q" };
+    for (size_t i = 0; i < 3; ++i) {
+        std::string_view raw;
+        if (request.QueryParam(names[i], raw) && !PCMonitor::PercentDecode(raw, filters[i])) {
+            SendString(socket, CreateBadRequest(std::string("Malformed ") + names[i] + " parameter"));
+            return RouteResult::Served;
+        }
+    }
+
+    std::string json;
+    std::string error;
+    if (!context.window_stats.AppendJson(filters[0], filters[1], filters[2], json, error)) {
+        SendString(socket, CreateBadRequest("Invalid stats query: " + error));
+        return RouteResult::Served;
+    }
+    SendString(socket, CreateHTTPResponse(json, "application/json"));
+    return RouteResult::Served;
+}
+
+// Most correlated pairs over the window: ?series=storage,thermal.cpu_temp_c&top=10
+RouteResult RouteCorrelations(SOCKET socket, const PCMonitor::HttpRequest& request, WebServerContext& context) {
+    if (!context.correlations) {
+        SendString(socket, CreateErrorResponse("404 Not Found"));
+        return RouteResult::Served;
+    }
+
+    std::string filters[2];
+    const char* const names[2] = { "series", "top" };
+    for (size_t i = 0; i < 2; ++i) {
+        std::string_view raw;
+        if (request.QueryParam(names[i], raw) && !PCMonitor::PercentDecode(raw, filters[i])) {
+            SendString(socket, CreateBadRequest(std::string("Malformed ") + names[i] + " parameter"));
+            return RouteResult::Served;
+        }
+    }
+
+    std::string json;
+    std::string error;
+    if (!context.correlations->AppendJson(filters[0], filters[1], json, error)) {
+        SendString(socket, CreateBadRequest("Invalid correlations query: " + error));
+        return RouteResult::Served;
+    }
+    SendString(socket, CreateHTTPResponse(json, "application/json"));
+    return RouteResult::Served;
+}
+
+RouteResult RouteFlightRecorder(SOCKET socket, const PCMonitor::HttpRequest&, WebServerContext& context) {
+    if (!context.flight_recorder) {
+        SendString(socket, CreateErrorResponse("404 Not Found"));
+        return RouteResult::Served;
+    }
+    SendString(socket, CreateHTTPResponse(context.flight_recorder->GetStatusJson(), "application/json"));
+    return RouteResult::Served;
+}
+
+// Browsers send Origin with every POST, so a page from another site can't
+// trigger writes; clients without one (curl, scripts) aren't browsers
+bool IsSameOrigin(const PCMonitor::HttpRequest& request) {
+    std::string_view origin = request.Header("Origin");
+    if (origin.empty()) return true;
+
+    size_t scheme = origin.find("://");
+    return scheme != std::string_view::npos &&
+           PCMonitor::EqualsIgnoreCase(origin.substr(scheme + 3), request.Header("Host"));
+}
+
+// Freezes the ring; the capture is written once the post-trigger window has been recorded
+RouteResult RouteFlightTrigger(SOCKET socket, const PCMonitor::HttpRequest& request, WebServerContext& context) {
+    if (!context.flight_recorder) {
+        SendString(socket, CreateErrorResponse("404 Not Found"));
+        return RouteResult::Served;
+    }
+    if (!IsSameOrigin(request)) {
+        SendString(socket, CreateErrorResponse("403 Forbidden"));
+        return RouteResult::Served;
+    }
+
+    using TriggerResult = PCMonitor::FlightRecorder::TriggerResult;
+    TriggerResult result = context.flight_recorder->RequestTrigger(PCMonitor::TriggerSource::Api);
+    if (result == TriggerResult::Busy) {
+        SendString(socket, CreateErrorResponse("409 Conflict"));
+        return RouteResult::Served;
+    }
+    if (result == TriggerResult::RateLimited) {
+        std::string retry = "Retry-After: " + std::to_string(PCMonitor::FlightRecorder::kApiTriggerIntervalSeconds) + "\r\n";
+        SendString(socket, CreateErrorResponse("429 Too Many Requests", retry.c_str()));
+        return RouteResult::Served;
+    }
+
+    std::string body = context.flight_recorder->GetStatusJson();
+    std::string response = "HTTP/1.1 202 Accepted\r\nContent-Type: application/json\r\nContent-Length: " +
+                           std::to_string(body.size()) + "\r\n\r\n" + body;
+    SendString(socket, response);
+    return RouteResult::Served;
+}
+
+RouteResult RouteAlerts(SOCKET socket, const PCMonitor::HttpRequest&, WebServerContext& context) {
+    if (!context.alerts) {
+        SendString(socket, CreateErrorResponse("404 Not Found"));
+        return RouteResult::Served;
+    }
+    SendString(socket, CreateHTTPResponse(context.alerts->GetStatusJson(), "application/json"));
+    return RouteResult::Served;
+}
+
+RouteResult RouteForecasts(SOCKET socket, const PCMonitor::HttpRequest&, WebServerContext& context) {
+    if (!context.forecasts) {
+        SendString(socket, CreateErrorResponse("404 Not Found"));
+        return RouteResult::Served;
+    }
+    SendString(socket, CreateHTTPResponse(context.forecasts->GetStatusJson(), "application/json"));
+    return RouteResult::Served;
+}
+
+// Throttling, anomaly, alert and forecast events as Server-Sent Events: live by default, or everything retained
+// after ?since=<id> / Last-Event-ID
+RouteResult RouteEvents(SOCKET socket, const PCMonitor::HttpRequest& request, WebServerContext& context) {
+    if (!context.events) {
+        SendString(socket, CreateErrorResponse("404 Not Found"));
+        return RouteResult::Served;
+    }
+
+    std::string_view since;
+    uint64_t base = UINT64_MAX;
+    if (request.QueryParam("since", since)) {
+        base = ParseVersion(since);
+    } else if (!request.Header("Last-Event-ID").empty()) {
+        base = ParseVersion(request.Header("Last-Event-ID"));
+    }
+
+    send(socket, kStreamResponseHeaders, static_cast<int>(strlen(kStreamResponseHeaders)), 0);
+    context.events->AddSubscriber(static_cast<PCMonitor::FrameSink::SocketHandle>(socket), base);
+    return RouteResult::HandedOff;
+}
+
+// Exact-path routes; anything else falls through to the asset cache
+struct Route {
+    std::string_view path;
+    RouteResult (*handler)(SOCKET, const PCMonitor::HttpRequest&, WebServerContext&);
+    std::string_view method = "GET";
+};
+
+const Route kRoutes[] = {
+    { "/api/metrics", RouteJsonMetrics },
+    { "/api/metrics.bin", RouteBinaryMetrics },
+    { "/api/stream", RouteJsonStream },
+    { "/api/stream.bin", RouteBinaryStream },
+    { "/api/subscribe", RouteSubscribe },
+    { "/api/schema", RouteSchema },
+    { "/metrics", RoutePrometheus },
+    { "/api/history", RouteHistory },
+    { "/api/export.csv", RouteExportCsv },
+    { "/api/stats", RouteStats },
+    { "/api/correlations", RouteCorrelations },
+    { "/api/events", RouteEvents },
+    { "/api/alerts", RouteAlerts },
+    { "/api/forecasts", RouteForecasts },
+    { "/api/flight-recorder", RouteFlightRecorder },
+    { "/api/flight-recorder/trigger", RouteFlightTrigger, "POST" },
+};
+
+RouteResult Dispatch(SOCKET socket, const PCMonitor::HttpRequest& request, WebServerContext& context) {
+    for (const Route& route : kRoutes) {
+        if (route.path == request.path) {
+            if (request.method != route.method) {
+                std::string allow = "Allow: " + std::string(route.method) + "\r\n";
+                SendString(socket, CreateErrorResponse("405 Method Not Allowed", allow.c_str()));
+                return RouteResult::Served;
+            }
+            return route.handler(socket, request, context);
+        }
+    }
+
+    if (request.method != "GET") {
+        SendString(socket, CreateErrorResponse("405 Method Not Allowed", "Allow: GET\r\n"));
+        return RouteResult::Served;
+    }
+
+    auto asset = context.assets.Find(std::string(request.path));
+    if (asset) {
+        ServeAsset(socket, *asset, request);
+    } else {
+        SendString(socket, HandleRequest(request));
+    }
+    return RouteResult::Served;
+}
+
+// A keep-alive client and whatever part of its next request has arrived
+struct ClientConnection {
+    SOCKET socket;
+    char buffer[PCMonitor::HttpParser::kMaxRequestBytes];
+    size_t size;
+    PCMonitor::HttpParser parser;
+    std::chrono::steady_clock::time_point last_activity;
+};
+
+const auto kIdleConnectionTimeout = std::chrono::seconds(30);
+
+// Reads what's available and serves every complete request in it, in order.
+// Returns false once the connection is finished (closed or handed off).
+bool ServiceConnection(ClientConnection& connection, WebServerContext& context) {
+    int received = recv(connection.socket, connection.buffer + connection.size,
+                        static_cast<int>(sizeof(connection.buffer) - connection.size), 0);
+    if (received <= 0) {
+        closesocket(connection.socket);
+        return false;
+    }
+    connection.size += static_cast<size_t>(received);
+    connection.last_activity = std::chrono::steady_clock::now();
+
+    // Requests are parsed in place; views stay valid until the buffer is compacted below
+    size_t offset = 0;
+    for (;;) {
+        PCMonitor::HttpRequest request;
+        size_t consumed = 0;
+        auto result = connection.parser.Parse(connection.buffer + offset, connection.size - offset, request, consumed);
+
+        if (result == PCMonitor::HttpParser::Result::Incomplete) break;
+        if (result != PCMonitor::HttpParser::Result::Complete) {
+            SendString(connection.socket, CreateErrorResponse(result == PCMonitor::HttpParser::Result::TooLarge
+                ? "431 Request Header Fields Too Large" : "400 Bad Request"));
+            closesocket(connection.socket);
+            return false;
+        }
+        offset += consumed;
+
+        if (Dispatch(connection.socket, request, context) == RouteResult::HandedOff) {
+            return false;
+        }
+        if (!request.keep_alive) {
+            closesocket(connection.socket);
+            return false;
+        }
+    }
+
+    // Keep the partial next request at the front of the buffer
+    if (offset > 0) {
+        memmove(connection.buffer, connection.buffer + offset, connection.size - offset);
+        connection.size -= offset;
+    }
+    return true;
+}
+
 // Web server thread function
-void WebServerLoop(const PCMonitor::PerformanceMonitor& monitor, int port) {
+void WebServerLoop(WebServerContext& context, int port) {
+    PCMonitor::AgentPolicy::ApplyToCurrentThread(PCMonitor::ThreadRole::Worker);
+
     WSADATA wsaData;
     if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
         std::cerr << "❌ WSAStartup failed" << std::endl;
@@ -259,12 +791,23 @@ void WebServerLoop(const PCMonitor::PerformanceMonitor& monitor, int port) {
     std::cout << "🌐 Web server started successfully!" << std::endl;
     std::cout << "🔗 Dashboard: http://localhost:" << port << std::endl;
     std::cout << "📊 API: http://localhost:" << port << "/api/metrics" << std::endl;
+    std::cout << "📡 Stream: http://localhost:" << port << "/api/stream" << std::endl;
+    std::cout << "📈 Prometheus: http://localhost:" << port << "/metrics" << std::endl;
     std::cout << std::endl;
+
+    // select() watches the listener plus every open keep-alive connection
+    const size_t max_connections = FD_SETSIZE - 1;
+    std::vector<std::unique_ptr<ClientConnection>> connections;
     
     while (g_web_server_running) {
         fd_set readfds;
         FD_ZERO(&readfds);
-        FD_SET(serverSocket, &readfds);
+        if (connections.size() < max_connections) {
+            FD_SET(serverSocket, &readfds);
+        }
+        for (const auto& connection : connections) {
+            FD_SET(connection->socket, &readfds);
+        }
         
         timeval timeout = {};
         timeout.tv_sec = 1;
@@ -275,25 +818,58 @@ void WebServerLoop(const PCMonitor::PerformanceMonitor& monitor, int port) {
         if (activity > 0 && FD_ISSET(serverSocket, &readfds)) {
             SOCKET clientSocket = accept(serverSocket, nullptr, nullptr);
             if (clientSocket != INVALID_SOCKET) {
-                char buffer[4096];
-                int bytesReceived = recv(clientSocket, buffer, sizeof(buffer) - 1, 0);
-                
-                if (bytesReceived > 0) {
-                    buffer[bytesReceived] = '\0';
-                    std::string request(buffer);
-                    std::string response = HandleRequest(request, monitor);
-                    send(clientSocket, response.c_str(), static_cast<int>(response.length()), 0);
-                }
-                
-                closesocket(clientSocket);
+                auto connection = std::make_unique<ClientConnection>();
+                connection->socket = clientSocket;
+                connection->size = 0;
+                connection->last_activity = std::chrono::steady_clock::now();
+                connections.push_back(std::move(connection));
+            }
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < connections.size();) {
+            ClientConnection& connection = *connections[i];
+            bool open = true;
+
+            if (activity > 0 && FD_ISSET(connection.socket, &readfds)) {
+                open = ServiceConnection(connection, context);
+            } else if (now - connection.last_activity > kIdleConnectionTimeout) {
+                closesocket(connection.socket);
+                open = false;
+            }
+
+            if (open) {
+                ++i;
+            } else {
+                connections[i] = std::move(connections.back());
+                connections.pop_back();
             }
         }
     }
-    
+
+    for (const auto& connection : connections) {
+        closesocket(connection->socket);
+    }
     closesocket(serverSocket);
     WSACleanup();
 }
 
+// --lock-memory: wait until a couple of snapshots have been published, so
+// the sampler, logger and caches have allocated and touched their buffers,
+// then pin what is resident
+void LockMemoryWhenWarm(PCMonitor::PerformanceMonitor& monitor) {
+    for (int waited_ms = 0; monitor.GetSnapshotVersion() < 2 && waited_ms < 30000; waited_ms += 50) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+
+    if (PCMonitor::AgentPolicy::LockWorkingSet()) {
+        std::cout << "🔒 Working set locked ("
+                  << PCMonitor::AgentPolicy::ReadUsage().working_set_bytes / (1024 * 1024) << " MB)" << std::endl;
+    } else {
+        std::cout << "⚠️  Could not lock the working set (needs the increase-working-set privilege)" << std::endl;
+    }
+}
+
 // Display usage information
 void ShowUsage(const char* program_name) {
     std::cout << "PC Performance Monitor v1.0\n\n";
@@ -301,7 +877,57 @@ void ShowUsage(const char* program_name) {
     std::cout << "Options:\n";
     std::cout << "  -w, --web         Enable web server mode\n";
     std::cout << "  -p, --port <num>  Web server port (default: 8080)\n";
+    std::cout << "  -r, --rate <ms>   Collection interval in milliseconds (default: 1000)\n";
+    std::cout << "  -b, --burst <ms>  Sample CPU, disk and network this often within each interval\n";
+    std::cout << "                    and report mean/min/max/p99 (e.g. 20; default: off)\n";
     std::cout << "  -i, --interactive Interactive console mode (default if no -w)\n";
+    std::cout << "  -d, --dev         Reload web assets when files change, disable long caching\n";
+    std::cout << "      --no-shm      Don't publish snapshots to shared memory\n";
+    std::cout << "      --power-model <file> Where the calibrated power model is kept\n";
+    std::cout << "                    (default: pc_monitor_power_model.txt)\n";
+    std::cout << "      --throttle-events Publish per-core throttling episodes\n";
+    std::cout << "                    (/api/events, pc_monitor_events.log)\n";
+    std::cout << "\nRecord and replay options:\n";
+    std::cout << "      --record <file>        Record every collector input and burst sample (.pmrec)\n";
+    std::cout << "      --replay <file>        Run the pipeline from a recording instead of this machine\n";
+    std::cout << "      --replay-speed <x>     1 keeps the recorded pace (default), 100 is 100x faster,\n";
+    std::cout << "                             0 as fast as possible\n";
+    std::cout << "\nAnomaly detection options:\n";
+    std::cout << "      --anomaly              Flag unusual values of every metric and device series\n";
+    std::cout << "                             (/api/events, pc_monitor_events.log)\n";
+    std::cout << "      --anomaly-z <z>        Deviations from the baseline that count (default: 4)\n";
+    std::cout << "      --anomaly-season <s>   Learn a baseline per phase of this period, e.g. 86400\n";
+    std::cout << "\nCorrelation options:\n";
+    std::cout << "      --correlations         Track which metric and device series move together\n";
+    std::cout << "                             (/api/correlations)\n";
+    std::cout << "      --correlation-window <s> Seconds each correlation covers (default: 300)\n";
+    std::cout << "\nAlert options:\n";
+    std::cout << "      --alerts <file>        Load alert rules, one per line, e.g.\n";
+    std::cout << "                             hot: cpu.temperature_c > 90 for 30s\n";
+    std::cout << "      --alert-webhook <url>  POST alert changes to an http:// URL\n";
+    std::cout << "      --alert-command <cmd>  Run a command on alert changes ({rule} {state} {value} {json})\n";
+    std::cout << "\nForecast options:\n";
+    std::cout << "      --forecast             Predict when memory, disk space and temperatures reach their limits\n";
+    std::cout << "                             (/api/forecasts, forecast events)\n";
+    std::cout << "      --forecast-window <s>  Seconds of history the trends are fitted to (default: 600)\n";
+    std::cout << "      --forecast-horizon <s> Raise an event when a limit is this close (default: 3600)\n";
+    std::cout << "      --forecast-limit <series=limit> Set or add a limit, e.g. cpu.temperature_c=100\n";
+    std::cout << "\nFlight recorder options:\n";
+    std::cout << "      --flight-recorder <s>  Keep the last <s> seconds of per-core/per-device samples\n";
+    std::cout << "                             (implies --burst 20 unless set)\n";
+    std::cout << "      --flight-post <s>      Seconds recorded after a trigger (default: 5)\n";
+    std::cout << "      --flight-trigger <expr> Capture when a series crosses a value, e.g. \"cpu.total>95\"\n";
+    std::cout << "      --flight-dir <path>    Where captures are written (default: .)\n";
+    std::cout << "      --flight-keep <n>      Delete the oldest captures beyond <n> (default: 20, 0 keeps all)\n";
+    std::cout << "                             Ctrl+Break or POST /api/flight-recorder/trigger also capture\n";
+    std::cout << "                             (the POST at most once per 30 s)\n";
+    std::cout << "\nLow-impact agent options:\n";
+    std::cout << "      --sampler-cpus <list>  Pin the sampler thread, e.g. 3 or 0x8\n";
+    std::cout << "      --worker-cpus <list>   Pin logging, web and streaming threads, e.g. 2-3\n";
+    std::cout << "      --priority <level>     Worker thread priority: normal, low or idle\n";
+    std::cout << "      --realtime-sampler     Run the sampler at time-critical priority\n";
+    std::cout << "      --lock-memory          Keep the working set resident once warmed up\n";
+    std::cout << "      --low-impact           Same as --priority idle --lock-memory\n";
     std::cout << "  -h, --help        Show this help\n\n";
     std::cout << "Examples:\n";
     std::cout << "  " << program_name << "              # Interactive console mode\n";
@@ -312,7 +938,28 @@ void ShowUsage(const char* program_name) {
 // Main function
 int main(int argc, char* argv[]) {
     bool enable_web_server = false;
+    bool dev_mode = false;
+    bool enable_shared_memory = true;
     int web_port = 8080;
+    int collection_interval_ms = 1000;
+    int burst_interval_ms = 0;
+    PCMonitor::AgentSettings agent;
+    int flight_seconds = 0;
+    PCMonitor::FlightRecorder::Settings flight;
+    bool enable_throttle_events = false;
+    bool enable_anomalies = false;
+    PCMonitor::AnomalyDetector::Settings anomaly;
+    bool enable_correlations = false;
+    int correlation_seconds = 300;
+    std::string alerts_path;
+    PCMonitor::AlertNotifier::Settings notify;
+    bool enable_forecasts = false;
+    PCMonitor::TrendForecaster::Settings forecast;
+    std::vector<std::string> forecast_limits;
+    std::string power_model_path;
+    std::string record_path;
+    std::string replay_path;
+    double replay_speed = 1.0;
     
     // Parse command line arguments
     for (int i = 1; i < argc; ++i) {
@@ -325,21 +972,189 @@ int main(int argc, char* argv[]) {
                 web_port = std::atoi(argv[++i]);
             }
         }
+        else if (arg == "--rate" || arg == "-r") {
+            if (i + 1 < argc) {
+                collection_interval_ms = std::atoi(argv[++i]);
+                if (collection_interval_ms < 50) collection_interval_ms = 50;
+            }
+        }
+        else if (arg == "--burst" || arg == "-b") {
+            if (i + 1 < argc) {
+                burst_interval_ms = std::atoi(argv[++i]);
+                if (burst_interval_ms < 5) burst_interval_ms = 5;
+            }
+        }
+        else if (arg == "--flight-recorder" || arg == "--flight-post") {
+            int seconds = i + 1 < argc ? std::atoi(argv[++i]) : 0;
+            if (seconds <= 0) {
+                std::cerr << "❌ " << arg << " expects a number of seconds" << std::endl;
+                return 1;
+            }
+            if (arg == "--flight-recorder") flight_seconds = seconds;
+            else flight.post_seconds = static_cast<uint32_t>(seconds);
+        }
+        else if (arg == "--throttle-events") {
+            enable_throttle_events = true;
+        }
+        else if (arg == "--anomaly") {
+            enable_anomalies = true;
+        }
+        else if (arg == "--anomaly-z") {
+            if (i + 1 < argc) anomaly.z_threshold = std::atof(argv[++i]);
+            if (anomaly.z_threshold <= 0.0) {
+                std::cerr << "❌ --anomaly-z expects a positive number" << std::endl;
+                return 1;
+            }
+            enable_anomalies = true;
+        }
+        else if (arg == "--anomaly-season") {
+            int seconds = i + 1 < argc ? std::atoi(argv[++i]) : 0;
+            if (seconds < static_cast<int>(PCMonitor::AnomalyDetector::kSeasonBuckets)) {
+                std::cerr << "❌ --anomaly-season expects a period in seconds, e.g. 86400" << std::endl;
+                return 1;
+            }
+            anomaly.season_seconds = static_cast<uint32_t>(seconds);
+            enable_anomalies = true;
+        }
+        else if (arg == "--correlations") {
+            enable_correlations = true;
+        }
+        else if (arg == "--correlation-window") {
+            correlation_seconds = i + 1 < argc ? std::atoi(argv[++i]) : 0;
+            if (correlation_seconds <= 0) {
+                std::cerr << "❌ --correlation-window expects a number of seconds" << std::endl;
+                return 1;
+            }
+            enable_correlations = true;
+        }
+        else if (arg == "--alerts") {
+            if (i + 1 < argc) alerts_path = argv[++i];
+        }
+        else if (arg == "--alert-webhook") {
+            if (i + 1 < argc) notify.webhook_url = argv[++i];
+        }
+        else if (arg == "--alert-command") {
+            if (i + 1 < argc) notify.command = argv[++i];
+        }
+        else if (arg == "--forecast") {
+            enable_forecasts = true;
+        }
+        else if (arg == "--forecast-window" || arg == "--forecast-horizon") {
+            int seconds = i + 1 < argc ? std::atoi(argv[++i]) : 0;
+            if (seconds <= 0) {
+                std::cerr << "❌ " << arg << " expects a number of seconds" << std::endl;
+                return 1;
+            }
+            if (arg == "--forecast-window") forecast.window_seconds = static_cast<uint32_t>(seconds);
+            else forecast.horizon_seconds = static_cast<uint32_t>(seconds);
+            enable_forecasts = true;
+        }
+        else if (arg == "--forecast-limit") {
+            if (i + 1 < argc) forecast_limits.push_back(argv[++i]);
+            enable_forecasts = true;
+        }
+        else if (arg == "--flight-trigger") {
+            if (i + 1 < argc) flight.trigger = argv[++i];
+        }
+        else if (arg == "--flight-dir") {
+            if (i + 1 < argc) flight.directory = argv[++i];
+        }
+        else if (arg == "--flight-keep") {
+            int keep = i + 1 < argc ? std::atoi(argv[++i]) : -1;
+            if (keep < 0) {
+                std::cerr << "❌ --flight-keep expects a number of captures (0 keeps all)" << std::endl;
+                return 1;
+            }
+            flight.max_captures = static_cast<uint32_t>(keep);
+        }
+        else if (arg == "--dev" || arg == "-d") {
+            dev_mode = true;
+        }
+        else if (arg == "--no-shm") {
+            enable_shared_memory = false;
+        }
+        else if (arg == "--power-model") {
+            if (i + 1 < argc) power_model_path = argv[++i];
+        }
+        else if (arg == "--record") {
+            if (i + 1 < argc) record_path = argv[++i];
+        }
+        else if (arg == "--replay") {
+            if (i + 1 < argc) replay_path = argv[++i];
+        }
+        else if (arg == "--replay-speed") {
+            replay_speed = i + 1 < argc ? std::atof(argv[++i]) : -1.0;
+            if (replay_speed < 0.0) {
+                std::cerr << "❌ --replay-speed expects a factor such as 1, 100 or 0 (as fast as possible)" << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--sampler-cpus" || arg == "--worker-cpus") {
+            uint64_t& mask = arg == "--sampler-cpus" ? agent.sampler_cpus : agent.worker_cpus;
+            if (i + 1 >= argc || !PCMonitor::AgentPolicy::ParseCpuList(argv[++i], mask)) {
+                std::cerr << "❌ " << arg << " expects a CPU list such as 0,2-3 or a mask such as 0xC" << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--priority") {
+            std::string level = i + 1 < argc ? argv[++i] : "";
+            if (level == "normal") agent.worker_priority = PCMonitor::WorkerPriority::Normal;
+            else if (level == "low") agent.worker_priority = PCMonitor::WorkerPriority::Low;
+            else if (level == "idle") agent.worker_priority = PCMonitor::WorkerPriority::Idle;
+            else {
+                std::cerr << "❌ --priority expects normal, low or idle" << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--realtime-sampler") {
+            agent.realtime_sampler = true;
+        }
+        else if (arg == "--lock-memory") {
+            agent.lock_memory = true;
+        }
+        else if (arg == "--low-impact") {
+            agent.worker_priority = PCMonitor::WorkerPriority::Idle;
+            agent.lock_memory = true;
+        }
         else if (arg == "--help" || arg == "-h") {
             ShowUsage(argv[0]);
             return 0;
         }
     }
+
+    if (!record_path.empty() && !replay_path.empty()) {
+        std::cerr << "❌ --record and --replay can't be combined" << std::endl;
+        return 1;
+    }
     
     std::cout << "========================================" << std::endl;
     std::cout << "    PC Performance Monitor v1.0        " << std::endl;
     std::cout << "        High-Performance Edition        " << std::endl;
     std::cout << "========================================" << std::endl;
     std::cout << std::endl;
+
+    // Every agent thread, this one included, picks up its placement from here
+    PCMonitor::AgentPolicy::Configure(agent);
+    PCMonitor::AgentPolicy::ApplyToCurrentThread(PCMonitor::ThreadRole::Worker);
     
     // Create monitor instance
-    PCMonitor::PerformanceMonitor monitor(std::chrono::milliseconds(1000));
+    PCMonitor::PerformanceMonitor monitor{ std::chrono::milliseconds(collection_interval_ms) };
     g_monitor = &monitor;
+    if (flight_seconds > 0 && burst_interval_ms == 0) {
+        burst_interval_ms = 20;
+    }
+    if (burst_interval_ms > 0 && burst_interval_ms < collection_interval_ms) {
+        monitor.SetBurstInterval(std::chrono::milliseconds(burst_interval_ms));
+    }
+    if (!power_model_path.empty()) {
+        monitor.SetPowerModelFile(power_model_path);
+    }
+    if (!record_path.empty()) {
+        monitor.SetRecordFile(record_path);
+    }
+    if (!replay_path.empty()) {
+        monitor.SetReplayFile(replay_path, replay_speed);
+    }
     
     // Set up signal handler
     signal(SIGINT, SignalHandler);
@@ -354,6 +1169,164 @@ int main(int argc, char* argv[]) {
     }
     
     std::cout << "✅ Monitor initialized successfully." << std::endl;
+
+    // A replay runs at the recording's interval; windows below are sized from it
+    if (monitor.IsReplaying()) {
+        collection_interval_ms = static_cast<int>(monitor.GetCollectionInterval().count());
+        if (collection_interval_ms <= 0) collection_interval_ms = 1000;
+        std::cout << "⏩ Replay at ";
+        if (replay_speed > 0.0) std::cout << replay_speed << "x"; else std::cout << "full speed";
+        std::cout << "; per-device series are not recorded and stay off" << std::endl;
+    }
+
+    // Per-core/per-device ring, sampled on the monitor's burst ticks
+    flight.pre_seconds = static_cast<uint32_t>(flight_seconds);
+    PCMonitor::DeviceSampler devices;
+    PCMonitor::FlightRecorder flight_recorder(devices, flight);
+    if (flight_seconds > 0) {
+        if (!monitor.IsBurstSampling() || !devices.Initialize() ||
+            !flight_recorder.Start(std::chrono::milliseconds(burst_interval_ms))) {
+            std::cerr << "⚠️  Flight recorder unavailable (needs burst sampling and per-device counters)" << std::endl;
+        } else {
+            monitor.AddBurstListener([&devices, &flight_recorder](std::chrono::steady_clock::time_point time) {
+                devices.Sample();
+                flight_recorder.Record(time);
+            });
+            g_flight_recorder = &flight_recorder;
+            signal(SIGBREAK, FlightSignalHandler);
+            std::cout << "✈️  Flight recorder: " << devices.GetSeriesCount() << " series, last "
+                      << flight.pre_seconds << " s + " << flight.post_seconds << " s after a trigger, every "
+                      << burst_interval_ms << " ms" << std::endl;
+        }
+    }
+
+    // Throttling episodes, anomalies, alerts and forecasts all end up in the
+    // event log and on /api/events, which exist only when one of them is on
+    std::unique_ptr<PCMonitor::EventStream> events;
+    if (enable_throttle_events || enable_anomalies || !alerts_path.empty() || enable_forecasts) {
+        events = std::make_unique<PCMonitor::EventStream>("pc_monitor_events.log");
+        events->Start();
+    }
+
+    if (enable_throttle_events) {
+        PCMonitor::ThrottleDetector& throttle = monitor.GetThrottleDetector();
+        throttle.SetEventListener([&throttle, &events](const PCMonitor::ThrottleEvent& event) {
+            std::string members;
+            throttle.AppendEventJson(event, members);
+            events->Publish("throttle", members);
+        });
+    }
+
+    // Anomaly detection and correlations read the per-device series on each
+    // snapshot; they are sampled here unless the flight recorder already does it
+    if ((enable_anomalies || enable_correlations) && g_flight_recorder == nullptr && !monitor.IsReplaying() &&
+        devices.Initialize()) {
+        monitor.AddSnapshotListener([&devices](const PCMonitor::MetricsSnapshot&) {
+            devices.Sample();
+        });
+    }
+
+    std::unique_ptr<PCMonitor::AnomalyDetector> anomalies;
+    if (enable_anomalies) {
+        anomalies = std::make_unique<PCMonitor::AnomalyDetector>(anomaly, devices.GetSeriesNames());
+        anomalies->SetEventListener([&anomalies, &events](const PCMonitor::AnomalyEvent& event) {
+            std::string members;
+            anomalies->AppendEventJson(event, members);
+            events->Publish("anomaly", members);
+        });
+
+        monitor.AddSnapshotListener([&devices, &anomalies](const PCMonitor::MetricsSnapshot& snapshot) {
+            anomalies->Evaluate(snapshot, devices.GetValues());
+        });
+        std::cout << "🔎 Anomaly detection: " << anomalies->GetSeriesCount() << " series, |z| > "
+                  << anomaly.z_threshold << (anomaly.season_seconds ? " against a seasonal baseline" : "") << std::endl;
+    }
+
+    // Pairwise correlation over a sliding window, one sample per snapshot
+    std::unique_ptr<PCMonitor::CorrelationMatrix> correlations;
+    if (enable_correlations) {
+        size_t window = static_cast<size_t>(correlation_seconds) * 1000 / static_cast<size_t>(collection_interval_ms);
+        correlations = std::make_unique<PCMonitor::CorrelationMatrix>(window, devices.GetSeriesNames());
+        monitor.AddSnapshotListener([&devices, &correlations](const PCMonitor::MetricsSnapshot& snapshot) {
+            correlations->Add(snapshot, devices.GetValues());
+        });
+        std::cout << "🔗 Correlations: " << correlations->GetSeriesCount() << " series over "
+                  << correlations->GetWindow() << " samples (" << correlations->GetMemoryBytes() / 1024 << " KB)" << std::endl;
+    }
+
+    // Alert and forecast changes also go, off the monitor thread, to the
+    // webhook and command
+    std::unique_ptr<PCMonitor::AlertNotifier> notifier;
+    if ((!alerts_path.empty() || enable_forecasts) && (!notify.webhook_url.empty() || !notify.command.empty())) {
+        std::string error;
+        notifier = std::make_unique<PCMonitor::AlertNotifier>(notify);
+        if (!notifier->Start(error)) {
+            std::cerr << "❌ Alert notifications: " << error << std::endl;
+            return 1;
+        }
+    }
+
+    // Rules compiled once, checked on every snapshot; changes go to the
+    // event stream and the notifier
+    std::unique_ptr<PCMonitor::AlertEngine> alerts;
+    if (!alerts_path.empty()) {
+        std::string error;
+        alerts = std::make_unique<PCMonitor::AlertEngine>(std::chrono::milliseconds(collection_interval_ms));
+        if (!alerts->LoadFile(alerts_path, error)) {
+            std::cerr << "❌ Alert rules: " << error << std::endl;
+            return 1;
+        }
+
+        alerts->SetEventListener([&alerts, &notifier, &events](const PCMonitor::AlertEvent& event) {
+            std::string members;
+            alerts->AppendEventJson(event, members);
+            events->Publish("alert", members);
+            if (notifier) {
+                notifier->Notify({ alerts->GetRuleName(event.rule), event.firing ? "firing" : "resolved",
+                                   std::to_string(event.value), "{" + members + "}" });
+            }
+        });
+        monitor.AddSnapshotListener([&alerts](const PCMonitor::MetricsSnapshot& snapshot) {
+            alerts->Evaluate(snapshot);
+        });
+        std::cout << "🚨 Alerts: " << alerts->GetRuleCount() << " rules over " << alerts->GetSignalCount()
+                  << " signals from " << alerts_path << std::endl;
+    }
+
+    // Trends refitted on every snapshot; a limit coming within the horizon
+    // is published like an alert
+    std::unique_ptr<PCMonitor::TrendForecaster> forecasts;
+    if (enable_forecasts) {
+        forecasts = std::make_unique<PCMonitor::TrendForecaster>(forecast, std::chrono::milliseconds(collection_interval_ms));
+        for (const std::string& limit : forecast_limits) {
+            std::string error;
+            if (!forecasts->SetLimit(limit, error)) {
+                std::cerr << "❌ --forecast-limit: " << error << std::endl;
+                return 1;
+            }
+        }
+
+        forecasts->SetEventListener([&forecasts, &notifier, &events](const PCMonitor::ForecastEvent& event) {
+            std::string members;
+            forecasts->AppendEventJson(event, members);
+            events->Publish("forecast", members);
+            if (notifier) {
+                notifier->Notify({ "forecast:" + forecasts->GetSeriesName(event.series), event.predicted ? "predicted" : "clear",
+                                   std::to_string(event.value), "{" + members + "}" });
+            }
+        });
+        monitor.AddSnapshotListener([&forecasts](const PCMonitor::MetricsSnapshot& snapshot) {
+            forecasts->Add(snapshot);
+        });
+        std::cout << "📈 Forecasts: " << forecasts->GetSeriesCount() << " series, events within "
+                  << forecast.horizon_seconds << " s of a limit" << std::endl;
+    }
+
+    // Local readers (see pcmonitor_shm.h) get every snapshot without HTTP
+    PCMonitor::SharedMemoryPublisher shared_memory;
+    if (enable_shared_memory && shared_memory.Open(monitor)) {
+        std::cout << "🧠 Shared memory: " << PCMON_SHM_NAME << std::endl;
+    }
     
     if (!monitor.Start()) {
         std::cerr << "❌ Failed to start monitoring!" << std::endl;
@@ -365,11 +1338,44 @@ int main(int argc, char* argv[]) {
     if (enable_web_server) {
         std::cout << "\n🌐 Starting web server mode..." << std::endl;
         g_web_server_running = true;
+
+        // One encoding per snapshot and format, shared by polling and streaming
+        PCMonitor::SnapshotCache json_cache(monitor, PCMonitor::EncodeMetricsJson, "application/json");
+        PCMonitor::SnapshotCache binary_cache(monitor, PCMonitor::EncodeMetricsCbor, "application/cbor");
+        PCMonitor::SnapshotDeltas deltas(monitor, json_cache);
+        PCMonitor::WindowStats window_stats(monitor);
+        PCMonitor::MetricsStream json_stream(monitor, json_cache, PCMonitor::MetricsStream::Framing::ServerSentEvents, &deltas);
+        PCMonitor::MetricsStream binary_stream(monitor, binary_cache, PCMonitor::MetricsStream::Framing::LengthPrefixed);
+        json_stream.Start();
+        binary_stream.Start();
+
+        PCMonitor::SubscriptionManager subscriptions(monitor);
+        subscriptions.Start();
+
+        PCMonitor::ChunkedResponder responder;
+        responder.Start();
+
+        // Web assets are read (and compressed) once, then served from memory
+        PCMonitor::AssetCache assets("web", dev_mode);
+        if (!assets.Load()) {
+            std::cout << "⚠️  web/ directory not found, serving the built-in dashboard" << std::endl;
+        }
+        if (dev_mode) {
+            assets.StartWatching();
+        }
         
-        std::thread webThread(WebServerLoop, std::ref(monitor), web_port);
+        PCMonitor::PrometheusExporter exporter;
+        WebServerContext context{ monitor, exporter, json_cache, binary_cache, deltas, window_stats, json_stream, binary_stream, subscriptions, responder, assets,
+                                  g_flight_recorder, anomalies.get(), correlations.get(), alerts.get(), forecasts.get(), notifier.get(), events.get(),
+                                  CreateHTTPResponse(PCMonitor::GenerateSchemaJson(), "application/json"), std::string(), {}, std::string() };
+        std::thread webThread(WebServerLoop, std::ref(context), web_port);
         
         std::cout << "Web server is running. Press Ctrl+C to stop." << std::endl;
         std::cout << "Open your browser and navigate to the dashboard URL above!" << std::endl;
+
+        if (agent.lock_memory) {
+            LockMemoryWhenWarm(monitor);
+        }
         
         // Keep main thread alive
         while (g_web_server_running) {
@@ -379,23 +1385,42 @@ int main(int argc, char* argv[]) {
         if (webThread.joinable()) {
             webThread.join();
         }
+
+        monitor.Stop();
+        json_stream.Stop();
+        binary_stream.Stop();
+        subscriptions.Stop();
+        responder.Stop();
     }
     else {
         std::cout << "\n📊 Running in console mode. Use --web to enable web interface." << std::endl;
         std::cout << "Press Ctrl+C to stop." << std::endl;
+
+        if (agent.lock_memory) {
+            LockMemoryWhenWarm(monitor);
+        }
         
         // Simple console output every 5 seconds
         while (true) {
             std::this_thread::sleep_for(std::chrono::seconds(5));
             auto now = std::chrono::system_clock::now();
             auto time_t = std::chrono::system_clock::to_time_t(now);
+            PCMonitor::AgentUsage usage = PCMonitor::AgentPolicy::ReadUsage();
             std::cout << "📊 " << std::put_time(std::localtime(&time_t), "%H:%M:%S") 
-                      << " - Monitoring active (data logged to pc_monitor_log.csv)" << std::endl;
+                      << " - Monitoring active (data logged to pc_monitor_log.csv), agent CPU "
+                      << std::fixed << std::setprecision(2) << usage.user_seconds + usage.kernel_seconds << " s" << std::endl;
         }
     }
     
     std::cout << "\n🛑 Stopping monitor..." << std::endl;
     monitor.Stop();
+    if (notifier) {
+        notifier->Stop();
+    }
+    if (events) {
+        events->Stop();
+    }
+    g_flight_recorder = nullptr;
     std::cout << "✅ Monitor stopped successfully." << std::endl;
     
     return 0;
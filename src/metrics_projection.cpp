@@ -0,0 +1,356 @@
+#include "metrics_projection.h"
+#include "http_parser.h"
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <set>
+
+namespace PCMonitor {
+
+    namespace {
+
+        constexpr size_t kGroupCount = sizeof(kMetricGroups) / sizeof(kMetricGroups[0]);
+        constexpr size_t kMaxElementIndex = 64;
+
+        // What a selection asks for from one field
+        struct FieldSelection {
+            bool whole = false;
+            std::set<size_t> elements;
+        };
+
+        std::string_view Trim(std::string_view text) {
+            while (!text.empty() && text.front() == ' ') text.remove_prefix(1);
+            while (!text.empty() && text.back() == ' ') text.remove_suffix(1);
+            return text;
+        }
+
+        const FieldGroup* FindGroup(std::string_view name, size_t& index) {
+            for (index = 0; index < kGroupCount; ++index) {
+                if (name == kMetricGroups[index].name) return &kMetricGroups[index];
+            }
+            return nullptr;
+        }
+
+        void AppendNumber(std::string& out, uint64_t value) {
+            char buffer[24];
+            auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+            out.append(buffer, result.ptr);
+        }
+
+        // One decimal place, the same precision the full document uses; null
+        // for a field with no value (NaN)
+        void AppendNumber(std::string& out, double value) {
+            if (!std::isfinite(value)) {
+                out += "null";
+                return;
+            }
+            char buffer[32];
+            auto result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::fixed, 1);
+            out.append(buffer, result.ptr);
+        }
+
+        template <typename T>
+        T ReadField(const SystemMetrics& metrics, const FieldInfo& field) {
+            T value;
+            memcpy(&value, reinterpret_cast<const char*>(&metrics) + field.offset, sizeof(value));
+            return value;
+        }
+
+        const FanSpeeds& ReadArray(const SystemMetrics& metrics, const FieldInfo& field) {
+            return *reinterpret_cast<const FanSpeeds*>(
+                reinterpret_cast<const char*>(&metrics) + field.offset);
+        }
+
+    }
+
+    void AppendFieldValue(std::string& out, const SystemMetrics& metrics, const FieldInfo& field) {
+        switch (field.type) {
+            case FieldType::U32:
+                AppendNumber(out, static_cast<uint64_t>(ReadField<uint32_t>(metrics, field)));
+                break;
+            case FieldType::U64:
+                AppendNumber(out, ReadField<uint64_t>(metrics, field));
+                break;
+            case FieldType::F64:
+                AppendNumber(out, ReadField<double>(metrics, field));
+                break;
+            case FieldType::U32Array: {
+                const auto& values = ReadArray(metrics, field);
+                out += '[';
+                for (size_t i = 0; i < values.size(); ++i) {
+                    if (i > 0) out += ',';
+                    AppendNumber(out, static_cast<uint64_t>(values[i]));
+                }
+                out += ']';
+                break;
+            }
+        }
+    }
+
+    double ReadScalarField(const SystemMetrics& metrics, const FieldInfo& field) {
+        switch (field.type) {
+            case FieldType::U32:
+                return static_cast<double>(ReadField<uint32_t>(metrics, field));
+            case FieldType::U64:
+                return static_cast<double>(ReadField<uint64_t>(metrics, field));
+            case FieldType::F64:
+                return ReadField<double>(metrics, field);
+            case FieldType::U32Array:
+                break;
+        }
+        return NAN;
+    }
+
+    const FieldInfo* FindScalarField(std::string_view name) {
+        size_t dot = name.find('.');
+        if (dot == std::string_view::npos) return nullptr;
+
+        for (const FieldGroup& group : kMetricGroups) {
+            if (name.substr(0, dot) != group.name) continue;
+            for (size_t i = 0; i < group.field_count; ++i) {
+                const FieldInfo& field = group.fields[i];
+                if (name.substr(dot + 1) == field.name) {
+                    return field.type == FieldType::U32Array ? nullptr : &field;
+                }
+            }
+        }
+        return nullptr;
+    }
+
+    void ListScalarSeries(std::vector<const FieldInfo*>& fields, std::vector<std::string>& names) {
+        for (const FieldGroup& group : kMetricGroups) {
+            for (size_t i = 0; i < group.field_count; ++i) {
+                const FieldInfo& field = group.fields[i];
+                if (field.type == FieldType::U32Array) continue;
+                fields.push_back(&field);
+                names.push_back(std::string(group.name) + "." + field.name);
+            }
+        }
+    }
+
+    bool MatchSeries(std::string_view list, const std::vector<std::string>& names, std::vector<bool>& selected,
+                     std::string& error) {
+        selected.assign(names.size(), list.empty());
+        while (!list.empty()) {
+            size_t comma = list.find(',');
+            std::string_view name = list.substr(0, comma);
+            list.remove_prefix(comma == std::string_view::npos ? list.size() : comma + 1);
+            if (name.empty()) continue;
+
+            bool found = false;
+            for (size_t i = 0; i < names.size(); ++i) {
+                std::string_view full = names[i];
+                bool group_match = full.size() > name.size() && full[name.size()] == '.' &&
+                                   full.compare(0, name.size(), name) == 0;
+                if (full == name || group_match) {
+                    selected[i] = true;
+                    found = true;
+                }
+            }
+            if (!found) {
+                error = "unknown series '" + std::string(name) + "'";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    ProjectionPlan::ProjectionPlan()
+        : field_count_(0)
+    {
+    }
+
+    std::shared_ptr<const ProjectionPlan> ProjectionPlan::Compile(std::string_view selection, std::string& error) {
+        std::vector<std::vector<FieldSelection>> selected(kGroupCount);
+        for (size_t g = 0; g < kGroupCount; ++g) {
+            selected[g].resize(kMetricGroups[g].field_count);
+        }
+
+        bool any = false;
+        while (!selection.empty()) {
+            size_t comma = selection.find(',');
+            std::string_view entry = Trim(selection.substr(0, comma));
+            selection.remove_prefix(comma == std::string_view::npos ? selection.size() : comma + 1);
+            if (entry.empty()) continue;
+
+            if (entry == "*") {
+                for (auto& group : selected) {
+                    for (auto& field : group) field.whole = true;
+                }
+                any = true;
+                continue;
+            }
+
+            size_t dot = entry.find('.');
+            std::string_view group_name = entry.substr(0, dot);
+            std::string_view field_name = dot == std::string_view::npos ? "*" : entry.substr(dot + 1);
+
+            size_t g = 0;
+            const FieldGroup* group = FindGroup(group_name, g);
+            if (!group) {
+                error = "unknown group '" + std::string(group_name) + "'";
+                return nullptr;
+            }
+
+            if (field_name == "*") {
+                for (auto& field : selected[g]) field.whole = true;
+                any = true;
+                continue;
+            }
+
+            // Optional [N] picks one device of an array field
+            bool has_index = false;
+            size_t element = 0;
+            size_t bracket = field_name.find('[');
+            if (bracket != std::string_view::npos) {
+                std::string_view index = field_name.substr(bracket + 1);
+                if (index.size() < 2 || index.back() != ']' ||
+                    std::from_chars(index.data(), index.data() + index.size() - 1, element).ptr != index.data() + index.size() - 1 ||
+                    element >= kMaxElementIndex) {
+                    error = "bad device index in '" + std::string(entry) + "'";
+                    return nullptr;
+                }
+                has_index = true;
+                field_name = field_name.substr(0, bracket);
+            }
+
+            size_t f = 0;
+            while (f < group->field_count && field_name != group->fields[f].name) ++f;
+            if (f == group->field_count) {
+                error = "unknown field '" + std::string(entry) + "'";
+                return nullptr;
+            }
+            if (has_index && group->fields[f].type != FieldType::U32Array) {
+                error = "'" + std::string(field_name) + "' is not a per-device field";
+                return nullptr;
+            }
+
+            if (has_index) {
+                selected[g][f].elements.insert(element);
+            } else {
+                selected[g][f].whole = true;
+            }
+            any = true;
+        }
+
+        if (!any) {
+            error = "no fields selected";
+            return nullptr;
+        }
+
+        auto plan = std::make_shared<ProjectionPlan>();
+        std::string text = "{\"timestamp\":";
+        auto slot = [&](SlotKind kind, const FieldInfo* field, size_t element) {
+            plan->segments_.push_back(Segment{ text, kind, field, element });
+            plan->signature_ += text;
+            plan->signature_ += '\x01';
+            text.clear();
+        };
+
+        slot(SlotKind::Timestamp, nullptr, 0);
+        text += ",\"version\":";
+        slot(SlotKind::Version, nullptr, 0);
+
+        for (size_t g = 0; g < kGroupCount; ++g) {
+            const FieldGroup& group = kMetricGroups[g];
+            bool group_open = false;
+
+            for (size_t f = 0; f < group.field_count; ++f) {
+                const FieldSelection& choice = selected[g][f];
+                if (!choice.whole && choice.elements.empty()) continue;
+
+                text += group_open ? "," : std::string(",\"") + group.name + "\":{";
+                group_open = true;
+                text += std::string("\"") + group.fields[f].name + "\":";
+                plan->field_count_++;
+
+                if (choice.whole) {
+                    slot(SlotKind::Field, &group.fields[f], 0);
+                    continue;
+                }
+
+                // Selected devices become an object keyed by index
+                text += "{";
+                bool first = true;
+                for (size_t element : choice.elements) {
+                    text += first ? "\"" : ",\"";
+                    text += std::to_string(element) + "\":";
+                    slot(SlotKind::Element, &group.fields[f], element);
+                    first = false;
+                }
+                text += "}";
+            }
+
+            if (group_open) text += "}";
+        }
+
+        text += "}";
+        plan->tail_ = text;
+        plan->signature_ += text;
+        return plan;
+    }
+
+    void ProjectionPlan::Write(const MetricsSnapshot& snapshot, std::string& out) const {
+        const SystemMetrics& metrics = snapshot.metrics;
+
+        for (const Segment& segment : segments_) {
+            out += segment.text;
+
+            switch (segment.kind) {
+                case SlotKind::Timestamp:
+                    AppendNumber(out, static_cast<uint64_t>(snapshot.timestamp));
+                    break;
+                case SlotKind::Version:
+                    AppendNumber(out, snapshot.version);
+                    break;
+                case SlotKind::Element: {
+                    const auto& values = ReadArray(metrics, *segment.field);
+                    if (segment.element < values.size()) {
+                        AppendNumber(out, static_cast<uint64_t>(values[segment.element]));
+                    } else {
+                        out += "null";
+                    }
+                    break;
+                }
+                case SlotKind::Field:
+                    AppendFieldValue(out, metrics, *segment.field);
+                    break;
+            }
+        }
+
+        out += tail_;
+    }
+
+    std::shared_ptr<const ProjectionPlan> ProjectionCache::Get(std::string_view raw_selection, std::string& error) {
+        std::string key(raw_selection);
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = plans_.find(key);
+            if (it != plans_.end()) return it->second;
+        }
+
+        std::string decoded;
+        if (!PercentDecode(raw_selection, decoded)) {
+            error = "malformed escape in fields";
+            return nullptr;
+        }
+
+        auto plan = ProjectionPlan::Compile(decoded, error);
+        if (!plan) return nullptr;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        // Selections come from a handful of clients; if something is
+        // generating endless variants, start over rather than grow forever.
+        if (plans_.size() >= kMaxPlans) {
+            plans_.clear();
+        }
+        plans_.emplace(std::move(key), plan);
+        return plan;
+    }
+
+    size_t ProjectionCache::GetPlanCount() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return plans_.size();
+    }
+
+}
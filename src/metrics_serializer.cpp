@@ -0,0 +1,145 @@
+#include "metrics_serializer.h"
+#include <charconv>
+#include <cmath>
+#include <string_view>
+#include <ctime>
+
+namespace PCMonitor {
+
+    namespace {
+
+        constexpr size_t kMaxNumberChars = 32;
+
+        // Appends to a string, formatting numbers with std::to_chars straight
+        // into its storage rather than through temporaries
+        class TextWriter {
+        private:
+            std::string& out_;
+            int precision_;     // Decimal places for doubles
+            const char* missing_;   // Written for a double with no value (NaN)
+
+            template <typename T, typename... Options>
+            void Format(T value, Options... options) {
+                size_t size = out_.size();
+                out_.resize(size + kMaxNumberChars);
+                char* begin = &out_[size];
+                auto result = std::to_chars(begin, begin + kMaxNumberChars, value, options...);
+                out_.resize(static_cast<size_t>(result.ptr - out_.data()));
+            }
+
+        public:
+            TextWriter(std::string& out, int precision, const char* missing)
+                : out_(out), precision_(precision), missing_(missing) {}
+
+            void Literal(std::string_view text) { out_.append(text.data(), text.size()); }
+            void Literal(char c) { out_ += c; }
+
+            void Value(uint32_t value) { Format(value); }
+            void Value(uint64_t value) { Format(value); }
+            void Value(int64_t value) { Format(value); }
+            void Value(double value) {
+                if (std::isfinite(value)) Format(value, std::chars_format::fixed, precision_);
+                else Literal(missing_);
+            }
+        };
+
+    }
+
+    void WriteMetricsJson(const MetricsSnapshot& snapshot, std::string& out) {
+        TextWriter writer(out, 1, "null");
+
+        writer.Literal("{\"timestamp\":");
+        writer.Value(snapshot.timestamp);
+        writer.Literal(",\"version\":");
+        writer.Value(snapshot.version);
+
+        VisitGroups(snapshot.metrics, [&writer](const FieldGroup& group, const auto& metrics) {
+            writer.Literal(",\"");
+            writer.Literal(group.name);
+            writer.Literal("\":");
+
+            char separator = '{';
+            VisitFields(metrics, [&writer, &separator](std::string_view name, const auto& value) {
+                writer.Literal(separator);
+                writer.Literal('"');
+                writer.Literal(name);
+                writer.Literal("\":");
+                separator = ',';
+
+                if constexpr (std::is_same_v<std::decay_t<decltype(value)>, FanSpeeds>) {
+                    writer.Literal('[');
+                    for (size_t i = 0; i < value.size(); ++i) {
+                        if (i > 0) writer.Literal(',');
+                        writer.Value(value[i]);
+                    }
+                    writer.Literal(']');
+                } else {
+                    writer.Value(value);
+                }
+            });
+
+            writer.Literal('}');
+        });
+
+        writer.Literal('}');
+    }
+
+    std::string EncodeMetricsJson(const MetricsSnapshot& snapshot) {
+        std::string json;
+        json.reserve(1024);
+        WriteMetricsJson(snapshot, json);
+        return json;
+    }
+
+    const std::string& GetCsvHeader() {
+        static const std::string header = [] {
+            std::string text = "Timestamp";
+            for (const FieldGroup& group : kMetricGroups) {
+                for (size_t i = 0; i < group.field_count; ++i) {
+                    const FieldInfo& field = group.fields[i];
+                    std::string name = std::string(group.name) + "_" + field.name;
+
+                    if (field.type != FieldType::U32Array) {
+                        text += "," + name;
+                        continue;
+                    }
+                    for (size_t column = 0; column < kCsvArrayColumns; ++column) {
+                        text += "," + name + "_" + std::to_string(column);
+                    }
+                }
+            }
+            return text + "\n";
+        }();
+        return header;
+    }
+
+    void WriteCsvRow(int64_t unix_seconds, const SystemMetrics& metrics, std::string& out) {
+        std::time_t time = static_cast<std::time_t>(unix_seconds);
+        std::tm local = {};
+        localtime_s(&local, &time);
+
+        char stamp[32];
+        size_t length = strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &local);
+
+        // An empty cell, like a fan column with no fan
+        TextWriter writer(out, 2, "");
+        writer.Literal(std::string_view(stamp, length));
+
+        VisitGroups(metrics, [&writer](const FieldGroup&, const auto& group) {
+            VisitFields(group, [&writer](std::string_view, const auto& value) {
+                if constexpr (std::is_same_v<std::decay_t<decltype(value)>, FanSpeeds>) {
+                    for (size_t i = 0; i < kCsvArrayColumns; ++i) {
+                        writer.Literal(',');
+                        if (i < value.size()) writer.Value(value[i]);
+                    }
+                } else {
+                    writer.Literal(',');
+                    writer.Value(value);
+                }
+            });
+        });
+
+        writer.Literal('\n');
+    }
+
+}
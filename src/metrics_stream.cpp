@@ -0,0 +1,214 @@
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+
+#include <winsock2.h>
+
+#include "metrics_stream.h"
+#include "performance_monitor.h"
+#include "snapshot_cache.h"
+#include "snapshot_deltas.h"
+#include "agent_policy.h"
+#include <algorithm>
+
+#pragma comment(lib, "ws2_32.lib")
+
+namespace PCMonitor {
+
+    MetricsStream::MetricsStream(PerformanceMonitor& monitor, SnapshotCache& cache, Framing framing, SnapshotDeltas* deltas)
+        : cache_(cache)
+        , deltas_(deltas)
+        , framing_(framing)
+        , running_(false)
+        , published_version_(0)
+        , latest_version_(0)
+        , subscriber_count_(0)
+        , frames_coalesced_(0)
+    {
+        // Only record the version here; encoding happens on the stream thread
+        monitor.AddSnapshotListener([this](const MetricsSnapshot& snapshot) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                published_version_ = snapshot.version;
+            }
+            cv_.notify_one();
+        });
+    }
+
+    MetricsStream::~MetricsStream() {
+        Stop();
+    }
+
+    bool MetricsStream::Start() {
+        if (running_) return false;
+
+        running_ = true;
+        stream_thread_ = std::make_unique<std::thread>(&MetricsStream::StreamLoop, this);
+        return true;
+    }
+
+    void MetricsStream::Stop() {
+        if (!running_) return;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_ = false;
+        }
+        cv_.notify_all();
+
+        if (stream_thread_ && stream_thread_->joinable()) {
+            stream_thread_->join();
+        }
+        stream_thread_.reset();
+
+        for (auto& subscriber : subscribers_) {
+            subscriber.sink.Close();
+        }
+        subscribers_.clear();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const PendingSubscriber& pending : new_subscribers_) {
+            closesocket(static_cast<SOCKET>(pending.socket));
+        }
+        new_subscribers_.clear();
+        subscriber_count_ = 0;
+    }
+
+    void MetricsStream::AddSubscriber(SocketHandle socket, bool deltas, uint64_t since) {
+        FrameSink::MakeNonBlocking(socket);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!running_) {
+                closesocket(static_cast<SOCKET>(socket));
+                return;
+            }
+            new_subscribers_.push_back(PendingSubscriber{ socket, deltas && deltas_ != nullptr, since });
+        }
+        cv_.notify_one();
+    }
+
+    std::shared_ptr<const std::string> MetricsStream::EncodeFrame(const std::string& payload, uint64_t version) const {
+        std::string frame;
+        frame.reserve(payload.size() + 64);
+
+        if (framing_ == Framing::LengthPrefixed) {
+            uint32_t length = static_cast<uint32_t>(payload.size());
+            for (int i = 0; i < 4; ++i) {
+                frame += static_cast<char>((length >> (i * 8)) & 0xFF);
+            }
+            frame += payload;
+            return std::make_shared<const std::string>(std::move(frame));
+        }
+
+        frame += "id: ";
+        frame += std::to_string(version);
+        frame += "\ndata: ";
+
+        // SSE data can't contain raw newlines; each line gets its own prefix
+        for (char c : payload) {
+            if (c == '\n') {
+                frame += "\ndata: ";
+            } else {
+                frame += c;
+            }
+        }
+        frame += "\n\n";
+
+        return std::make_shared<const std::string>(std::move(frame));
+    }
+
+    std::shared_ptr<const std::string> MetricsStream::FrameFor(const Subscriber& subscriber, uint64_t& version) {
+        if (!subscriber.deltas) {
+            version = latest_version_;
+            return latest_frame_;
+        }
+
+        // The base is what the client will hold once its current frame is
+        // written, so a replaced (coalesced) delta never leaves a gap
+        uint64_t base = subscriber.sink.GetFrameVersion();
+        auto& frame = delta_frames_[base];
+        if (!frame.first) {
+            // May be newer than latest_version_ if a snapshot was just published
+            auto encoded = deltas_->Get(base);
+            frame = { EncodeFrame(encoded->body, encoded->version), encoded->version };
+        }
+        version = frame.second;
+        return frame.first;
+    }
+
+    void MetricsStream::QueueFrame(Subscriber& subscriber, const std::shared_ptr<const std::string>& frame, uint64_t version) {
+        if (subscriber.sink.Queue(frame, version)) {
+            frames_coalesced_++;
+        }
+    }
+
+    void MetricsStream::StreamLoop() {
+        AgentPolicy::ApplyToCurrentThread(ThreadRole::Worker);
+
+        bool pending_writes = false;
+        uint64_t seen_version = 0;
+
+        while (running_) {
+            std::vector<PendingSubscriber> added;
+            uint64_t version;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                // Poll quickly while some client has unsent bytes, otherwise
+                // sleep until the next snapshot or subscriber arrives.
+                auto timeout = pending_writes ? std::chrono::milliseconds(20) : std::chrono::milliseconds(1000);
+                cv_.wait_for(lock, timeout, [this, seen_version] {
+                    return !running_ || published_version_ != seen_version || !new_subscribers_.empty();
+                });
+
+                if (!running_) break;
+
+                added.swap(new_subscribers_);
+                version = published_version_;
+                seen_version = version;
+            }
+
+            bool has_clients = !subscribers_.empty() || !added.empty();
+            if (version != latest_version_ && has_clients) {
+                auto encoded = cache_.Get();
+                latest_frame_ = EncodeFrame(encoded->body, encoded->version);
+                latest_version_ = encoded->version;
+                delta_frames_.clear();
+
+                for (auto& subscriber : subscribers_) {
+                    uint64_t frame_version = 0;
+                    auto frame = FrameFor(subscriber, frame_version);
+                    QueueFrame(subscriber, frame, frame_version);
+                }
+            }
+
+            // New clients get the current snapshot immediately
+            for (const PendingSubscriber& pending : added) {
+                Subscriber subscriber{ FrameSink(pending.socket, pending.since), pending.deltas };
+                if (latest_frame_) {
+                    uint64_t frame_version = 0;
+                    auto frame = FrameFor(subscriber, frame_version);
+                    QueueFrame(subscriber, frame, frame_version);
+                }
+                subscribers_.push_back(std::move(subscriber));
+            }
+
+            pending_writes = false;
+            for (auto& subscriber : subscribers_) {
+                if (!subscriber.sink.Flush()) {
+                    subscriber.sink.Close();
+                } else if (subscriber.sink.HasPendingWrites()) {
+                    pending_writes = true;
+                }
+            }
+
+            subscribers_.erase(
+                std::remove_if(subscribers_.begin(), subscribers_.end(), [](const Subscriber& subscriber) {
+                    return !subscriber.sink.IsOpen();
+                }),
+                subscribers_.end());
+            subscriber_count_ = subscribers_.size();
+        }
+    }
+
+}
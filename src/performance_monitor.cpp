@@ -1,4 +1,7 @@
 #include "performance_monitor.h"
+#include "data_logger.h"
+#include "metrics_serializer.h"
+#include "agent_policy.h"
 #include <iostream>
 #include <sstream>
 #include <iomanip>
@@ -7,22 +10,47 @@
 #include <intrin.h>
 #include <psapi.h>
 #include <winternl.h>
+#include <mmsystem.h>
 #include <algorithm>
+#include <ctime>
+#include <cmath>
 
 #pragma comment(lib, "wbemuuid.lib")
 #pragma comment(lib, "psapi.lib")
 #pragma comment(lib, "ntdll.lib")
+#pragma comment(lib, "winmm.lib")
 
 namespace PCMonitor {
 
+    namespace {
+
+        // Stores a reading in a metric; a failed read (NaN) keeps the previous value
+        template <typename T>
+        bool Assign(T& metric, double value) {
+            if (std::isnan(value)) return false;
+            metric = static_cast<T>(value);
+            return true;
+        }
+
+    }
+
     PerformanceMonitor::PerformanceMonitor(std::chrono::milliseconds interval)
         : collection_interval_(interval)
+        , log_path_("pc_monitor_log.csv")
         , running_(false)
         , cpu_query_(nullptr)
         , cpu_counter_(nullptr)
         , gpu_device_(nullptr)
+        , snapshot_version_(0)
+        , burst_interval_(0)
+        , burst_query_(nullptr)
+        , burst_counters_()
+        , power_model_("pc_monitor_power_model.txt")
+        , gpu_power_measured_(false)
         , cached_core_count_(0)
         , cached_thread_count_(0)
+        , replay_speed_(1.0)
+        , replay_unix_(0)
     {
         // Initialize metrics structures
         memset(&gpu_metrics_, 0, sizeof(gpu_metrics_));
@@ -34,6 +62,10 @@ namespace PCMonitor {
         memset(&thermal_metrics_, 0, sizeof(thermal_metrics_));
         total_bytes_received_ = 0;
         total_bytes_sent_ = 0;
+        snapshot_ = {};
+        latency_work_ = {};
+        collector_latencies_ = {};
+        inputs_ = {};
     }
 
     PerformanceMonitor::~PerformanceMonitor() {
@@ -42,6 +74,10 @@ namespace PCMonitor {
         if (cpu_query_) {
             PdhCloseQuery(cpu_query_);
         }
+
+        if (burst_query_) {
+            PdhCloseQuery(burst_query_);
+        }
         
         #ifdef NVML_AVAILABLE
         nvmlShutdown();
@@ -53,6 +89,25 @@ namespace PCMonitor {
     }
 
     bool PerformanceMonitor::Initialize() {
+        if (!(replay_path_.empty() ? InitializeCollectors() : InitializeReplay())) {
+            return false;
+        }
+
+        // Open log file (the header goes only into a new file); SetLogFile()
+        // may have opened it already
+        log_line_.reserve(1024);
+        if (log_file_.is_open()) {
+            log_file_.close();
+        }
+        if (!OpenCsvLog(log_file_, log_path_)) {
+            std::cerr << "Failed to open log file" << std::endl;
+            return false;
+        }
+        
+        return true;
+    }
+
+    bool PerformanceMonitor::InitializeCollectors() {
         // Initialize NVML for GPU monitoring
         if (!InitializeNVML()) {
             std::cout << "NVML initialization failed or not available. GPU monitoring will be limited." << std::endl;
@@ -64,6 +119,11 @@ namespace PCMonitor {
             return false;
         }
         
+        if (burst_interval_.count() > 0 && !InitializeBurstQuery()) {
+            std::cout << "Burst sampling counters unavailable; reporting one sample per interval." << std::endl;
+            burst_interval_ = std::chrono::milliseconds(0);
+        }
+        
         // Initialize WMI for additional hardware info
         if (!InitializeWMI()) {
             std::cerr << "Failed to initialize WMI" << std::endl;
@@ -73,20 +133,58 @@ namespace PCMonitor {
         // Cache CPU topology (core/thread count never changes at runtime)
         CacheCPUTopology();
 
-        // Open log file
-        log_file_.open("pc_monitor_log.csv", std::ios::app);
-        if (!log_file_.is_open()) {
-            std::cerr << "Failed to open log file" << std::endl;
+        if (!throttle_.Initialize()) {
+            std::cout << "Processor performance counters unavailable; throttling will not be detected." << std::endl;
+        }
+
+        power_model_.Load();
+        InitializeEnergyMeters();
+
+        if (!record_path_.empty()) {
+            RecordingHeader header;
+            header.core_count = cached_core_count_;
+            header.thread_count = cached_thread_count_;
+            header.interval_ms = static_cast<uint32_t>(collection_interval_.count());
+            header.burst_interval_ms = static_cast<uint32_t>(burst_interval_.count());
+            header.start_unix = static_cast<int64_t>(std::time(nullptr));
+
+            std::string error;
+            recording_ = std::make_unique<RecordingWriter>();
+            if (!recording_->Open(record_path_, header, error)) {
+                std::cerr << "Failed to open recording: " << error << std::endl;
+                recording_.reset();
+                return false;
+            }
+            std::cout << "Recording collector inputs to " << record_path_ << std::endl;
+        }
+
+        return true;
+    }
+
+    // Nothing is opened on the system; the recording supplies what the
+    // collectors would have read
+    bool PerformanceMonitor::InitializeReplay() {
+        std::string error;
+        replay_ = std::make_unique<RecordingReader>();
+        if (!replay_->Open(replay_path_, error)) {
+            std::cerr << "Failed to open recording: " << error << std::endl;
+            replay_.reset();
             return false;
         }
-        
-        // Write CSV header
-        log_file_ << "Timestamp,GPU_VRAM_Used_MB,GPU_Core_Clock_MHz,GPU_Temp_C,GPU_Usage_%,"
-                  << "CPU_Clock_MHz,CPU_Usage_%,CPU_Temp_C,"
-                  << "RAM_Used_MB,RAM_Usage_%,"
-                  << "Storage_Read_MBps,Storage_Write_MBps,"
-                  << "System_Power_W,PSU_Efficiency_%\n";
-        
+
+        const RecordingHeader& header = replay_->GetHeader();
+        cached_core_count_ = header.core_count;
+        cached_thread_count_ = header.thread_count;
+        collection_interval_ = std::chrono::milliseconds(header.interval_ms);
+        burst_interval_ = std::chrono::milliseconds(header.burst_interval_ms);
+
+        // Start from the default coefficients so every replay computes the
+        // same power, and keep this machine's saved model untouched
+        power_model_.SetPath(std::string());
+
+        std::cout << "Replaying " << replay_path_ << " (" << header.interval_ms << " ms interval";
+        if (header.burst_interval_ms > 0) std::cout << ", " << header.burst_interval_ms << " ms bursts";
+        std::cout << ")" << std::endl;
         return true;
     }
 
@@ -155,6 +253,79 @@ namespace PCMonitor {
         return true;
     }
 
+    // RAPL domains Windows exposes as "\Energy Meter(RAPL_Package0_PKG)\Power"
+    // (milliwatts); absent on most AMD systems and in VMs
+    void PerformanceMonitor::InitializeEnergyMeters() {
+        const char* wildcard = "\\Energy Meter(*)\\Power";
+        DWORD length = 0;
+        if (PdhExpandWildCardPathA(nullptr, wildcard, nullptr, &length, 0) != static_cast<PDH_STATUS>(PDH_MORE_DATA)) {
+            return;
+        }
+        std::vector<char> paths(length + 2);
+        if (PdhExpandWildCardPathA(nullptr, wildcard, paths.data(), &length, 0) != ERROR_SUCCESS) {
+            return;
+        }
+
+        for (const char* path = paths.data(); *path; path += strlen(path) + 1) {
+            std::string full(path);
+            bool package = full.find("_PKG)") != std::string::npos;
+            bool dram = full.find("_DRAM)") != std::string::npos;
+            if (!package && !dram) continue;
+
+            PDH_HCOUNTER counter;
+            if (PdhAddCounterA(cpu_query_, path, 0, &counter) != ERROR_SUCCESS) continue;
+            (package ? package_power_counters_ : dram_power_counters_).push_back(counter);
+        }
+
+        if (!package_power_counters_.empty() || !dram_power_counters_.empty()) {
+            std::cout << "Calibrating the power model against " << package_power_counters_.size()
+                      << " package and " << dram_power_counters_.size() << " DRAM energy meters." << std::endl;
+        }
+    }
+
+    // Sum in watts, or NaN when nothing could be read
+    double PerformanceMonitor::ReadEnergyMeters(const std::vector<PDH_HCOUNTER>& counters) {
+        double total = 0.0;
+        bool read = false;
+        PDH_FMT_COUNTERVALUE counter_val;
+        for (PDH_HCOUNTER counter : counters) {
+            if (PdhGetFormattedCounterValue(counter, PDH_FMT_DOUBLE, nullptr, &counter_val) == ERROR_SUCCESS) {
+                total += counter_val.doubleValue / 1000.0;
+                read = true;
+            }
+        }
+        return read ? total : NAN;
+    }
+
+    bool PerformanceMonitor::InitializeBurstQuery() {
+        if (PdhOpenQuery(nullptr, 0, &burst_query_) != ERROR_SUCCESS) {
+            burst_query_ = nullptr;
+            return false;
+        }
+
+        // Same counters as the interval query; a missing disk or network
+        // counter only leaves that series on its interval value
+        static const wchar_t* const kPaths[BurstSeriesCount] = {
+            L"\\Processor(_Total)\\% Processor Time",
+            L"\\PhysicalDisk(_Total)\\Disk Read Bytes/sec",
+            L"\\PhysicalDisk(_Total)\\Disk Write Bytes/sec",
+            L"\\Network Interface(*)\\Bytes Received/sec",
+            L"\\Network Interface(*)\\Bytes Sent/sec"
+        };
+        for (size_t i = 0; i < BurstSeriesCount; ++i) {
+            if (PdhAddCounterW(burst_query_, kPaths[i], 0, &burst_counters_[i]) != ERROR_SUCCESS) {
+                burst_counters_[i] = nullptr;
+            }
+        }
+
+        if (!burst_counters_[BurstCpu]) {
+            PdhCloseQuery(burst_query_);
+            burst_query_ = nullptr;
+            return false;
+        }
+        return true;
+    }
+
     bool PerformanceMonitor::InitializeWMI() {
         HRESULT hr = CoInitializeEx(0, COINIT_MULTITHREADED);
         if (FAILED(hr)) return false;
@@ -167,66 +338,83 @@ namespace PCMonitor {
         return SUCCEEDED(hr);
     }
 
-    void PerformanceMonitor::CollectGPUMetrics() {
+    void PerformanceMonitor::ReadGPUInputs() {
+        CollectorInputs& in = inputs_;
+
         #ifdef NVML_AVAILABLE
         if (!gpu_device_) {
             // Set default values if NVML not available
-            gpu_metrics_.vram_total_mb = 16384;
-            gpu_metrics_.vram_used_mb = 8192;
-            gpu_metrics_.core_clock_mhz = 2485;
-            gpu_metrics_.memory_clock_mhz = 10000;
-            gpu_metrics_.temperature_c = 72;
-            gpu_metrics_.power_draw_w = 250;
-            gpu_metrics_.utilization_percent = 65;
-            gpu_metrics_.memory_bandwidth_mbps = 1008000;
+            in.gpu_vram_total_mb = 16384;
+            in.gpu_vram_used_mb = 8192;
+            in.gpu_core_clock_mhz = 2485;
+            in.gpu_memory_clock_mhz = 10000;
+            in.gpu_temperature_c = 72;
+            in.gpu_power_draw_w = 250;
+            in.gpu_power_measured = 0;
+            in.gpu_utilization_percent = 65;
+            in.gpu_memory_bandwidth_mbps = 1008000;
             return;
         }
         
         nvmlMemory_t memory;
-        if (nvmlDeviceGetMemoryInfo(gpu_device_, &memory) == NVML_SUCCESS) {
-            gpu_metrics_.vram_total_mb = static_cast<uint32_t>(memory.total / (1024 * 1024));
-            gpu_metrics_.vram_used_mb = static_cast<uint32_t>(memory.used / (1024 * 1024));
-        }
+        bool memory_read = nvmlDeviceGetMemoryInfo(gpu_device_, &memory) == NVML_SUCCESS;
+        in.gpu_vram_total_mb = memory_read ? static_cast<double>(memory.total / (1024 * 1024)) : NAN;
+        in.gpu_vram_used_mb = memory_read ? static_cast<double>(memory.used / (1024 * 1024)) : NAN;
         
         unsigned int clock;
-        if (nvmlDeviceGetClockInfo(gpu_device_, NVML_CLOCK_GRAPHICS, &clock) == NVML_SUCCESS) {
-            gpu_metrics_.core_clock_mhz = clock;
-        }
-        
-        if (nvmlDeviceGetClockInfo(gpu_device_, NVML_CLOCK_MEM, &clock) == NVML_SUCCESS) {
-            gpu_metrics_.memory_clock_mhz = clock;
-        }
+        in.gpu_core_clock_mhz = nvmlDeviceGetClockInfo(gpu_device_, NVML_CLOCK_GRAPHICS, &clock) == NVML_SUCCESS
+            ? static_cast<double>(clock) : NAN;
+        in.gpu_memory_clock_mhz = nvmlDeviceGetClockInfo(gpu_device_, NVML_CLOCK_MEM, &clock) == NVML_SUCCESS
+            ? static_cast<double>(clock) : NAN;
         
         unsigned int temp;
-        if (nvmlDeviceGetTemperature(gpu_device_, NVML_TEMPERATURE_GPU, &temp) == NVML_SUCCESS) {
-            gpu_metrics_.temperature_c = temp;
-        }
+        in.gpu_temperature_c = nvmlDeviceGetTemperature(gpu_device_, NVML_TEMPERATURE_GPU, &temp) == NVML_SUCCESS
+            ? static_cast<double>(temp) : NAN;
         
         unsigned int power;
-        if (nvmlDeviceGetPowerUsage(gpu_device_, &power) == NVML_SUCCESS) {
-            gpu_metrics_.power_draw_w = power / 1000; // Convert mW to W
-        }
+        bool power_read = nvmlDeviceGetPowerUsage(gpu_device_, &power) == NVML_SUCCESS;
+        in.gpu_power_draw_w = power_read ? static_cast<double>(power / 1000) : NAN; // Convert mW to W
+        in.gpu_power_measured = power_read ? 1 : 0;
         
         nvmlUtilization_t utilization;
-        if (nvmlDeviceGetUtilizationRates(gpu_device_, &utilization) == NVML_SUCCESS) {
-            gpu_metrics_.utilization_percent = utilization.gpu;
-        }
-        
-        // Calculate memory bandwidth (simplified estimation)
-        gpu_metrics_.memory_bandwidth_mbps = static_cast<uint64_t>(gpu_metrics_.memory_clock_mhz) * 2 * 256 / 8; // DDR, 256-bit bus
+        in.gpu_utilization_percent = nvmlDeviceGetUtilizationRates(gpu_device_, &utilization) == NVML_SUCCESS
+            ? static_cast<double>(utilization.gpu) : NAN;
+        in.gpu_memory_bandwidth_mbps = NAN;
         #else
         // Fallback values when NVML not available
-        gpu_metrics_.vram_total_mb = 16384;
-        gpu_metrics_.vram_used_mb = static_cast<uint32_t>(8192 + (rand() % 2048));
-        gpu_metrics_.core_clock_mhz = static_cast<uint32_t>(2400 + (rand() % 200));
-        gpu_metrics_.memory_clock_mhz = 10000;
-        gpu_metrics_.temperature_c = static_cast<uint32_t>(65 + (rand() % 15));
-        gpu_metrics_.power_draw_w = static_cast<uint32_t>(200 + (rand() % 100));
-        gpu_metrics_.utilization_percent = static_cast<uint32_t>(rand() % 100);
-        gpu_metrics_.memory_bandwidth_mbps = 1008000;
+        in.gpu_vram_total_mb = 16384;
+        in.gpu_vram_used_mb = 8192 + (rand() % 2048);
+        in.gpu_core_clock_mhz = 2400 + (rand() % 200);
+        in.gpu_memory_clock_mhz = 10000;
+        in.gpu_temperature_c = 65 + (rand() % 15);
+        in.gpu_power_draw_w = 200 + (rand() % 100);
+        in.gpu_power_measured = 0;
+        in.gpu_utilization_percent = rand() % 100;
+        in.gpu_memory_bandwidth_mbps = 1008000;
         #endif
     }
 
+    void PerformanceMonitor::CollectGPUMetrics() {
+        if (!replay_) ReadGPUInputs();
+        const CollectorInputs& in = inputs_;
+
+        Assign(gpu_metrics_.vram_total_mb, in.gpu_vram_total_mb);
+        Assign(gpu_metrics_.vram_used_mb, in.gpu_vram_used_mb);
+        Assign(gpu_metrics_.core_clock_mhz, in.gpu_core_clock_mhz);
+        Assign(gpu_metrics_.memory_clock_mhz, in.gpu_memory_clock_mhz);
+        Assign(gpu_metrics_.temperature_c, in.gpu_temperature_c);
+        Assign(gpu_metrics_.power_draw_w, in.gpu_power_draw_w);
+        Assign(gpu_metrics_.utilization_percent, in.gpu_utilization_percent);
+        gpu_power_measured_ = in.gpu_power_measured != 0;
+        
+        // Calculate memory bandwidth (simplified estimation) unless given
+        if (std::isnan(in.gpu_memory_bandwidth_mbps)) {
+            gpu_metrics_.memory_bandwidth_mbps = static_cast<uint64_t>(gpu_metrics_.memory_clock_mhz) * 2 * 256 / 8; // DDR, 256-bit bus
+        } else {
+            gpu_metrics_.memory_bandwidth_mbps = static_cast<uint64_t>(in.gpu_memory_bandwidth_mbps);
+        }
+    }
+
     void PerformanceMonitor::CacheCPUTopology() {
         SYSTEM_INFO sys_info;
         GetSystemInfo(&sys_info);
@@ -264,27 +452,63 @@ namespace PCMonitor {
         }
     }
 
-    void PerformanceMonitor::CollectCPUMetrics() {
-        // Use cached topology instead of re-querying every second
-        cpu_metrics_.core_count = cached_core_count_;
-        cpu_metrics_.thread_count = cached_thread_count_;
+    // Formatted value of a counter in performance_counters_, or NaN
+    double PerformanceMonitor::ReadLargeCounter(const char* name) {
+        auto it = performance_counters_.find(name);
+        PDH_FMT_COUNTERVALUE counter_val;
+        if (it == performance_counters_.end() ||
+            PdhGetFormattedCounterValue(it->second, PDH_FMT_LARGE, nullptr, &counter_val) != ERROR_SUCCESS) {
+            return NAN;
+        }
+        return static_cast<double>(counter_val.largeValue);
+    }
+
+    void PerformanceMonitor::ReadCPUInputs() {
+        CollectorInputs& in = inputs_;
 
         // Collect PDH data
         PdhCollectQueryData(cpu_query_);
         
         PDH_FMT_COUNTERVALUE counter_val;
-        if (PdhGetFormattedCounterValue(cpu_counter_, PDH_FMT_DOUBLE, nullptr, &counter_val) == ERROR_SUCCESS) {
-            cpu_metrics_.utilization_percent = counter_val.doubleValue;
-        }
+        in.cpu_utilization_percent = PdhGetFormattedCounterValue(cpu_counter_, PDH_FMT_DOUBLE, nullptr, &counter_val) == ERROR_SUCCESS
+            ? counter_val.doubleValue : NAN;
+        in.cpu_frequency_mhz = ReadLargeCounter("cpu_frequency");
+
+        uint32_t fallback_mhz = std::isnan(in.cpu_frequency_mhz) ? cpu_metrics_.current_clock_mhz
+                                                                 : static_cast<uint32_t>(in.cpu_frequency_mhz);
+        ThrottleDetector::Summary throttle = throttle_.Sample(fallback_mhz);
+        in.cpu_effective_clock_mhz = throttle.effective_clock_mhz;
+        in.cpu_performance_limit_percent = throttle.performance_limit_percent;
+        in.cpu_throttled_cores = throttle.throttled_cores;
+        in.cpu_throttled_seconds = throttle.throttled_seconds;
+        in.cpu_frequency_loss_mhz = throttle.frequency_loss_mhz;
+    }
+
+    void PerformanceMonitor::CollectCPUMetrics() {
+        // Use cached topology instead of re-querying every second
+        cpu_metrics_.core_count = cached_core_count_;
+        cpu_metrics_.thread_count = cached_thread_count_;
+
+        if (!replay_) ReadCPUInputs();
+        const CollectorInputs& in = inputs_;
+
+        Assign(cpu_metrics_.utilization_percent, in.cpu_utilization_percent);
+
+        BurstSummary burst = TakeBurst(BurstCpu, cpu_metrics_.utilization_percent);
+        cpu_metrics_.utilization_mean_percent = burst.mean;
+        cpu_metrics_.utilization_min_percent = burst.min;
+        cpu_metrics_.utilization_max_percent = burst.max;
+        cpu_metrics_.utilization_p99_percent = burst.p99;
         
-        // Get CPU frequency
-        auto it = performance_counters_.find("cpu_frequency");
-        if (it != performance_counters_.end()) {
-            if (PdhGetFormattedCounterValue(it->second, PDH_FMT_LARGE, nullptr, &counter_val) == ERROR_SUCCESS) {
-                cpu_metrics_.current_clock_mhz = static_cast<uint32_t>(counter_val.largeValue);
-                cpu_metrics_.base_clock_mhz = cpu_metrics_.current_clock_mhz; // Simplified
-            }
+        if (Assign(cpu_metrics_.current_clock_mhz, in.cpu_frequency_mhz)) {
+            cpu_metrics_.base_clock_mhz = cpu_metrics_.current_clock_mhz; // Simplified
         }
+
+        Assign(cpu_metrics_.effective_clock_mhz, in.cpu_effective_clock_mhz);
+        Assign(cpu_metrics_.performance_limit_percent, in.cpu_performance_limit_percent);
+        Assign(cpu_metrics_.throttled_cores, in.cpu_throttled_cores);
+        Assign(cpu_metrics_.throttled_seconds, in.cpu_throttled_seconds);
+        Assign(cpu_metrics_.frequency_loss_mhz, in.cpu_frequency_loss_mhz);
         
         // Estimate CPU temperature (Windows doesn't expose this easily)
         // This is a rough estimation based on load
@@ -296,14 +520,27 @@ namespace PCMonitor {
         cpu_metrics_.l3_cache_mb = cpu_metrics_.core_count * 2; // Rough estimate: 2MB per core
     }
 
-    void PerformanceMonitor::CollectRAMMetrics() {
+    void PerformanceMonitor::ReadRAMInputs() {
+        CollectorInputs& in = inputs_;
         MEMORYSTATUSEX mem_status;
         mem_status.dwLength = sizeof(mem_status);
         
-        if (GlobalMemoryStatusEx(&mem_status)) {
-            ram_metrics_.total_mb = static_cast<uint64_t>(mem_status.ullTotalPhys / (1024 * 1024));
-            ram_metrics_.used_mb = static_cast<uint64_t>((mem_status.ullTotalPhys - mem_status.ullAvailPhys) / (1024 * 1024));
-            ram_metrics_.utilization_percent = static_cast<double>(mem_status.dwMemoryLoad);
+        bool read = GlobalMemoryStatusEx(&mem_status) != 0;
+        in.memory_total_bytes = read ? static_cast<double>(mem_status.ullTotalPhys) : NAN;
+        in.memory_available_bytes = read ? static_cast<double>(mem_status.ullAvailPhys) : NAN;
+        in.memory_load_percent = read ? static_cast<double>(mem_status.dwMemoryLoad) : NAN;
+    }
+
+    void PerformanceMonitor::CollectRAMMetrics() {
+        if (!replay_) ReadRAMInputs();
+        const CollectorInputs& in = inputs_;
+
+        if (!std::isnan(in.memory_total_bytes)) {
+            uint64_t total = static_cast<uint64_t>(in.memory_total_bytes);
+            uint64_t available = static_cast<uint64_t>(in.memory_available_bytes);
+            ram_metrics_.total_mb = total / (1024 * 1024);
+            ram_metrics_.used_mb = (total - available) / (1024 * 1024);
+            ram_metrics_.utilization_percent = in.memory_load_percent;
         }
         
         // Get memory speed from WMI (simplified - would need full WMI implementation)
@@ -312,24 +549,61 @@ namespace PCMonitor {
         ram_metrics_.latency_cl = 16;  // CL16 assumption
     }
 
-    void PerformanceMonitor::CollectStorageMetrics() {
-        PDH_FMT_COUNTERVALUE counter_val;
-        
-        // Read speed
-        auto it = performance_counters_.find("disk_read");
-        if (it != performance_counters_.end()) {
-            if (PdhGetFormattedCounterValue(it->second, PDH_FMT_LARGE, nullptr, &counter_val) == ERROR_SUCCESS) {
-                storage_metrics_.seq_read_mbps = static_cast<uint64_t>(counter_val.largeValue / (1024 * 1024));
+    void PerformanceMonitor::ReadStorageInputs() {
+        inputs_.disk_read_bytes_per_sec = ReadLargeCounter("disk_read");
+        inputs_.disk_write_bytes_per_sec = ReadLargeCounter("disk_write");
+
+        // Fullest fixed volume; removable and network drives are skipped so a
+        // slow share can't stall the cycle
+        CollectorInputs& in = inputs_;
+        in.volume_used_gb = NAN;
+        in.volume_capacity_gb = NAN;
+        double fullest = -1.0;
+        DWORD drives = GetLogicalDrives();
+        for (char letter = 'A'; letter <= 'Z'; ++letter) {
+            if (!(drives & (1u << (letter - 'A')))) continue;
+
+            char root[] = { letter, ':', '\\', '\0' };
+            if (GetDriveTypeA(root) != DRIVE_FIXED) continue;
+
+            ULARGE_INTEGER free_bytes, total_bytes, total_free_bytes;
+            if (!GetDiskFreeSpaceExA(root, &free_bytes, &total_bytes, &total_free_bytes) || total_bytes.QuadPart == 0) continue;
+
+            double used = static_cast<double>(total_bytes.QuadPart - total_free_bytes.QuadPart);
+            double share = used / static_cast<double>(total_bytes.QuadPart);
+            if (share > fullest) {
+                fullest = share;
+                in.volume_used_gb = used / (1024.0 * 1024.0 * 1024.0);
+                in.volume_capacity_gb = static_cast<double>(total_bytes.QuadPart) / (1024.0 * 1024.0 * 1024.0);
             }
         }
-        
-        // Write speed
-        it = performance_counters_.find("disk_write");
-        if (it != performance_counters_.end()) {
-            if (PdhGetFormattedCounterValue(it->second, PDH_FMT_LARGE, nullptr, &counter_val) == ERROR_SUCCESS) {
-                storage_metrics_.seq_write_mbps = static_cast<uint64_t>(counter_val.largeValue / (1024 * 1024));
-            }
+    }
+
+    void PerformanceMonitor::CollectStorageMetrics() {
+        if (!replay_) ReadStorageInputs();
+        const CollectorInputs& in = inputs_;
+
+        // Read and write speed
+        if (!std::isnan(in.disk_read_bytes_per_sec)) {
+            storage_metrics_.seq_read_mbps = static_cast<uint64_t>(in.disk_read_bytes_per_sec) / (1024 * 1024);
+        }
+        if (!std::isnan(in.disk_write_bytes_per_sec)) {
+            storage_metrics_.seq_write_mbps = static_cast<uint64_t>(in.disk_write_bytes_per_sec) / (1024 * 1024);
         }
+
+        // Burst windows hold bytes/s; summarize before the placeholder values below
+        const double kMB = 1024.0 * 1024.0;
+        BurstSummary read = TakeBurst(BurstDiskRead, static_cast<double>(storage_metrics_.seq_read_mbps) * kMB);
+        storage_metrics_.read_mean_mbps = static_cast<uint64_t>(read.mean / kMB);
+        storage_metrics_.read_min_mbps = static_cast<uint64_t>(read.min / kMB);
+        storage_metrics_.read_max_mbps = static_cast<uint64_t>(read.max / kMB);
+        storage_metrics_.read_p99_mbps = static_cast<uint64_t>(read.p99 / kMB);
+
+        BurstSummary write = TakeBurst(BurstDiskWrite, static_cast<double>(storage_metrics_.seq_write_mbps) * kMB);
+        storage_metrics_.write_mean_mbps = static_cast<uint64_t>(write.mean / kMB);
+        storage_metrics_.write_min_mbps = static_cast<uint64_t>(write.min / kMB);
+        storage_metrics_.write_max_mbps = static_cast<uint64_t>(write.max / kMB);
+        storage_metrics_.write_p99_mbps = static_cast<uint64_t>(write.p99 / kMB);
         
         // Estimate IOPS (very rough approximation)
         storage_metrics_.random_read_iops = storage_metrics_.seq_read_mbps * 256; // Rough estimate
@@ -345,33 +619,41 @@ namespace PCMonitor {
         
         storage_metrics_.temperature_c = 45; // Typical SSD temperature
         storage_metrics_.health_percent = 98.5; // Good health
+
+        Assign(storage_metrics_.volume_used_gb, in.volume_used_gb);
+        Assign(storage_metrics_.volume_capacity_gb, in.volume_capacity_gb);
+    }
+
+    void PerformanceMonitor::ReadNetworkInputs() {
+        // Wildcard counters: the sum over all interfaces
+        inputs_.net_received_bytes_per_sec = ReadLargeCounter("net_recv");
+        inputs_.net_sent_bytes_per_sec = ReadLargeCounter("net_send");
     }
 
     void PerformanceMonitor::CollectNetworkMetrics() {
-        PDH_FMT_COUNTERVALUE counter_val;
-        uint64_t bytes_recv_sec = 0;
-        uint64_t bytes_sent_sec = 0;
-
-        // Bytes Received/sec (wildcard sums all interfaces)
-        auto it = performance_counters_.find("net_recv");
-        if (it != performance_counters_.end()) {
-            if (PdhGetFormattedCounterValue(it->second, PDH_FMT_LARGE, nullptr, &counter_val) == ERROR_SUCCESS) {
-                bytes_recv_sec = static_cast<uint64_t>(counter_val.largeValue);
-            }
-        }
+        if (!replay_) ReadNetworkInputs();
+        const CollectorInputs& in = inputs_;
 
-        // Bytes Sent/sec
-        it = performance_counters_.find("net_send");
-        if (it != performance_counters_.end()) {
-            if (PdhGetFormattedCounterValue(it->second, PDH_FMT_LARGE, nullptr, &counter_val) == ERROR_SUCCESS) {
-                bytes_sent_sec = static_cast<uint64_t>(counter_val.largeValue);
-            }
-        }
+        // An unreadable counter counts as no traffic
+        uint64_t bytes_recv_sec = std::isnan(in.net_received_bytes_per_sec) ? 0 : static_cast<uint64_t>(in.net_received_bytes_per_sec);
+        uint64_t bytes_sent_sec = std::isnan(in.net_sent_bytes_per_sec) ? 0 : static_cast<uint64_t>(in.net_sent_bytes_per_sec);
 
         // Convert bytes/s to KB/s
         network_metrics_.download_speed_kbps = bytes_recv_sec / 1024;
         network_metrics_.upload_speed_kbps = bytes_sent_sec / 1024;
 
+        BurstSummary download = TakeBurst(BurstNetReceive, static_cast<double>(bytes_recv_sec));
+        network_metrics_.download_mean_kbps = static_cast<uint64_t>(download.mean / 1024);
+        network_metrics_.download_min_kbps = static_cast<uint64_t>(download.min / 1024);
+        network_metrics_.download_max_kbps = static_cast<uint64_t>(download.max / 1024);
+        network_metrics_.download_p99_kbps = static_cast<uint64_t>(download.p99 / 1024);
+
+        BurstSummary upload = TakeBurst(BurstNetSend, static_cast<double>(bytes_sent_sec));
+        network_metrics_.upload_mean_kbps = static_cast<uint64_t>(upload.mean / 1024);
+        network_metrics_.upload_min_kbps = static_cast<uint64_t>(upload.min / 1024);
+        network_metrics_.upload_max_kbps = static_cast<uint64_t>(upload.max / 1024);
+        network_metrics_.upload_p99_kbps = static_cast<uint64_t>(upload.p99 / 1024);
+
         // Accumulate session totals (interval is ~1 second)
         total_bytes_received_ += bytes_recv_sec;
         total_bytes_sent_ += bytes_sent_sec;
@@ -379,27 +661,49 @@ namespace PCMonitor {
         network_metrics_.total_sent_mb = total_bytes_sent_ / (1024 * 1024);
     }
 
+    void PerformanceMonitor::ReadPowerInputs() {
+        inputs_.package_power_w = ReadEnergyMeters(package_power_counters_);
+        inputs_.dram_power_w = ReadEnergyMeters(dram_power_counters_);
+    }
+
     void PerformanceMonitor::CollectPowerMetrics() {
+        if (!replay_) ReadPowerInputs();
+
         // Power metrics estimation based on component usage
         power_metrics_.psu_wattage = 850; // From system specs
         
-        // Estimate CPU power based on utilization and frequency
-        double cpu_load_factor = cpu_metrics_.utilization_percent / 100.0;
-        double freq_factor = static_cast<double>(cpu_metrics_.current_clock_mhz) / 3700.0; // Normalize to base frequency
-        uint32_t cpu_tdp = 125; // Typical high-end CPU TDP
-        power_metrics_.cpu_power_w = static_cast<uint32_t>(25 + (cpu_tdp - 25) * cpu_load_factor * freq_factor);
-        
-        // GPU power (from NVML if available, otherwise estimate)
-        power_metrics_.gpu_power_w = gpu_metrics_.power_draw_w;
-        if (power_metrics_.gpu_power_w == 0) {
-            // Estimate GPU power
-            double gpu_load_factor = gpu_metrics_.utilization_percent / 100.0;
-            power_metrics_.gpu_power_w = static_cast<uint32_t>(30 + 320 * gpu_load_factor); // 30W idle, 350W max
-        }
-        
+        PowerFeatures features;
+        features.cpu_utilization = cpu_metrics_.utilization_percent / 100.0;
+        features.cpu_clock_ghz = cpu_metrics_.effective_clock_mhz / 1000.0;
+        features.gpu_utilization = gpu_metrics_.utilization_percent / 100.0;
+        features.gpu_clock_ghz = gpu_metrics_.core_clock_mhz / 1000.0;
+        features.ram_total_gb = ram_metrics_.total_mb / 1024.0;
+        features.ram_utilization = ram_metrics_.utilization_percent / 100.0;
+
+        // Each domain: the measurement where there is one (which also
+        // calibrates the model), the model's estimate otherwise
+        auto domain_power = [&](PowerModel::Domain domain, double measured_w) {
+            if (std::isfinite(measured_w) && measured_w > 0.0) {
+                power_model_.Fit(domain, features, measured_w);
+                return static_cast<uint32_t>(measured_w + 0.5);
+            }
+            return static_cast<uint32_t>(power_model_.Estimate(domain, features) + 0.5);
+        };
+
+        power_metrics_.cpu_power_w = domain_power(PowerModel::Cpu, inputs_.package_power_w);
+        power_metrics_.gpu_power_w = domain_power(PowerModel::Gpu, gpu_power_measured_ ? gpu_metrics_.power_draw_w : NAN);
+        power_metrics_.ram_power_w = domain_power(PowerModel::Ram, inputs_.dram_power_w);
+
+        power_metrics_.cpu_model_error_w = power_model_.GetError(PowerModel::Cpu);
+        power_metrics_.gpu_model_error_w = power_model_.GetError(PowerModel::Gpu);
+        power_metrics_.ram_model_error_w = power_model_.GetError(PowerModel::Ram);
+        power_metrics_.cpu_model_samples = power_model_.GetSamples(PowerModel::Cpu);
+        power_metrics_.gpu_model_samples = power_model_.GetSamples(PowerModel::Gpu);
+        power_metrics_.ram_model_samples = power_model_.GetSamples(PowerModel::Ram);
+
         // Other system components
         uint32_t motherboard_power = 25;  // Motherboard, chipset
-        uint32_t ram_power = static_cast<uint32_t>(ram_metrics_.total_mb / 1024 * 3); // ~3W per GB
+        uint32_t ram_power = power_metrics_.ram_power_w;
         uint32_t storage_power = 8;       // SSD power
         uint32_t fans_power = 15;         // Case fans
         uint32_t misc_power = 20;         // USB devices, etc.
@@ -451,47 +755,168 @@ namespace PCMonitor {
 
     void PerformanceMonitor::LogMetrics() {
         if (!log_file_.is_open()) return;
-        
-        auto now = std::chrono::system_clock::now();
-        auto time_t = std::chrono::system_clock::to_time_t(now);
-        
-        log_file_ << std::put_time(std::localtime(&time_t), "%Y-%m-%d %H:%M:%S") << ","
-                  << gpu_metrics_.vram_used_mb << ","
-                  << gpu_metrics_.core_clock_mhz << ","
-                  << gpu_metrics_.temperature_c << ","
-                  << gpu_metrics_.utilization_percent << ","
-                  << cpu_metrics_.current_clock_mhz << ","
-                  << std::fixed << std::setprecision(2) << cpu_metrics_.utilization_percent << ","
-                  << cpu_metrics_.temperature_c << ","
-                  << ram_metrics_.used_mb << ","
-                  << std::fixed << std::setprecision(2) << ram_metrics_.utilization_percent << ","
-                  << storage_metrics_.seq_read_mbps << ","
-                  << storage_metrics_.seq_write_mbps << ","
-                  << power_metrics_.system_power_w << ","
-                  << std::fixed << std::setprecision(2) << power_metrics_.efficiency_percent << "\n";
-        
+
+        // Only this thread writes snapshot_, so it can be read without the lock
+        log_line_.clear();
+        WriteCsvRow(snapshot_.timestamp, snapshot_.metrics, log_line_);
+        log_file_.write(log_line_.data(), static_cast<std::streamsize>(log_line_.size()));
         log_file_.flush(); // Ensure data is written immediately
     }
 
+    void PerformanceMonitor::PublishSnapshot() {
+        MetricsSnapshot snapshot;
+        {
+            std::lock_guard<std::mutex> lock(snapshot_mutex_);
+            snapshot_.version = snapshot_version_.load(std::memory_order_relaxed) + 1;
+            snapshot_.timestamp = replay_ ? replay_unix_ : static_cast<int64_t>(std::time(nullptr));
+            snapshot_.metrics.gpu = gpu_metrics_;
+            snapshot_.metrics.cpu = cpu_metrics_;
+            snapshot_.metrics.ram = ram_metrics_;
+            snapshot_.metrics.storage = storage_metrics_;
+            snapshot_.metrics.network = network_metrics_;
+            snapshot_.metrics.power = power_metrics_;
+            snapshot_.metrics.thermal = thermal_metrics_;
+            snapshot_version_.store(snapshot_.version, std::memory_order_release);
+            snapshot = snapshot_;
+            collector_latencies_ = latency_work_;
+        }
+
+        std::lock_guard<std::mutex> lock(listeners_mutex_);
+        for (const auto& listener : snapshot_listeners_) {
+            listener(snapshot);
+        }
+    }
+
+    void PerformanceMonitor::PublishMetrics(const SystemMetrics& metrics) {
+        gpu_metrics_ = metrics.gpu;
+        cpu_metrics_ = metrics.cpu;
+        ram_metrics_ = metrics.ram;
+        storage_metrics_ = metrics.storage;
+        network_metrics_ = metrics.network;
+        power_metrics_ = metrics.power;
+        thermal_metrics_ = metrics.thermal;
+        PublishSnapshot();
+    }
+
+    MetricsSnapshot PerformanceMonitor::GetSnapshot() const {
+        std::lock_guard<std::mutex> lock(snapshot_mutex_);
+        return snapshot_;
+    }
+
+    CollectorLatencies PerformanceMonitor::GetCollectorLatencies() const {
+        std::lock_guard<std::mutex> lock(snapshot_mutex_);
+        return collector_latencies_;
+    }
+
+    void PerformanceMonitor::CollectBurstSample() {
+        PdhCollectQueryData(burst_query_);
+
+        PDH_FMT_COUNTERVALUE counter_val;
+        double values[BurstSeriesCount];
+        for (size_t i = 0; i < BurstSeriesCount; ++i) {
+            // The first collection only sets the baseline and fails to format
+            values[i] = NAN;
+            if (burst_counters_[i] &&
+                PdhGetFormattedCounterValue(burst_counters_[i], PDH_FMT_DOUBLE, nullptr, &counter_val) == ERROR_SUCCESS) {
+                values[i] = counter_val.doubleValue;
+                burst_windows_[i].Add(counter_val.doubleValue);
+            }
+        }
+
+        if (recording_) {
+            recording_->WriteBurst(std::chrono::steady_clock::now(), values);
+        }
+    }
+
+    BurstSummary PerformanceMonitor::TakeBurst(BurstSeries series, double fallback) {
+        return burst_windows_[series].Take(fallback);
+    }
+
+    void PerformanceMonitor::SleepSampling(std::chrono::milliseconds duration) {
+        auto deadline = std::chrono::steady_clock::now() + duration;
+        if (!burst_query_ || burst_interval_.count() == 0) {
+            std::this_thread::sleep_until(deadline);
+            return;
+        }
+
+        // Burst ticks are scheduled from the previous tick, not from when it
+        // finished, so collection time doesn't stretch the spacing
+        auto next = std::chrono::steady_clock::now() + burst_interval_;
+        while (running_ && next < deadline) {
+            std::this_thread::sleep_until(next);
+            CollectBurstSample();
+
+            auto now = std::chrono::steady_clock::now();
+            {
+                std::lock_guard<std::mutex> lock(listeners_mutex_);
+                for (const auto& listener : burst_listeners_) {
+                    listener(now);
+                }
+            }
+            next += burst_interval_;
+        }
+        std::this_thread::sleep_until(deadline);
+    }
+
+    void PerformanceMonitor::TimeCollector(CollectorId id, void (PerformanceMonitor::*collect)()) {
+        auto start = std::chrono::steady_clock::now();
+        (this->*collect)();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        latency_work_.collectors[static_cast<size_t>(id)].Record(elapsed.count());
+    }
+
+    void PerformanceMonitor::AddSnapshotListener(std::function<void(const MetricsSnapshot&)> listener) {
+        std::lock_guard<std::mutex> lock(listeners_mutex_);
+        snapshot_listeners_.push_back(std::move(listener));
+    }
+
+    void PerformanceMonitor::AddBurstListener(std::function<void(std::chrono::steady_clock::time_point)> listener) {
+        std::lock_guard<std::mutex> lock(listeners_mutex_);
+        burst_listeners_.push_back(std::move(listener));
+    }
+
+    void PerformanceMonitor::RunCycle() {
+        auto start_time = std::chrono::high_resolution_clock::now();
+
+        // Collect all metrics, timing each collector for self-monitoring
+        TimeCollector(CollectorId::GPU, &PerformanceMonitor::CollectGPUMetrics);
+        TimeCollector(CollectorId::CPU, &PerformanceMonitor::CollectCPUMetrics);
+        TimeCollector(CollectorId::RAM, &PerformanceMonitor::CollectRAMMetrics);
+        TimeCollector(CollectorId::Storage, &PerformanceMonitor::CollectStorageMetrics);
+        TimeCollector(CollectorId::Network, &PerformanceMonitor::CollectNetworkMetrics);
+        TimeCollector(CollectorId::Power, &PerformanceMonitor::CollectPowerMetrics);
+        TimeCollector(CollectorId::Thermal, &PerformanceMonitor::CollectThermalMetrics);
+
+        std::chrono::duration<double> cycle_time = std::chrono::high_resolution_clock::now() - start_time;
+        latency_work_.collectors[static_cast<size_t>(CollectorId::Cycle)].Record(cycle_time.count());
+
+        if (recording_) {
+            recording_->WriteCycle(std::chrono::steady_clock::now(), inputs_);
+        }
+
+        // Make the cycle visible to readers (web server, stream)
+        PublishSnapshot();
+        
+        // Log to file
+        LogMetrics();
+    }
+
     void PerformanceMonitor::MonitoringLoop() {
+        AgentPolicy::ApplyToCurrentThread(ThreadRole::Sampler);
+
         // Initial data collection to establish baseline
         PdhCollectQueryData(cpu_query_);
+        // Default timer resolution (~15.6 ms) would stretch 20 ms burst ticks
+        if (burst_query_) {
+            timeBeginPeriod(1);
+            PdhCollectQueryData(burst_query_);
+        }
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
         
         while (running_) {
             auto start_time = std::chrono::high_resolution_clock::now();
-            
-            // Collect all metrics
-            CollectGPUMetrics();
-            CollectCPUMetrics();
-            CollectRAMMetrics();
-            CollectStorageMetrics();
-            CollectNetworkMetrics();
-            CollectPowerMetrics();
-            CollectThermalMetrics();
-            
-            // Log to file
-            LogMetrics();
+
+            RunCycle();
             
             auto end_time = std::chrono::high_resolution_clock::now();
             auto collection_time = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
@@ -499,16 +924,85 @@ namespace PCMonitor {
             // Sleep for remaining interval time
             auto sleep_time = collection_interval_ - collection_time;
             if (sleep_time > std::chrono::milliseconds(0)) {
-                std::this_thread::sleep_for(sleep_time);
+                SleepSampling(sleep_time);
+            }
+        }
+
+        if (burst_query_) {
+            timeEndPeriod(1);
+        }
+    }
+
+    // A burst sample feeds the burst windows; a cycle runs the collectors,
+    // publish and log on the recorded inputs
+    void PerformanceMonitor::ApplyReplayRecord(const RecordingReader::Record& record,
+                                               std::chrono::steady_clock::time_point time) {
+        if (record.type == RecordingReader::RecordType::Burst) {
+            for (size_t i = 0; i < BurstSeriesCount; ++i) {
+                if (!std::isnan(record.burst[i])) burst_windows_[i].Add(record.burst[i]);
             }
+
+            std::lock_guard<std::mutex> lock(listeners_mutex_);
+            for (const auto& listener : burst_listeners_) {
+                listener(time);
+            }
+            return;
         }
+
+        inputs_ = record.inputs;
+        replay_unix_ = replay_->GetHeader().start_unix + static_cast<int64_t>(record.offset_us / 1000000);
+        RunCycle();
+    }
+
+    bool PerformanceMonitor::ReplayCycle() {
+        if (!replay_ || running_) return false;
+
+        RecordingReader::Record record;
+        while (replay_->Next(record)) {
+            ApplyReplayRecord(record, std::chrono::steady_clock::now());
+            if (record.type == RecordingReader::RecordType::Cycle) return true;
+        }
+        return false;
+    }
+
+    // Feeds the recording through the same collectors, publish and log as
+    // a live run, paced by the recorded offsets divided by the speed
+    void PerformanceMonitor::ReplayLoop() {
+        AgentPolicy::ApplyToCurrentThread(ThreadRole::Sampler);
+
+        auto start = std::chrono::steady_clock::now();
+        uint64_t cycles = 0;
+        uint64_t last_offset_us = 0;
+
+        RecordingReader::Record record;
+        while (running_ && replay_->Next(record)) {
+            auto due = start;
+            if (replay_speed_ > 0.0) {
+                due += std::chrono::microseconds(static_cast<int64_t>(record.offset_us / replay_speed_));
+                std::this_thread::sleep_until(due);
+            }
+            last_offset_us = record.offset_us;
+
+            ApplyReplayRecord(record, replay_speed_ > 0.0 ? due : std::chrono::steady_clock::now());
+            if (record.type == RecordingReader::RecordType::Cycle) cycles++;
+        }
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        double recorded = last_offset_us / 1e6;
+        std::cout << "Replay finished: " << cycles << " cycles, " << std::fixed << std::setprecision(1)
+                  << recorded << " s recorded in " << elapsed.count() << " s";
+        if (elapsed.count() > 0.0) {
+            std::cout << " (" << recorded / elapsed.count() << "x real time)";
+        }
+        std::cout << std::defaultfloat << std::endl;
     }
 
     bool PerformanceMonitor::Start() {
         if (running_) return false;
         
         running_ = true;
-        monitor_thread_ = std::make_unique<std::thread>(&PerformanceMonitor::MonitoringLoop, this);
+        monitor_thread_ = std::make_unique<std::thread>(
+            replay_ ? &PerformanceMonitor::ReplayLoop : &PerformanceMonitor::MonitoringLoop, this);
         
         return true;
     }
@@ -523,18 +1017,45 @@ namespace PCMonitor {
         }
         
         monitor_thread_.reset();
+
+        // Off the sampling path: the model is persisted only here
+        power_model_.Save();
+
+        if (recording_) {
+            recording_->Close();
+            std::cout << "Recorded " << recording_->GetCycles() << " cycles and "
+                      << recording_->GetBursts() << " burst samples to " << record_path_ << std::endl;
+        }
     }
 
     void PerformanceMonitor::SetCollectionInterval(std::chrono::milliseconds interval) {
         collection_interval_ = interval;
     }
 
+    void PerformanceMonitor::SetPowerModelFile(const std::string& filename) {
+        power_model_.SetPath(filename);
+    }
+
+    void PerformanceMonitor::SetRecordFile(const std::string& filename) {
+        record_path_ = filename;
+    }
+
+    void PerformanceMonitor::SetReplayFile(const std::string& filename, double speed) {
+        replay_path_ = filename;
+        replay_speed_ = speed;
+    }
+
+    void PerformanceMonitor::SetBurstInterval(std::chrono::milliseconds interval) {
+        burst_interval_ = interval;
+    }
+
     void PerformanceMonitor::SetLogFile(const std::string& filename) {
         if (log_file_.is_open()) {
             log_file_.close();
         }
         
-        log_file_.open(filename, std::ios::app);
+        log_path_ = filename;
+        OpenCsvLog(log_file_, filename);
     }
 
 }
@@ -0,0 +1,150 @@
+#include "power_model.h"
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace PCMonitor {
+
+    namespace {
+
+        // The fixed estimates the monitor used before calibration
+        const double kInitial[PowerModel::DomainCount][PowerModel::kFeatures] = {
+            { 25.0, 0.0, 100.0 / 3.7 },
+            { 30.0, 320.0, 0.0 },
+            { 3.0, 0.0, 0.0 },
+        };
+        const char* const kDomainNames[PowerModel::DomainCount] = { "cpu", "gpu", "ram" };
+
+        // Version 2 changed the RAM regressors; a version 1 RAM line means
+        // something else and is ignored
+        constexpr int kFileVersion = 2;
+        const char kFileHeader[] = "# pc_monitor power model v2: domain samples error_w a b c";
+
+        bool AllFinite(const double* values, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                if (!std::isfinite(values[i])) return false;
+            }
+            return true;
+        }
+
+        // Initial covariance: loose around the defaults, tight around a
+        // model that has already been fitted
+        constexpr double kDefaultConfidence = 100.0;
+        constexpr double kLoadedConfidence = 1.0;
+
+        constexpr double kErrorAlpha = 0.01;
+
+    }
+
+    PowerModel::PowerModel(std::string path)
+        : path_(std::move(path))
+        , domains_{
+            { RecursiveLeastSquares<kFeatures>(kInitial[Cpu], kDefaultConfidence, kForgetting, kMaxVariance), 0.0, 0 },
+            { RecursiveLeastSquares<kFeatures>(kInitial[Gpu], kDefaultConfidence, kForgetting, kMaxVariance), 0.0, 0 },
+            { RecursiveLeastSquares<kFeatures>(kInitial[Ram], kDefaultConfidence, kForgetting, kMaxVariance), 0.0, 0 },
+        }
+    {
+    }
+
+    void PowerModel::Features(Domain domain, const PowerFeatures& features, double (&x)[kFeatures]) {
+        x[0] = 1.0;
+        switch (domain) {
+            case Cpu:
+                x[1] = features.cpu_utilization;
+                x[2] = features.cpu_utilization * features.cpu_clock_ghz;
+                break;
+            case Gpu:
+                x[1] = features.gpu_utilization;
+                x[2] = features.gpu_utilization * features.gpu_clock_ghz;
+                break;
+            default:
+                x[0] = features.ram_total_gb;
+                x[1] = features.ram_total_gb * features.ram_utilization;
+                x[2] = 0.0;
+                break;
+        }
+    }
+
+    double PowerModel::Estimate(Domain domain, const PowerFeatures& features) const {
+        double x[kFeatures];
+        Features(domain, features, x);
+        double watts = domains_[domain].fit.Predict(x);
+        return std::isfinite(watts) && watts > 0.0 ? watts : 0.0;
+    }
+
+    void PowerModel::Fit(Domain domain, const PowerFeatures& features, double measured_w) {
+        if (!std::isfinite(measured_w) || measured_w <= 0.0) return;
+
+        double x[kFeatures];
+        Features(domain, features, x);
+
+        DomainFit& fit = domains_[domain];
+        double error = std::fabs(fit.fit.Update(x, measured_w));
+        if (!std::isfinite(error)) return;
+        fit.error_w = fit.samples == 0 ? error : fit.error_w + kErrorAlpha * (error - fit.error_w);
+        fit.samples++;
+    }
+
+    // One line per domain: <name> <samples> <error_w> <coefficients...>
+    bool PowerModel::Load() {
+        std::ifstream file(path_);
+        if (!file.is_open()) return false;
+
+        bool loaded = false;
+        int version = 1;
+        std::string line;
+        while (std::getline(file, line)) {
+            if (line.rfind("# pc_monitor power model v", 0) == 0) {
+                version = std::atoi(line.c_str() + strlen("# pc_monitor power model v"));
+            }
+            if (line.empty() || line[0] == '#') continue;
+
+            std::istringstream fields(line);
+            std::string name;
+            uint64_t samples = 0;
+            double error = 0.0;
+            double coefficients[kFeatures];
+            fields >> name >> samples >> error;
+            for (double& coefficient : coefficients) fields >> coefficient;
+            // A corrupt model would poison every estimate; keep the defaults
+            if (fields.fail() || !std::isfinite(error) || !AllFinite(coefficients, kFeatures)) continue;
+
+            for (size_t d = 0; d < DomainCount; ++d) {
+                if (name != kDomainNames[d]) continue;
+                if (d == Ram && version < kFileVersion) continue;
+                domains_[d].fit.Reset(coefficients, kLoadedConfidence);
+                domains_[d].samples = samples;
+                domains_[d].error_w = error;
+                loaded = true;
+            }
+        }
+        return loaded;
+    }
+
+    bool PowerModel::Save() {
+        if (path_.empty()) return false;
+
+        // Never replace a good file with one Load() would reject
+        for (size_t d = 0; d < DomainCount; ++d) {
+            if (!std::isfinite(domains_[d].error_w) || !AllFinite(domains_[d].fit.GetCoefficients(), kFeatures)) {
+                return false;
+            }
+        }
+
+        std::ofstream file(path_, std::ios::trunc);
+        if (!file.is_open()) return false;
+
+        file << kFileHeader << '\n';
+        file.precision(9);
+        for (size_t d = 0; d < DomainCount; ++d) {
+            const double* coefficients = domains_[d].fit.GetCoefficients();
+            file << kDomainNames[d] << ' ' << domains_[d].samples << ' ' << domains_[d].error_w;
+            for (size_t i = 0; i < kFeatures; ++i) file << ' ' << coefficients[i];
+            file << '\n';
+        }
+        return file.good();
+    }
+
+}
@@ -0,0 +1,233 @@
+#include "prometheus_exporter.h"
+#include <charconv>
+#include <cmath>
+#include <cstring>
+
+namespace PCMonitor {
+
+    namespace {
+
+        struct ServerStatInfo {
+            const char* name;
+            const char* type;
+            const char* help;
+            uint64_t ServerStats::*value;
+            double ServerStats::*seconds = nullptr;     // Used instead when value is null
+        };
+
+        constexpr ServerStatInfo kServerStats[] = {
+            { "pcmonitor_stream_subscribers", "gauge", "Clients connected to /api/stream and /api/stream.bin.", &ServerStats::stream_subscribers },
+            { "pcmonitor_subscriptions", "gauge", "Clients connected to /api/subscribe.", &ServerStats::subscriptions },
+            { "pcmonitor_subscription_groups", "gauge", "Distinct (fields, interval) subscriptions, each encoded once per tick.", &ServerStats::subscription_groups },
+            { "pcmonitor_subscription_frames_encoded_total", "counter", "Subscription frames encoded.", &ServerStats::subscription_frames_encoded },
+            { "pcmonitor_subscription_frames_sent_total", "counter", "Subscription frames queued to clients; the excess over encoded frames is saved by grouping.", &ServerStats::subscription_frames_sent },
+            { "pcmonitor_snapshot_encodes_total", "counter", "Snapshots encoded for /api/metrics and /api/metrics.bin.", &ServerStats::snapshot_encodes },
+            { "pcmonitor_snapshot_cache_hits_total", "counter", "/api/metrics and /api/metrics.bin requests served from an already encoded snapshot.", &ServerStats::snapshot_cache_hits },
+            { "pcmonitor_agent_cpu_user_seconds_total", "counter", "CPU time pc_monitor itself has spent in user mode.", nullptr, &ServerStats::agent_cpu_user_seconds },
+            { "pcmonitor_agent_cpu_kernel_seconds_total", "counter", "CPU time pc_monitor itself has spent in kernel mode.", nullptr, &ServerStats::agent_cpu_kernel_seconds },
+            { "pcmonitor_agent_context_switches_total", "counter", "Context switches of pc_monitor's live threads.", &ServerStats::agent_context_switches },
+            { "pcmonitor_agent_working_set_bytes", "gauge", "pc_monitor's resident working set.", &ServerStats::agent_working_set_bytes },
+            { "pcmonitor_agent_memory_locked", "gauge", "1 if pc_monitor's working set is locked resident (--lock-memory).", &ServerStats::agent_memory_locked },
+            { "pcmonitor_anomaly_series", "gauge", "Series scored by anomaly detection.", &ServerStats::anomaly_series },
+            { "pcmonitor_anomaly_evaluations_total", "counter", "Snapshots scored by anomaly detection.", &ServerStats::anomaly_evaluations },
+            { "pcmonitor_anomaly_evaluation_seconds", "gauge", "Time the last anomaly evaluation took over all series.", nullptr, &ServerStats::anomaly_evaluation_seconds },
+            { "pcmonitor_correlation_series", "gauge", "Series in the correlation matrix.", &ServerStats::correlation_series },
+            { "pcmonitor_correlation_updates_total", "counter", "Snapshots added to the correlation matrix.", &ServerStats::correlation_updates },
+            { "pcmonitor_correlation_update_seconds", "gauge", "Time the last correlation matrix update took over all pairs.", nullptr, &ServerStats::correlation_update_seconds },
+            { "pcmonitor_alert_rules", "gauge", "Alert rules loaded.", &ServerStats::alert_rules },
+            { "pcmonitor_alerts_firing", "gauge", "Alert rules currently firing.", &ServerStats::alerts_firing },
+            { "pcmonitor_alert_evaluations_total", "counter", "Snapshots the alert rules were checked against.", &ServerStats::alert_evaluations },
+            { "pcmonitor_alert_evaluation_seconds", "gauge", "Time the last check of all alert rules took.", nullptr, &ServerStats::alert_evaluation_seconds },
+            { "pcmonitor_alert_notifications_total", "counter", "Alert webhook posts and commands that succeeded.", &ServerStats::alert_notifications },
+            { "pcmonitor_alert_notifications_failed_total", "counter", "Alert webhook posts and commands that failed or were dropped.", &ServerStats::alert_notifications_failed },
+            { "pcmonitor_events_total", "counter", "Throttling, anomaly, alert and forecast events logged.", &ServerStats::events_logged },
+            { "pcmonitor_event_subscribers", "gauge", "Clients connected to /api/events.", &ServerStats::event_subscribers },
+        };
+
+    }
+
+    PrometheusExporter::PrometheusExporter()
+        : fan_count_(0)
+        , built_(false)
+    {
+        for (const FieldGroup& group : kMetricGroups) {
+            for (size_t i = 0; i < group.field_count; ++i) {
+                fields_.push_back(&group.fields[i]);
+            }
+        }
+    }
+
+    void PrometheusExporter::BuildTemplate(size_t fan_count) {
+        segments_.clear();
+        std::string text;
+
+        auto slot = [&](SlotKind kind, size_t index) {
+            segments_.push_back(Segment{ text, kind, index });
+            text.clear();
+        };
+
+        text += "# HELP pcmonitor_snapshot_version Sequence number of the published snapshot.\n";
+        text += "# TYPE pcmonitor_snapshot_version gauge\n";
+        text += "pcmonitor_snapshot_version ";
+        slot(SlotKind::Version, 0);
+        text += "\n# HELP pcmonitor_snapshot_timestamp_seconds Unix time the snapshot was published.\n";
+        text += "# TYPE pcmonitor_snapshot_timestamp_seconds gauge\n";
+        text += "pcmonitor_snapshot_timestamp_seconds ";
+        slot(SlotKind::Timestamp, 0);
+        text += "\n";
+
+        size_t field_index = 0;
+        for (const FieldGroup& group : kMetricGroups) {
+            for (size_t i = 0; i < group.field_count; ++i, ++field_index) {
+                const FieldInfo& field = group.fields[i];
+                std::string name = std::string("pcmonitor_") + group.name + "_" + field.name;
+
+                text += "# HELP " + name + " " + group.name + " " + field.name;
+                if (field.unit[0] != '\0') {
+                    text += std::string(" (") + field.unit + ")";
+                }
+                text += ".\n# TYPE " + name + " gauge\n";
+
+                if (field.type == FieldType::U32Array) {
+                    // One labelled series per device
+                    for (size_t fan = 0; fan < fan_count; ++fan) {
+                        text += name + "{fan=\"" + std::to_string(fan) + "\"} ";
+                        slot(SlotKind::Fan, fan);
+                        text += "\n";
+                    }
+                } else {
+                    text += name + " ";
+                    slot(SlotKind::Field, field_index);
+                    text += "\n";
+                }
+            }
+        }
+
+        const char* histogram = "pcmonitor_collector_duration_seconds";
+        text += std::string("# HELP ") + histogram + " Time spent in each collector per cycle.\n";
+        text += std::string("# TYPE ") + histogram + " histogram\n";
+        for (size_t c = 0; c < kCollectorCount; ++c) {
+            std::string labels = std::string("collector=\"") + kCollectorNames[c] + "\"";
+
+            for (size_t b = 0; b <= kLatencyBucketCount; ++b) {
+                std::string le = "+Inf";
+                if (b < kLatencyBucketCount) {
+                    le.clear();
+                    AppendNumber(le, kLatencyBucketBounds[b]);
+                }
+                text += std::string(histogram) + "_bucket{" + labels + ",le=\"" + le + "\"} ";
+                slot(SlotKind::BucketCount, c * (kLatencyBucketCount + 1) + b);
+                text += "\n";
+            }
+
+            text += std::string(histogram) + "_sum{" + labels + "} ";
+            slot(SlotKind::HistogramSum, c);
+            text += "\n" + std::string(histogram) + "_count{" + labels + "} ";
+            slot(SlotKind::HistogramCount, c);
+            text += "\n";
+        }
+
+        for (size_t i = 0; i < sizeof(kServerStats) / sizeof(kServerStats[0]); ++i) {
+            const ServerStatInfo& stat = kServerStats[i];
+            text += std::string("# HELP ") + stat.name + " " + stat.help + "\n";
+            text += std::string("# TYPE ") + stat.name + " " + stat.type + "\n";
+            text += std::string(stat.name) + " ";
+            slot(SlotKind::ServerStat, i);
+            text += "\n";
+        }
+
+        tail_ = text;
+        fan_count_ = fan_count;
+        built_ = true;
+    }
+
+    void PrometheusExporter::AppendNumber(std::string& out, double value) {
+        // The exposition format spells it NaN; to_chars would write "nan"
+        if (std::isnan(value)) {
+            out += "NaN";
+            return;
+        }
+        char buffer[32];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out.append(buffer, result.ptr);
+    }
+
+    void PrometheusExporter::AppendNumber(std::string& out, uint64_t value) {
+        char buffer[24];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out.append(buffer, result.ptr);
+    }
+
+    void PrometheusExporter::Render(const MetricsSnapshot& snapshot, const CollectorLatencies& latencies,
+                                    const ServerStats& stats, std::string& out) {
+        const auto& fans = snapshot.metrics.thermal.fan_speeds_rpm;
+        const char* base = reinterpret_cast<const char*>(&snapshot.metrics);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!built_ || fan_count_ != fans.size()) {
+            BuildTemplate(fans.size());
+        }
+
+        out.clear();
+        uint64_t cumulative = 0;    // Running _bucket count of the current histogram
+        for (const Segment& segment : segments_) {
+            out += segment.text;
+
+            switch (segment.kind) {
+                case SlotKind::Field: {
+                    const FieldInfo& field = *fields_[segment.index];
+                    if (field.type == FieldType::U32) {
+                        uint32_t value;
+                        memcpy(&value, base + field.offset, sizeof(value));
+                        AppendNumber(out, static_cast<uint64_t>(value));
+                    } else if (field.type == FieldType::U64) {
+                        uint64_t value;
+                        memcpy(&value, base + field.offset, sizeof(value));
+                        AppendNumber(out, value);
+                    } else {
+                        double value;
+                        memcpy(&value, base + field.offset, sizeof(value));
+                        AppendNumber(out, value);
+                    }
+                    break;
+                }
+                case SlotKind::Fan:
+                    AppendNumber(out, static_cast<uint64_t>(fans[segment.index]));
+                    break;
+                case SlotKind::BucketCount: {
+                    // Stored per bucket; exposition wants cumulative counts. A
+                    // histogram's buckets are emitted in order, so keep a running sum.
+                    size_t collector = segment.index / (kLatencyBucketCount + 1);
+                    size_t bucket = segment.index % (kLatencyBucketCount + 1);
+                    if (bucket == 0) cumulative = 0;
+                    cumulative += latencies.collectors[collector].buckets[bucket];
+                    AppendNumber(out, cumulative);
+                    break;
+                }
+                case SlotKind::HistogramSum:
+                    AppendNumber(out, latencies.collectors[segment.index].sum_seconds);
+                    break;
+                case SlotKind::HistogramCount:
+                    AppendNumber(out, latencies.collectors[segment.index].count);
+                    break;
+                case SlotKind::Version:
+                    AppendNumber(out, snapshot.version);
+                    break;
+                case SlotKind::Timestamp:
+                    AppendNumber(out, static_cast<uint64_t>(snapshot.timestamp));
+                    break;
+                case SlotKind::ServerStat: {
+                    const ServerStatInfo& stat = kServerStats[segment.index];
+                    if (stat.value) {
+                        AppendNumber(out, stats.*stat.value);
+                    } else {
+                        AppendNumber(out, stats.*stat.seconds);
+                    }
+                    break;
+                }
+            }
+        }
+        out += tail_;
+    }
+
+}
@@ -0,0 +1,130 @@
+#include "quantile_sketch.h"
+#include <cmath>
+#include <cstring>
+
+namespace PCMonitor {
+
+    namespace {
+
+        // Bin i holds (gamma^(i-1), gamma^i] with gamma = (1 + a) / (1 - a)
+        const double kGamma = (1.0 + QuantileSketch::kRelativeAccuracy) / (1.0 - QuantileSketch::kRelativeAccuracy);
+        const double kInverseLogGamma = 1.0 / std::log(kGamma);
+
+        int32_t BinIndex(double value) {
+            return static_cast<int32_t>(std::ceil(std::log(value) * kInverseLogGamma));
+        }
+
+        // The point of the bin with the same relative error to both edges
+        double BinValue(int32_t index) {
+            return 2.0 * std::pow(kGamma, index) / (kGamma + 1.0);
+        }
+
+    }
+
+    QuantileSketch::QuantileSketch() {
+        Clear();
+    }
+
+    void QuantileSketch::Clear() {
+        memset(bins_, 0, sizeof(bins_));
+        offset_ = 0;
+        lowest_ = 1;
+        highest_ = 0;
+        zero_count_ = 0;
+        count_ = 0;
+        sum_ = 0.0;
+        min_ = 0.0;
+        max_ = 0.0;
+    }
+
+    void QuantileSketch::Add(double value) {
+        if (std::isnan(value)) return;
+
+        if (count_ == 0 || value < min_) min_ = value;
+        if (count_ == 0 || value > max_) max_ = value;
+        count_++;
+        sum_ += value;
+
+        if (value < kMinValue) {
+            zero_count_++;
+        } else {
+            AddToBin(BinIndex(value), 1);
+        }
+    }
+
+    void QuantileSketch::Merge(const QuantileSketch& other) {
+        if (other.count_ == 0) return;
+
+        if (count_ == 0 || other.min_ < min_) min_ = other.min_;
+        if (count_ == 0 || other.max_ > max_) max_ = other.max_;
+        count_ += other.count_;
+        sum_ += other.sum_;
+        zero_count_ += other.zero_count_;
+
+        for (int32_t index = other.lowest_; index <= other.highest_; ++index) {
+            uint32_t count = other.bins_[index - other.offset_];
+            if (count) AddToBin(index, count);
+        }
+    }
+
+    void QuantileSketch::AddToBin(int32_t index, uint64_t count) {
+        const int32_t bins = static_cast<int32_t>(kBins);
+
+        if (lowest_ > highest_) {
+            // First value: centre the store on it
+            offset_ = index - bins / 2;
+            lowest_ = index;
+            highest_ = index;
+        } else if (index >= offset_ + bins) {
+            Shift(index - bins + 1);
+        } else if (index < offset_) {
+            if (highest_ - index < bins) {
+                Shift(index);
+            } else {
+                index = offset_;    // Out of range below: fold into the lowest bin
+            }
+        }
+
+        bins_[index - offset_] += static_cast<uint32_t>(count);
+        if (index < lowest_) lowest_ = index;
+        if (index > highest_) highest_ = index;
+    }
+
+    void QuantileSketch::Shift(int32_t offset) {
+        // Callers keep highest_ below offset + kBins; anything under the new
+        // offset collapses into its first bin
+        uint32_t moved[kBins] = {};
+        for (int32_t index = lowest_; index <= highest_; ++index) {
+            uint32_t count = bins_[index - offset_];
+            if (!count) continue;
+            int32_t target = index < offset ? offset : index;
+            moved[target - offset] += count;
+        }
+
+        memcpy(bins_, moved, sizeof(bins_));
+        if (lowest_ < offset) lowest_ = offset;
+        offset_ = offset;
+    }
+
+    double QuantileSketch::Quantile(double q) const {
+        if (count_ == 0) return 0.0;
+        if (q <= 0.0) return min_;
+        if (q >= 1.0) return max_;
+
+        double rank = q * static_cast<double>(count_ - 1);
+        double seen = static_cast<double>(zero_count_);
+        if (rank < seen) return min_;
+
+        for (int32_t index = lowest_; index <= highest_; ++index) {
+            seen += bins_[index - offset_];
+            if (rank < seen) {
+                double value = BinValue(index);
+                if (value < min_) return min_;
+                if (value > max_) return max_;
+                return value;
+            }
+        }
+        return max_;
+    }
+
+}
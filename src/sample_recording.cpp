@@ -0,0 +1,228 @@
+#include "sample_recording.h"
+#include <cmath>
+#include <cstring>
+
+namespace PCMonitor {
+
+    namespace {
+
+        const char kMagic[4] = { 'P', 'M', 'R', 'C' };
+
+        template <typename T>
+        void Append(std::string& out, T value) {
+            out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+        }
+
+        void AppendVarint(std::string& out, uint64_t value) {
+            while (value >= 0x80) {
+                out += static_cast<char>((value & 0x7F) | 0x80);
+                value >>= 7;
+            }
+            out += static_cast<char>(value);
+        }
+
+        template <typename T>
+        bool Read(std::ifstream& in, T& value) {
+            return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+        }
+
+        double* InputValues(CollectorInputs& inputs) {
+            return reinterpret_cast<double*>(&inputs);
+        }
+
+        const double* InputValues(const CollectorInputs& inputs) {
+            return reinterpret_cast<const double*>(&inputs);
+        }
+
+    }
+
+    RecordingWriter::RecordingWriter()
+        : previous_()
+        , have_previous_(false)
+        , last_offset_us_(0)
+        , cycles_(0)
+        , bursts_(0)
+    {
+    }
+
+    bool RecordingWriter::Open(const std::string& path, const RecordingHeader& header, std::string& error) {
+        Close();
+        file_.open(path, std::ios::binary | std::ios::trunc);
+        if (!file_.is_open()) {
+            error = "cannot create " + path;
+            return false;
+        }
+
+        record_.clear();
+        record_.append(kMagic, sizeof(kMagic));
+        Append(record_, kFormatVersion);
+        Append(record_, static_cast<uint32_t>(kRecordedInputCount));
+        Append(record_, static_cast<uint32_t>(kRecordedBurstSeries));
+        Append(record_, header.core_count);
+        Append(record_, header.thread_count);
+        Append(record_, header.interval_ms);
+        Append(record_, header.burst_interval_ms);
+        Append(record_, header.start_unix);
+        file_.write(record_.data(), static_cast<std::streamsize>(record_.size()));
+        file_.flush();
+
+        have_previous_ = false;
+        start_ = std::chrono::steady_clock::now();
+        last_offset_us_ = 0;
+        cycles_ = 0;
+        bursts_ = 0;
+        return true;
+    }
+
+    void RecordingWriter::Close() {
+        if (file_.is_open()) {
+            file_.close();
+        }
+    }
+
+    void RecordingWriter::BeginRecord(uint8_t type, std::chrono::steady_clock::time_point time) {
+        auto offset = std::chrono::duration_cast<std::chrono::microseconds>(time - start_).count();
+        uint64_t offset_us = offset > 0 ? static_cast<uint64_t>(offset) : 0;
+        // Records go out in call order; a time from before the last one counts as no gap
+        uint64_t delta_us = offset_us > last_offset_us_ ? offset_us - last_offset_us_ : 0;
+        last_offset_us_ += delta_us;
+
+        record_.clear();
+        record_ += static_cast<char>(type);
+        AppendVarint(record_, delta_us);
+    }
+
+    void RecordingWriter::WriteCycle(std::chrono::steady_clock::time_point time, const CollectorInputs& inputs) {
+        if (!file_.is_open()) return;
+
+        const double* values = InputValues(inputs);
+        const double* previous = InputValues(previous_);
+        uint32_t changed = 0;
+        for (size_t i = 0; i < kRecordedInputCount; ++i) {
+            if (!have_previous_ || memcmp(&values[i], &previous[i], sizeof(double)) != 0) {
+                changed |= 1u << i;
+            }
+        }
+
+        BeginRecord(static_cast<uint8_t>(RecordingReader::RecordType::Cycle), time);
+        Append(record_, changed);
+        for (size_t i = 0; i < kRecordedInputCount; ++i) {
+            if (changed & (1u << i)) Append(record_, values[i]);
+        }
+        file_.write(record_.data(), static_cast<std::streamsize>(record_.size()));
+        file_.flush();
+
+        previous_ = inputs;
+        have_previous_ = true;
+        cycles_++;
+    }
+
+    void RecordingWriter::WriteBurst(std::chrono::steady_clock::time_point time, const double (&values)[kRecordedBurstSeries]) {
+        if (!file_.is_open()) return;
+
+        uint8_t present = 0;
+        for (size_t i = 0; i < kRecordedBurstSeries; ++i) {
+            if (!std::isnan(values[i])) present |= static_cast<uint8_t>(1u << i);
+        }
+
+        // Left in the stream buffer; the next cycle flushes it
+        BeginRecord(static_cast<uint8_t>(RecordingReader::RecordType::Burst), time);
+        record_ += static_cast<char>(present);
+        for (size_t i = 0; i < kRecordedBurstSeries; ++i) {
+            if (present & (1u << i)) Append(record_, values[i]);
+        }
+        file_.write(record_.data(), static_cast<std::streamsize>(record_.size()));
+        bursts_++;
+    }
+
+    RecordingReader::RecordingReader()
+        : header_()
+        , current_()
+        , offset_us_(0)
+    {
+        double* values = InputValues(current_);
+        for (size_t i = 0; i < kRecordedInputCount; ++i) values[i] = NAN;
+    }
+
+    bool RecordingReader::Open(const std::string& path, std::string& error) {
+        file_.open(path, std::ios::binary);
+        if (!file_.is_open()) {
+            error = "cannot open " + path;
+            return false;
+        }
+
+        char magic[sizeof(kMagic)];
+        uint32_t version = 0;
+        uint32_t input_count = 0;
+        uint32_t burst_series = 0;
+        if (!file_.read(magic, sizeof(magic)) || memcmp(magic, kMagic, sizeof(kMagic)) != 0 ||
+            !Read(file_, version) || !Read(file_, input_count) || !Read(file_, burst_series)) {
+            error = path + " is not a pc_monitor recording";
+            return false;
+        }
+        if (version != RecordingWriter::kFormatVersion) {
+            error = path + " has format version " + std::to_string(version) + ", expected " +
+                    std::to_string(RecordingWriter::kFormatVersion);
+            return false;
+        }
+        if (input_count != kRecordedInputCount || burst_series != kRecordedBurstSeries) {
+            error = path + " records " + std::to_string(input_count) + " inputs and " + std::to_string(burst_series) +
+                    " burst series; this build reads " + std::to_string(kRecordedInputCount) + " and " +
+                    std::to_string(kRecordedBurstSeries);
+            return false;
+        }
+        if (!Read(file_, header_.core_count) || !Read(file_, header_.thread_count) ||
+            !Read(file_, header_.interval_ms) || !Read(file_, header_.burst_interval_ms) ||
+            !Read(file_, header_.start_unix)) {
+            error = path + " ends inside its header";
+            return false;
+        }
+        return true;
+    }
+
+    bool RecordingReader::ReadVarint(uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            char byte;
+            if (!file_.get(byte)) return false;
+            value |= static_cast<uint64_t>(static_cast<uint8_t>(byte) & 0x7F) << shift;
+            if (!(static_cast<uint8_t>(byte) & 0x80)) return true;
+        }
+        return false;
+    }
+
+    bool RecordingReader::Next(Record& record) {
+        char type;
+        uint64_t delta_us;
+        if (!file_.get(type) || !ReadVarint(delta_us)) return false;
+
+        offset_us_ += delta_us;
+        record.offset_us = offset_us_;
+        record.type = static_cast<RecordType>(static_cast<uint8_t>(type));
+
+        switch (record.type) {
+        case RecordType::Cycle: {
+            uint32_t changed;
+            if (!Read(file_, changed)) return false;
+            double* values = InputValues(current_);
+            for (size_t i = 0; i < kRecordedInputCount; ++i) {
+                if ((changed & (1u << i)) && !Read(file_, values[i])) return false;
+            }
+            record.inputs = current_;
+            return true;
+        }
+        case RecordType::Burst: {
+            char present;
+            if (!file_.get(present)) return false;
+            for (size_t i = 0; i < kRecordedBurstSeries; ++i) {
+                record.burst[i] = NAN;
+                if ((static_cast<uint8_t>(present) & (1u << i)) && !Read(file_, record.burst[i])) return false;
+            }
+            return true;
+        }
+        }
+        // Unknown record type: nothing after it can be framed
+        return false;
+    }
+
+}
@@ -0,0 +1,193 @@
+#include "pcmonitor_shm.h"
+#include "shared_memory_publisher.h"
+#include "performance_monitor.h"
+#include <atomic>
+#include <algorithm>
+#include <iostream>
+
+namespace PCMonitor {
+
+    namespace {
+
+        // Readers get every fan the monitor can report
+        static_assert(PCMON_SHM_MAX_FANS == kMaxFans, "shared memory fan slots must match FanSpeeds");
+
+        void FlattenSnapshot(const MetricsSnapshot& snapshot, pcmon_shm_sample& out) {
+            const SystemMetrics& m = snapshot.metrics;
+            out.version = snapshot.version;
+            out.timestamp = snapshot.timestamp;
+
+            out.gpu_vram_total_mb = m.gpu.vram_total_mb;
+            out.gpu_vram_used_mb = m.gpu.vram_used_mb;
+            out.gpu_core_clock_mhz = m.gpu.core_clock_mhz;
+            out.gpu_memory_clock_mhz = m.gpu.memory_clock_mhz;
+            out.gpu_temperature_c = m.gpu.temperature_c;
+            out.gpu_power_draw_w = m.gpu.power_draw_w;
+            out.gpu_utilization_percent = m.gpu.utilization_percent;
+            out.gpu_memory_bandwidth_mbps = m.gpu.memory_bandwidth_mbps;
+
+            out.cpu_core_count = m.cpu.core_count;
+            out.cpu_thread_count = m.cpu.thread_count;
+            out.cpu_base_clock_mhz = m.cpu.base_clock_mhz;
+            out.cpu_current_clock_mhz = m.cpu.current_clock_mhz;
+            out.cpu_temperature_c = m.cpu.temperature_c;
+            out.cpu_utilization_percent = m.cpu.utilization_percent;
+            out.cpu_l3_cache_mb = m.cpu.l3_cache_mb;
+            out.cpu_utilization_mean_percent = m.cpu.utilization_mean_percent;
+            out.cpu_utilization_min_percent = m.cpu.utilization_min_percent;
+            out.cpu_utilization_max_percent = m.cpu.utilization_max_percent;
+            out.cpu_utilization_p99_percent = m.cpu.utilization_p99_percent;
+            out.cpu_effective_clock_mhz = m.cpu.effective_clock_mhz;
+            out.cpu_performance_limit_percent = m.cpu.performance_limit_percent;
+            out.cpu_throttled_cores = m.cpu.throttled_cores;
+            out.cpu_throttled_seconds = m.cpu.throttled_seconds;
+            out.cpu_frequency_loss_mhz = m.cpu.frequency_loss_mhz;
+
+            out.ram_total_mb = m.ram.total_mb;
+            out.ram_used_mb = m.ram.used_mb;
+            out.ram_speed_mhz = m.ram.speed_mhz;
+            out.ram_latency_cl = m.ram.latency_cl;
+            out.ram_utilization_percent = m.ram.utilization_percent;
+
+            out.storage_seq_read_mbps = m.storage.seq_read_mbps;
+            out.storage_seq_write_mbps = m.storage.seq_write_mbps;
+            out.storage_random_read_iops = m.storage.random_read_iops;
+            out.storage_random_write_iops = m.storage.random_write_iops;
+            out.storage_temperature_c = m.storage.temperature_c;
+            out.storage_health_percent = m.storage.health_percent;
+            out.storage_read_mean_mbps = m.storage.read_mean_mbps;
+            out.storage_read_min_mbps = m.storage.read_min_mbps;
+            out.storage_read_max_mbps = m.storage.read_max_mbps;
+            out.storage_read_p99_mbps = m.storage.read_p99_mbps;
+            out.storage_write_mean_mbps = m.storage.write_mean_mbps;
+            out.storage_write_min_mbps = m.storage.write_min_mbps;
+            out.storage_write_max_mbps = m.storage.write_max_mbps;
+            out.storage_write_p99_mbps = m.storage.write_p99_mbps;
+            out.storage_volume_used_gb = m.storage.volume_used_gb;
+            out.storage_volume_capacity_gb = m.storage.volume_capacity_gb;
+
+            out.network_download_speed_kbps = m.network.download_speed_kbps;
+            out.network_upload_speed_kbps = m.network.upload_speed_kbps;
+            out.network_total_received_mb = m.network.total_received_mb;
+            out.network_total_sent_mb = m.network.total_sent_mb;
+            out.network_download_mean_kbps = m.network.download_mean_kbps;
+            out.network_download_min_kbps = m.network.download_min_kbps;
+            out.network_download_max_kbps = m.network.download_max_kbps;
+            out.network_download_p99_kbps = m.network.download_p99_kbps;
+            out.network_upload_mean_kbps = m.network.upload_mean_kbps;
+            out.network_upload_min_kbps = m.network.upload_min_kbps;
+            out.network_upload_max_kbps = m.network.upload_max_kbps;
+            out.network_upload_p99_kbps = m.network.upload_p99_kbps;
+
+            out.power_psu_wattage = m.power.psu_wattage;
+            out.power_system_power_w = m.power.system_power_w;
+            out.power_cpu_power_w = m.power.cpu_power_w;
+            out.power_gpu_power_w = m.power.gpu_power_w;
+            out.power_efficiency_percent = m.power.efficiency_percent;
+            out.power_ram_power_w = m.power.ram_power_w;
+            out.power_cpu_model_error_w = m.power.cpu_model_error_w;
+            out.power_gpu_model_error_w = m.power.gpu_model_error_w;
+            out.power_ram_model_error_w = m.power.ram_model_error_w;
+            out.power_cpu_model_samples = m.power.cpu_model_samples;
+            out.power_gpu_model_samples = m.power.gpu_model_samples;
+            out.power_ram_model_samples = m.power.ram_model_samples;
+
+            out.thermal_cpu_temp_c = m.thermal.cpu_temp_c;
+            out.thermal_gpu_temp_c = m.thermal.gpu_temp_c;
+            out.thermal_motherboard_temp_c = m.thermal.motherboard_temp_c;
+            out.thermal_case_temp_c = m.thermal.case_temp_c;
+
+            size_t fans = std::min<size_t>(m.thermal.fan_speeds_rpm.size(), PCMON_SHM_MAX_FANS);
+            out.thermal_fan_count = static_cast<uint32_t>(fans);
+            for (size_t i = 0; i < PCMON_SHM_MAX_FANS; ++i) {
+                out.thermal_fan_speeds_rpm[i] = i < fans ? m.thermal.fan_speeds_rpm[i] : 0;
+            }
+        }
+
+    }
+
+    SharedMemoryPublisher::SharedMemoryPublisher()
+        : mapping_(nullptr)
+        , region_(nullptr)
+    {
+    }
+
+    SharedMemoryPublisher::~SharedMemoryPublisher() {
+        Close();
+    }
+
+    bool SharedMemoryPublisher::Open(PerformanceMonitor& monitor) {
+        if (region_) return false;
+
+        HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                            0, sizeof(pcmon_shm_region), PCMON_SHM_NAME);
+        if (mapping == nullptr) {
+            std::cerr << "Failed to create shared memory " << PCMON_SHM_NAME << " (error " << GetLastError() << ")" << std::endl;
+            return false;
+        }
+        if (GetLastError() == ERROR_ALREADY_EXISTS) {
+            // Another instance owns it; don't interleave writes with it
+            std::cerr << "Shared memory " << PCMON_SHM_NAME << " is already in use by another instance" << std::endl;
+            CloseHandle(mapping);
+            return false;
+        }
+
+        void* view = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, sizeof(pcmon_shm_region));
+        if (view == nullptr) {
+            CloseHandle(mapping);
+            return false;
+        }
+
+        // New mappings are zero-filled; readers check the magic last
+        region_ = static_cast<pcmon_shm_region*>(view);
+        pcmon_shm_header& header = region_->header;
+        header.layout_version = PCMON_SHM_LAYOUT_VERSION;
+        header.header_size = sizeof(pcmon_shm_header);
+        header.sample_size = sizeof(pcmon_shm_sample);
+        header.history_capacity = PCMON_SHM_HISTORY;
+        std::atomic_thread_fence(std::memory_order_release);
+        header.magic = PCMON_SHM_MAGIC;
+
+        mapping_ = mapping;
+        monitor.AddSnapshotListener([this](const MetricsSnapshot& snapshot) {
+            Publish(snapshot);
+        });
+        return true;
+    }
+
+    void SharedMemoryPublisher::Close() {
+        if (region_) {
+            UnmapViewOfFile(region_);
+            region_ = nullptr;
+        }
+        if (mapping_) {
+            CloseHandle(static_cast<HANDLE>(mapping_));
+            mapping_ = nullptr;
+        }
+    }
+
+    void SharedMemoryPublisher::Publish(const MetricsSnapshot& snapshot) {
+        if (!region_) return;
+
+        // Flatten outside the critical section so readers retry as little as possible
+        pcmon_shm_sample sample;
+        FlattenSnapshot(snapshot, sample);
+
+        pcmon_shm_header& header = region_->header;
+        uint64_t sequence = header.sequence;
+
+        header.sequence = sequence + 1;     // Odd: update in progress
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        memcpy(&region_->latest, &sample, sizeof(sample));
+        memcpy(&region_->history[header.history_next], &sample, sizeof(sample));
+        header.history_next = (header.history_next + 1) % PCMON_SHM_HISTORY;
+        if (header.history_count < PCMON_SHM_HISTORY) {
+            header.history_count++;
+        }
+
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        header.sequence = sequence + 2;     // Even: consistent again
+    }
+
+}
@@ -0,0 +1,75 @@
+#include "snapshot_cache.h"
+#include "performance_monitor.h"
+#include <ctime>
+#include <cstdio>
+
+namespace PCMonitor {
+
+    SnapshotCache::SnapshotCache(const PerformanceMonitor& monitor, Encoder encoder, std::string content_type)
+        : monitor_(monitor)
+        , encoder_(std::move(encoder))
+        , content_type_(std::move(content_type))
+        , encode_count_(0)
+        , hit_count_(0)
+    {
+        // Versions restart at 1 with every run, so tag them with the start time
+        // to keep a client's cached ETag from matching a different process.
+        char prefix[32];
+        snprintf(prefix, sizeof(prefix), "%llx-", static_cast<unsigned long long>(std::time(nullptr)));
+        etag_prefix_ = prefix;
+    }
+
+    std::shared_ptr<const EncodedSnapshot> SnapshotCache::Get() {
+        uint64_t version = monitor_.GetSnapshotVersion();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (current_ && current_->version == version) {
+            hit_count_++;
+            return current_;
+        }
+
+        // Encoding under the lock makes concurrent misses wait for one encode
+        // instead of each building their own copy.
+        current_ = Encode(monitor_.GetSnapshot());
+        encode_count_++;
+        return current_;
+    }
+
+    std::shared_ptr<const EncodedSnapshot> SnapshotCache::Encode(const MetricsSnapshot& snapshot) const {
+        return MakeEntry(snapshot.version, MakeETag(snapshot.version), encoder_(snapshot), content_type_);
+    }
+
+    std::shared_ptr<const EncodedSnapshot> SnapshotCache::MakeEntry(uint64_t version, std::string etag,
+                                                                    std::string body, const std::string& content_type) {
+        auto entry = std::make_shared<EncodedSnapshot>();
+        entry->version = version;
+        entry->etag = std::move(etag);
+        entry->body = std::move(body);
+
+        std::string headers;
+        headers.reserve(256);
+        headers += "Content-Type: " + content_type + "\r\n";
+        headers += "ETag: " + entry->etag + "\r\n";
+        headers += "Access-Control-Allow-Origin: *\r\n";
+        headers += "Access-Control-Expose-Headers: ETag\r\n";
+        headers += "Cache-Control: no-cache\r\n";
+
+        entry->response.reserve(headers.size() + entry->body.size() + 64);
+        entry->response += "HTTP/1.1 200 OK\r\n";
+        entry->response += headers;
+        entry->response += "Content-Length: " + std::to_string(entry->body.size()) + "\r\n";
+        entry->response += "\r\n";
+        entry->response += entry->body;
+
+        entry->not_modified += "HTTP/1.1 304 Not Modified\r\n";
+        entry->not_modified += headers;
+        entry->not_modified += "\r\n";
+
+        return entry;
+    }
+
+    std::string SnapshotCache::MakeETag(uint64_t version) const {
+        return "\"" + etag_prefix_ + std::to_string(version) + "\"";
+    }
+
+}
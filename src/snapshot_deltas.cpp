@@ -0,0 +1,112 @@
+#include "snapshot_deltas.h"
+#include "performance_monitor.h"
+#include "metrics_projection.h"
+#include <cstring>
+
+namespace PCMonitor {
+
+    namespace {
+
+        bool FieldEquals(const SystemMetrics& a, const SystemMetrics& b, const FieldInfo& field) {
+            const char* left = reinterpret_cast<const char*>(&a) + field.offset;
+            const char* right = reinterpret_cast<const char*>(&b) + field.offset;
+
+            switch (field.type) {
+                case FieldType::U32:
+                    return memcmp(left, right, sizeof(uint32_t)) == 0;
+                case FieldType::U64:
+                    return memcmp(left, right, sizeof(uint64_t)) == 0;
+                case FieldType::F64:
+                    return memcmp(left, right, sizeof(double)) == 0;
+                case FieldType::U32Array:
+                    return *reinterpret_cast<const FanSpeeds*>(left) ==
+                           *reinterpret_cast<const FanSpeeds*>(right);
+            }
+            return false;
+        }
+
+    }
+
+    SnapshotDeltas::SnapshotDeltas(PerformanceMonitor& monitor, SnapshotCache& full_cache)
+        : full_cache_(full_cache)
+        , retained_(kRetainedSnapshots)
+        , next_slot_(0)
+        , retained_count_(0)
+        , encoded_version_(0)
+    {
+        monitor.AddSnapshotListener([this](const MetricsSnapshot& snapshot) {
+            Retain(snapshot);
+        });
+    }
+
+    void SnapshotDeltas::Retain(const MetricsSnapshot& snapshot) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        retained_[next_slot_] = snapshot;
+        next_slot_ = (next_slot_ + 1) % kRetainedSnapshots;
+        if (retained_count_ < kRetainedSnapshots) {
+            retained_count_++;
+        }
+    }
+
+    std::shared_ptr<const EncodedSnapshot> SnapshotDeltas::Get(uint64_t since) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (retained_count_ == 0 || since == 0) {
+            return full_cache_.Get();
+        }
+
+        const MetricsSnapshot& latest = retained_[(next_slot_ + kRetainedSnapshots - 1) % kRetainedSnapshots];
+        if (encoded_version_ != latest.version) {
+            encoded_.clear();
+            encoded_version_ = latest.version;
+        }
+
+        auto cached = encoded_.find(since);
+        if (cached != encoded_.end()) {
+            return cached->second;
+        }
+
+        const MetricsSnapshot* base = nullptr;
+        for (size_t i = 0; i < retained_count_; ++i) {
+            if (retained_[i].version == since) {
+                base = &retained_[i];
+                break;
+            }
+        }
+        if (!base) {
+            return full_cache_.Get();
+        }
+
+        auto entry = SnapshotCache::MakeEntry(latest.version, full_cache_.MakeETag(latest.version),
+                                              EncodeDelta(*base, latest), "application/json");
+        encoded_[since] = entry;
+        return entry;
+    }
+
+    std::string SnapshotDeltas::EncodeDelta(const MetricsSnapshot& base, const MetricsSnapshot& latest) const {
+        std::string json;
+        json.reserve(256);
+        json += "{\"timestamp\":" + std::to_string(latest.timestamp);
+        json += ",\"version\":" + std::to_string(latest.version);
+        json += ",\"since\":" + std::to_string(base.version);
+
+        for (const FieldGroup& group : kMetricGroups) {
+            bool group_open = false;
+
+            for (size_t i = 0; i < group.field_count; ++i) {
+                const FieldInfo& field = group.fields[i];
+                if (FieldEquals(base.metrics, latest.metrics, field)) continue;
+
+                json += group_open ? "," : std::string(",\"") + group.name + "\":{";
+                group_open = true;
+                json += std::string("\"") + field.name + "\":";
+                AppendFieldValue(json, latest.metrics, field);
+            }
+
+            if (group_open) json += "}";
+        }
+
+        json += "}";
+        return json;
+    }
+
+}
@@ -0,0 +1,219 @@
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+
+#include <winsock2.h>
+
+#include "subscription_manager.h"
+#include "performance_monitor.h"
+#include "metrics_projection.h"
+#include "agent_policy.h"
+#include <algorithm>
+#include <charconv>
+
+#pragma comment(lib, "ws2_32.lib")
+
+namespace PCMonitor {
+
+    SubscriptionManager::SubscriptionManager(PerformanceMonitor& monitor)
+        : monitor_(monitor)
+        , running_(false)
+        , published_version_(0)
+        , subscriber_count_(0)
+        , group_count_(0)
+        , frames_encoded_(0)
+        , frames_sent_(0)
+    {
+        monitor.AddSnapshotListener([this](const MetricsSnapshot& snapshot) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                published_version_ = snapshot.version;
+            }
+            cv_.notify_one();
+        });
+    }
+
+    SubscriptionManager::~SubscriptionManager() {
+        Stop();
+    }
+
+    bool SubscriptionManager::Start() {
+        if (running_) return false;
+
+        running_ = true;
+        fanout_thread_ = std::make_unique<std::thread>(&SubscriptionManager::FanOutLoop, this);
+        return true;
+    }
+
+    void SubscriptionManager::Stop() {
+        if (!running_) return;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_ = false;
+        }
+        cv_.notify_all();
+
+        if (fanout_thread_ && fanout_thread_->joinable()) {
+            fanout_thread_->join();
+        }
+        fanout_thread_.reset();
+
+        for (auto& entry : groups_) {
+            for (FrameSink& member : entry.second.members) {
+                member.Close();
+            }
+        }
+        groups_.clear();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const PendingSubscriber& pending : new_subscribers_) {
+            closesocket(static_cast<SOCKET>(pending.socket));
+        }
+        new_subscribers_.clear();
+        subscriber_count_ = 0;
+        group_count_ = 0;
+    }
+
+    void SubscriptionManager::Subscribe(SocketHandle socket, std::shared_ptr<const ProjectionPlan> plan, uint32_t interval_ms) {
+        FrameSink::MakeNonBlocking(socket);
+        if (interval_ms < kMinIntervalMs) interval_ms = kMinIntervalMs;
+        if (interval_ms > kMaxIntervalMs) interval_ms = kMaxIntervalMs;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!running_ || !plan) {
+                closesocket(static_cast<SOCKET>(socket));
+                return;
+            }
+            new_subscribers_.push_back(PendingSubscriber{ socket, std::move(plan), interval_ms });
+        }
+        cv_.notify_one();
+    }
+
+    void SubscriptionManager::AddToGroup(const PendingSubscriber& pending, std::chrono::steady_clock::time_point now) {
+        std::string key = std::to_string(pending.interval_ms);
+        key += ':';
+        key += pending.plan->GetSignature();
+
+        auto it = groups_.find(key);
+        if (it == groups_.end()) {
+            // Due at once, so the first member isn't kept waiting a full interval
+            Group group{ pending.plan, std::chrono::milliseconds(pending.interval_ms), now, 0, nullptr, {} };
+            it = groups_.emplace(std::move(key), std::move(group)).first;
+        }
+
+        Group& group = it->second;
+        FrameSink member(pending.socket);
+        if (group.last_frame) {
+            member.Queue(group.last_frame, group.sent_version);
+            frames_sent_++;
+        }
+        group.members.push_back(std::move(member));
+    }
+
+    std::shared_ptr<const std::string> SubscriptionManager::EncodeFrame(const ProjectionPlan& plan, const MetricsSnapshot& snapshot) const {
+        std::string frame;
+        frame.reserve(64 + plan.GetFieldCount() * 32);
+
+        char version[24];
+        auto result = std::to_chars(version, version + sizeof(version), snapshot.version);
+
+        // The projected document is a single line, so it needs one data: prefix
+        frame += "id: ";
+        frame.append(version, result.ptr);
+        frame += "\ndata: ";
+        plan.Write(snapshot, frame);
+        frame += "\n\n";
+
+        return std::make_shared<const std::string>(std::move(frame));
+    }
+
+    void SubscriptionManager::FanOutLoop() {
+        AgentPolicy::ApplyToCurrentThread(ThreadRole::Worker);
+
+        using Clock = std::chrono::steady_clock;
+        bool pending_writes = false;
+
+        while (running_) {
+            std::vector<PendingSubscriber> added;
+            uint64_t version;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+
+                // Sleep until a group that is behind comes due, a client has
+                // unsent bytes, or a snapshot or subscriber arrives
+                Clock::time_point wake = Clock::now() + std::chrono::milliseconds(pending_writes ? 20 : 1000);
+                for (const auto& entry : groups_) {
+                    if (entry.second.sent_version != published_version_ && entry.second.next_due < wake) {
+                        wake = entry.second.next_due;
+                    }
+                }
+                uint64_t seen_version = published_version_;
+                cv_.wait_until(lock, wake, [this, seen_version] {
+                    return !running_ || published_version_ != seen_version || !new_subscribers_.empty();
+                });
+
+                if (!running_) break;
+
+                added.swap(new_subscribers_);
+                version = published_version_;
+            }
+
+            Clock::time_point now = Clock::now();
+            for (const PendingSubscriber& pending : added) {
+                AddToGroup(pending, now);
+            }
+
+            // One snapshot copy serves every group that ticks this round
+            MetricsSnapshot snapshot;
+            bool have_snapshot = false;
+
+            for (auto& entry : groups_) {
+                Group& group = entry.second;
+                if (group.sent_version == version || now < group.next_due || version == 0) continue;
+
+                if (!have_snapshot) {
+                    snapshot = monitor_.GetSnapshot();
+                    have_snapshot = true;
+                }
+
+                group.last_frame = EncodeFrame(*group.plan, snapshot);
+                group.sent_version = snapshot.version;
+                group.next_due = now + group.interval;
+                frames_encoded_++;
+
+                for (FrameSink& member : group.members) {
+                    member.Queue(group.last_frame, group.sent_version);
+                }
+                frames_sent_ += group.members.size();
+            }
+
+            pending_writes = false;
+            size_t subscribers = 0;
+            for (auto it = groups_.begin(); it != groups_.end();) {
+                auto& members = it->second.members;
+                for (FrameSink& member : members) {
+                    if (!member.Flush()) {
+                        member.Close();
+                    } else if (member.HasPendingWrites()) {
+                        pending_writes = true;
+                    }
+                }
+
+                members.erase(
+                    std::remove_if(members.begin(), members.end(), [](const FrameSink& member) {
+                        return !member.IsOpen();
+                    }),
+                    members.end());
+
+                subscribers += members.size();
+                it = members.empty() ? groups_.erase(it) : std::next(it);
+            }
+
+            subscriber_count_ = subscribers;
+            group_count_ = groups_.size();
+        }
+    }
+
+}
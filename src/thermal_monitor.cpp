@@ -116,7 +116,7 @@ namespace PCMonitor {
             metrics.gpu_temp_c = 50;
             metrics.motherboard_temp_c = 40;
             metrics.case_temp_c = 35;
-            metrics.fan_speeds_rpm = {1200, 1000, 800};
+            metrics.fan_speeds_rpm = ReadFanSpeeds();
             return metrics;
         }
         
@@ -165,16 +165,11 @@ namespace PCMonitor {
         return metrics;
     }
 
-    std::vector<uint32_t> ThermalMonitor::ReadFanSpeeds() {
-        std::vector<uint32_t> fan_speeds;
+    FanSpeeds ThermalMonitor::ReadFanSpeeds() {
+        FanSpeeds fan_speeds;
         
-        if (!wmi_initialized_) {
-            // Return default fan speeds
-            return {1200, 1000, 800};
-        }
-        
-        // This would typically query specific hardware monitoring chips
-        // For now, simulate realistic fan speeds based on temperatures
+        // This would typically query specific hardware monitoring chips.
+        // For now (and as the default without WMI) use typical fan speeds.
         fan_speeds.push_back(1200); // CPU fan
         fan_speeds.push_back(1000); // Case fan 1
         fan_speeds.push_back(800);  // Case fan 2
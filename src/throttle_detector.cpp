@@ -0,0 +1,195 @@
+#include "throttle_detector.h"
+#include <powerbase.h>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+#pragma comment(lib, "powrprof.lib")
+
+namespace PCMonitor {
+
+    namespace {
+
+        // Documented for CallNtPowerInformation(ProcessorInformation) but not
+        // declared in the SDK headers
+        struct ProcessorPowerInformation {
+            ULONG Number;
+            ULONG MaxMhz;
+            ULONG CurrentMhz;
+            ULONG MhzLimit;
+            ULONG MaxIdleState;
+            ULONG CurrentIdleState;
+        };
+
+        // System-wide processor number of a "<group>,<core>" instance: the
+        // processors of the groups before it, then the core within its group
+        bool ProcessorNumber(const std::string& instance, ULONG& number) {
+            unsigned group = 0;
+            unsigned core = 0;
+            char end = 0;
+            if (sscanf(instance.c_str(), "%u,%u%c", &group, &core, &end) != 2) return false;
+            if (group >= GetActiveProcessorGroupCount() || core >= GetActiveProcessorCount(static_cast<WORD>(group))) {
+                return false;
+            }
+
+            number = core;
+            for (WORD g = 0; g < group; ++g) number += GetActiveProcessorCount(g);
+            return true;
+        }
+
+    }
+
+    ThrottleDetector::ThrottleDetector()
+        : query_(nullptr)
+        , throttled_seconds_(0.0)
+    {
+    }
+
+    ThrottleDetector::~ThrottleDetector() {
+        if (query_) {
+            PdhCloseQuery(query_);
+        }
+    }
+
+    bool ThrottleDetector::Initialize() {
+        if (query_) return true;
+        if (PdhOpenQuery(nullptr, 0, &query_) != ERROR_SUCCESS) {
+            query_ = nullptr;
+            return false;
+        }
+
+        const char* wildcard = "\\Processor Information(*)\\% Performance Limit";
+        DWORD length = 0;
+        if (PdhExpandWildCardPathA(nullptr, wildcard, nullptr, &length, 0) != static_cast<PDH_STATUS>(PDH_MORE_DATA)) {
+            return false;
+        }
+        std::vector<char> paths(length + 2);
+        if (PdhExpandWildCardPathA(nullptr, wildcard, paths.data(), &length, 0) != ERROR_SUCCESS) {
+            return false;
+        }
+
+        // Rated maximum per logical processor, by processor number. PDH
+        // lists instances in its own order (hybrid parts mix P- and E-cores
+        // of different ratings), so each core is looked up by its instance.
+        std::vector<ProcessorPowerInformation> power(GetActiveProcessorCount(ALL_PROCESSOR_GROUPS));
+        ULONG power_bytes = static_cast<ULONG>(power.size() * sizeof(ProcessorPowerInformation));
+        std::vector<double> max_mhz(power.size(), 0.0);
+        if (!power.empty() && CallNtPowerInformation(ProcessorInformation, nullptr, 0, power.data(), power_bytes) == 0) {
+            for (const ProcessorPowerInformation& processor : power) {
+                if (processor.Number < max_mhz.size()) max_mhz[processor.Number] = processor.MaxMhz;
+            }
+        }
+
+        for (const char* path = paths.data(); *path; path += strlen(path) + 1) {
+            std::string full(path);
+            size_t open = full.find('(');
+            size_t close = full.rfind(')');
+            if (open == std::string::npos || close == std::string::npos || close <= open) continue;
+
+            // Per-core instances only: "0,3", not "0,_Total" or "_Total"
+            std::string instance = full.substr(open + 1, close - open - 1);
+            if (instance.find("_Total") != std::string::npos) continue;
+
+            Core core = {};
+            std::string performance_path = "\\Processor Information(" + instance + ")\\% Processor Performance";
+            if (PdhAddCounterA(query_, path, 0, &core.limit) != ERROR_SUCCESS ||
+                PdhAddCounterA(query_, performance_path.c_str(), 0, &core.performance) != ERROR_SUCCESS) {
+                continue;
+            }
+
+            // Unknown rating: throttling is still tracked, but adds nothing to the clock or loss
+            ULONG number = 0;
+            core.max_mhz = ProcessorNumber(instance, number) && number < max_mhz.size() ? max_mhz[number] : 0.0;
+            cores_.push_back(core);
+            names_.push_back(instance);
+        }
+
+        // "% Processor Performance" needs a first collection as its baseline
+        PdhCollectQueryData(query_);
+        last_sample_ = std::chrono::steady_clock::now();
+        return !cores_.empty();
+    }
+
+    void ThrottleDetector::SetEventListener(std::function<void(const ThrottleEvent&)> listener) {
+        event_listener_ = std::move(listener);
+    }
+
+    ThrottleDetector::Summary ThrottleDetector::Sample(uint32_t fallback_mhz) {
+        Summary summary = { fallback_mhz, 100.0, 0, throttled_seconds_, 0 };
+        if (!query_ || cores_.empty()) return summary;
+
+        PdhCollectQueryData(query_);
+        auto now = std::chrono::steady_clock::now();
+        double elapsed = std::chrono::duration<double>(now - last_sample_).count();
+        last_sample_ = now;
+        int64_t timestamp = static_cast<int64_t>(std::time(nullptr));
+
+        double effective_total = 0.0;
+        double loss_total = 0.0;
+        uint32_t effective_cores = 0;
+
+        PDH_FMT_COUNTERVALUE counter_val;
+        for (size_t i = 0; i < cores_.size(); ++i) {
+            Core& core = cores_[i];
+
+            if (PdhGetFormattedCounterValue(core.limit, PDH_FMT_DOUBLE, nullptr, &counter_val) != ERROR_SUCCESS) continue;
+            double limit = counter_val.doubleValue;
+            double loss = core.max_mhz * (100.0 - (limit < 100.0 ? limit : 100.0)) / 100.0;
+
+            if (core.max_mhz > 0.0 &&
+                PdhGetFormattedCounterValue(core.performance, PDH_FMT_DOUBLE, nullptr, &counter_val) == ERROR_SUCCESS) {
+                effective_total += core.max_mhz * counter_val.doubleValue / 100.0;
+                effective_cores++;
+            }
+            loss_total += loss;
+            if (limit < summary.performance_limit_percent) summary.performance_limit_percent = limit;
+
+            bool throttled = limit < kThrottledBelowPercent;
+            if (throttled) {
+                summary.throttled_cores++;
+                if (!core.throttled) {
+                    core.since = now;
+                    core.lowest_limit = limit;
+                    core.loss_total = 0.0;
+                    core.loss_samples = 0;
+                }
+                if (limit < core.lowest_limit) core.lowest_limit = limit;
+                core.loss_total += loss;
+                core.loss_samples++;
+            }
+
+            if (throttled != core.throttled) {
+                core.throttled = throttled;
+                if (event_listener_) {
+                    double seconds = throttled ? 0.0 : std::chrono::duration<double>(now - core.since).count();
+                    double mean_loss = core.loss_samples ? core.loss_total / core.loss_samples : 0.0;
+                    event_listener_(ThrottleEvent{ timestamp, static_cast<uint32_t>(i), throttled,
+                                                   core.lowest_limit, mean_loss, seconds });
+                }
+            }
+        }
+
+        if (summary.throttled_cores > 0) {
+            throttled_seconds_ += elapsed;
+        }
+
+        if (effective_cores > 0) {
+            summary.effective_clock_mhz = static_cast<uint32_t>(effective_total / effective_cores);
+        }
+        summary.frequency_loss_mhz = static_cast<uint32_t>(loss_total / cores_.size());
+        summary.throttled_seconds = throttled_seconds_;
+        return summary;
+    }
+
+    void ThrottleDetector::AppendEventJson(const ThrottleEvent& event, std::string& out) const {
+        char numbers[128];
+        snprintf(numbers, sizeof(numbers), "\"limit_percent\":%.1f,\"loss_mhz\":%.0f,\"seconds\":%.1f",
+                 event.limit_percent, event.loss_mhz, event.seconds);
+
+        out += "\"timestamp\":" + std::to_string(event.timestamp);
+        out += ",\"core\":\"" + names_[event.core];
+        out += event.throttled ? "\",\"state\":\"throttled\"," : "\",\"state\":\"recovered\",";
+        out += numbers;
+    }
+
+}
@@ -0,0 +1,253 @@
+#include "trend_forecaster.h"
+#include "metrics_projection.h"
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+
+namespace PCMonitor {
+
+    namespace {
+
+        struct DefaultTarget {
+            const char* series;
+            const char* limit_series;
+            double limit;
+        };
+
+        // Fixed temperature limits are typical throttle points, not the parts'
+        // own; --forecast-limit adjusts them
+        const DefaultTarget kDefaultTargets[] = {
+            { "ram.used_mb", "ram.total_mb", 0.0 },
+            { "gpu.vram_used_mb", "gpu.vram_total_mb", 0.0 },
+            { "storage.volume_used_gb", "storage.volume_capacity_gb", 0.0 },
+            { "cpu.temperature_c", nullptr, 95.0 },
+            { "gpu.temperature_c", nullptr, 90.0 },
+            { "storage.temperature_c", nullptr, 70.0 },
+            { "thermal.cpu_temp_c", nullptr, 95.0 },
+            { "thermal.gpu_temp_c", nullptr, 90.0 },
+        };
+
+        // Clears once the predicted crossing is this many horizons away
+        constexpr double kClearHorizons = 1.5;
+
+        double SecondsToLimit(double current, double slope_per_second, double limit) {
+            if (current >= limit) return 0.0;
+            if (!(slope_per_second > 0.0)) return INFINITY;
+            return (limit - current) / slope_per_second;
+        }
+
+        void AppendSeconds(std::string& out, double seconds) {
+            if (!std::isfinite(seconds)) {
+                out += "null";
+                return;
+            }
+            char buffer[32];
+            snprintf(buffer, sizeof(buffer), "%.0f", seconds);
+            out += buffer;
+        }
+
+        void AppendEscaped(std::string& out, const std::string& text) {
+            for (char c : text) {
+                if (c == '\\' || c == '"') out += '\\';
+                out += c;
+            }
+        }
+
+    }
+
+    TrendForecaster::TrendForecaster(Settings settings, std::chrono::milliseconds interval)
+        : settings_(settings)
+        , interval_seconds_(interval.count() > 0 ? interval.count() / 1000.0 : 1.0)
+        , latest_timestamp_(0)
+    {
+        uint64_t window = static_cast<uint64_t>(settings_.window_seconds / interval_seconds_);
+        window_ = static_cast<uint32_t>(window < 3 ? 3 : window);
+        warmup_ = window_ / 4 > 10 ? window_ / 4 : 10;
+
+        std::string error;
+        for (const DefaultTarget& target : kDefaultTargets) {
+            std::string spec = std::string(target.series) + "=" +
+                               (target.limit_series ? std::string(target.limit_series) : std::to_string(target.limit));
+            SetLimit(spec, error);
+        }
+    }
+
+    bool TrendForecaster::SetLimit(std::string_view spec, std::string& error) {
+        size_t equals = spec.find('=');
+        if (equals == std::string_view::npos) {
+            error = "expected series=limit, got '" + std::string(spec) + "'";
+            return false;
+        }
+
+        std::string_view name = spec.substr(0, equals);
+        std::string_view limit_text = spec.substr(equals + 1);
+        const FieldInfo* field = FindScalarField(name);
+        if (!field) {
+            error = "unknown series '" + std::string(name) + "'";
+            return false;
+        }
+
+        const FieldInfo* limit_field = nullptr;
+        double limit = 0.0;
+        auto result = std::from_chars(limit_text.data(), limit_text.data() + limit_text.size(), limit);
+        if (result.ec != std::errc() || result.ptr != limit_text.data() + limit_text.size()) {
+            limit_field = FindScalarField(limit_text);
+            if (!limit_field) {
+                error = "limit must be a number or a series, got '" + std::string(limit_text) + "'";
+                return false;
+            }
+        }
+
+        for (Series& existing : series_) {
+            if (existing.field == field) {
+                existing.limit_field = limit_field;
+                existing.fixed_limit = limit;
+                return true;
+            }
+        }
+
+        Series series = {};
+        series.field = field;
+        series.limit_field = limit_field;
+        series.fixed_limit = limit;
+        series.buffer = static_cast<uint32_t>(samples_.size());
+        series.linear_seconds = INFINITY;
+        series.holt_seconds = INFINITY;
+        samples_.resize(samples_.size() + window_, 0.0);
+        series_.push_back(series);
+        names_.emplace_back(name);
+        return true;
+    }
+
+    void TrendForecaster::SetEventListener(std::function<void(const ForecastEvent&)> listener) {
+        event_listener_ = std::move(listener);
+    }
+
+    void TrendForecaster::Update(Series& series, double value) {
+        // Least-squares sums. The oldest sample leaves at x = 0 and every
+        // other sample moves down one x, which takes sum_y off sum_xy.
+        double* ring = &samples_[series.buffer];
+        if (series.count == window_) {
+            series.sum_y -= ring[series.head];
+            series.sum_xy -= series.sum_y;
+            series.count--;
+        }
+        ring[series.head] = value;
+        series.sum_xy += series.count * value;
+        series.sum_y += value;
+        series.count++;
+        series.head = (series.head + 1) % window_;
+
+        // Once per lap, recompute from the ring (oldest first now that head
+        // is back at 0) so rounding can't build up
+        if (series.head == 0 && series.count == window_) {
+            series.sum_y = 0.0;
+            series.sum_xy = 0.0;
+            for (uint32_t x = 0; x < window_; ++x) {
+                series.sum_y += ring[x];
+                series.sum_xy += x * ring[x];
+            }
+        }
+
+        // Holt: level and per-sample trend
+        if (series.samples == 0) {
+            series.level = value;
+            series.trend = 0.0;
+        } else {
+            double previous = series.level;
+            series.level = settings_.holt_alpha * value + (1.0 - settings_.holt_alpha) * (series.level + series.trend);
+            series.trend = settings_.holt_beta * (series.level - previous) + (1.0 - settings_.holt_beta) * series.trend;
+        }
+        series.samples++;
+
+        double n = static_cast<double>(series.count);
+        double fitted = value;
+        series.linear_slope = 0.0;
+        if (series.count >= 2) {
+            double sum_x = n * (n - 1.0) / 2.0;
+            double sum_xx = (n - 1.0) * n * (2.0 * n - 1.0) / 6.0;
+            double slope = (n * series.sum_xy - sum_x * series.sum_y) / (n * sum_xx - sum_x * sum_x);
+            fitted = (series.sum_y - slope * sum_x) / n + slope * (n - 1.0);
+            series.linear_slope = slope / interval_seconds_;
+        }
+        series.holt_slope = series.trend / interval_seconds_;
+
+        series.value = value;
+        series.linear_seconds = SecondsToLimit(value >= series.limit ? value : fitted, series.linear_slope, series.limit);
+        series.holt_seconds = SecondsToLimit(value >= series.limit ? value : series.level, series.holt_slope, series.limit);
+    }
+
+    void TrendForecaster::Add(const MetricsSnapshot& snapshot) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        latest_timestamp_ = snapshot.timestamp;
+
+        const double horizon = static_cast<double>(settings_.horizon_seconds);
+        for (size_t i = 0; i < series_.size(); ++i) {
+            Series& series = series_[i];
+            double value = ReadScalarField(snapshot.metrics, *series.field);
+            series.limit = series.limit_field ? ReadScalarField(snapshot.metrics, *series.limit_field) : series.fixed_limit;
+            if (!std::isfinite(value) || !(series.limit > 0.0)) continue;
+
+            Update(series, value);
+            if (series.samples < warmup_) continue;
+
+            // Both fits have to agree; the later crossing is the prediction
+            double seconds = series.linear_seconds > series.holt_seconds ? series.linear_seconds : series.holt_seconds;
+            bool predicted = series.predicted ? seconds <= horizon * kClearHorizons : seconds <= horizon;
+            if (predicted == series.predicted) continue;
+
+            series.predicted = predicted;
+            if (event_listener_) {
+                event_listener_(ForecastEvent{ snapshot.timestamp, static_cast<uint32_t>(i), predicted,
+                                               value, series.limit, seconds });
+            }
+        }
+    }
+
+    void TrendForecaster::AppendEventJson(const ForecastEvent& event, std::string& out) const {
+        char numbers[96];
+        snprintf(numbers, sizeof(numbers), "\"value\":%.3f,\"limit\":%.3f,\"seconds\":", event.value, event.limit);
+
+        out += "\"timestamp\":" + std::to_string(event.timestamp);
+        out += ",\"series\":\"";
+        AppendEscaped(out, names_[event.series]);
+        out += event.predicted ? "\",\"state\":\"predicted\"," : "\",\"state\":\"clear\",";
+        out += numbers;
+        AppendSeconds(out, event.seconds);
+    }
+
+    std::string TrendForecaster::GetStatusJson() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        std::string json = "{\"timestamp\":" + std::to_string(latest_timestamp_);
+        json += ",\"window_seconds\":" + std::to_string(settings_.window_seconds);
+        json += ",\"horizon_seconds\":" + std::to_string(settings_.horizon_seconds);
+        json += ",\"series\":[";
+        for (size_t i = 0; i < series_.size(); ++i) {
+            const Series& series = series_[i];
+            const char* state = !(series.limit > 0.0) ? "no_limit"
+                              : series.samples < warmup_ ? "warmup"
+                              : series.predicted ? "predicted" : "ok";
+
+            char numbers[128];
+            if (i > 0) json += ",";
+            json += "{\"series\":\"";
+            AppendEscaped(json, names_[i]);
+            json += std::string("\",\"state\":\"") + state + "\"";
+            snprintf(numbers, sizeof(numbers), ",\"value\":%.3f,\"limit\":%.3f,\"samples\":%llu",
+                     series.value, series.limit, static_cast<unsigned long long>(series.samples));
+            json += numbers;
+
+            snprintf(numbers, sizeof(numbers), ",\"linear\":{\"per_hour\":%.3f,\"seconds\":", series.linear_slope * 3600.0);
+            json += numbers;
+            AppendSeconds(json, series.linear_seconds);
+            snprintf(numbers, sizeof(numbers), "},\"holt\":{\"per_hour\":%.3f,\"seconds\":", series.holt_slope * 3600.0);
+            json += numbers;
+            AppendSeconds(json, series.holt_seconds);
+            json += "}}";
+        }
+        json += "]}";
+        return json;
+    }
+
+}
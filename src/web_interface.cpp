@@ -1,6 +1,7 @@
 #include "web_interface.h"
 #include "performance_monitor.h"
-#include <sstream>
+#include "metrics_serializer.h"
+#include "agent_policy.h"
 #include <iostream>
 #include <thread>
 
@@ -44,6 +45,8 @@ namespace PCMonitor {
     }
 
     void WebInterface::ServerLoop() {
+        AgentPolicy::ApplyToCurrentThread(ThreadRole::Worker);
+
         // This is a simplified HTTP server implementation
         // In a real application, you'd use a proper HTTP library like cpp-httplib
         
@@ -62,42 +65,7 @@ namespace PCMonitor {
 
     std::string WebInterface::GenerateJsonResponse() const {
         if (!monitor_) return "{}";
-        
-        auto gpu = monitor_->GetGPUMetrics();
-        auto cpu = monitor_->GetCPUMetrics();
-        auto ram = monitor_->GetRAMMetrics();
-        auto storage = monitor_->GetStorageMetrics();
-        auto power = monitor_->GetPowerMetrics();
-        auto thermal = monitor_->GetThermalMetrics();
-        
-        std::ostringstream json;
-        json << "{\n";
-        json << "  \"gpu\": {\n";
-        json << "    \"vram_used_mb\": " << gpu.vram_used_mb << ",\n";
-        json << "    \"vram_total_mb\": " << gpu.vram_total_mb << ",\n";
-        json << "    \"core_clock_mhz\": " << gpu.core_clock_mhz << ",\n";
-        json << "    \"temperature_c\": " << gpu.temperature_c << ",\n";
-        json << "    \"utilization_percent\": " << gpu.utilization_percent << "\n";
-        json << "  },\n";
-        json << "  \"cpu\": {\n";
-        json << "    \"utilization_percent\": " << cpu.utilization_percent << ",\n";
-        json << "    \"temperature_c\": " << cpu.temperature_c << ",\n";
-        json << "    \"current_clock_mhz\": " << cpu.current_clock_mhz << ",\n";
-        json << "    \"core_count\": " << cpu.core_count << "\n";
-        json << "  },\n";
-        json << "  \"ram\": {\n";
-        json << "    \"used_mb\": " << ram.used_mb << ",\n";
-        json << "    \"total_mb\": " << ram.total_mb << ",\n";
-        json << "    \"utilization_percent\": " << ram.utilization_percent << "\n";
-        json << "  },\n";
-        json << "  \"power\": {\n";
-        json << "    \"system_power_w\": " << power.system_power_w << ",\n";
-        json << "    \"psu_wattage\": " << power.psu_wattage << ",\n";
-        json << "    \"efficiency_percent\": " << power.efficiency_percent << "\n";
-        json << "  }\n";
-        json << "}";
-        
-        return json.str();
+        return EncodeMetricsJson(monitor_->GetSnapshot());
     }
 
     std::string WebInterface::GetUrl() const {
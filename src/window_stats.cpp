@@ -0,0 +1,196 @@
+#include "window_stats.h"
+#include "performance_monitor.h"
+#include "metrics_projection.h"
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+
+namespace PCMonitor {
+
+    namespace {
+
+        const double kDefaultQuantiles[] = { 0.5, 0.9, 0.95, 0.99 };
+
+        // Calls handle(item) for each non-empty comma-separated item; stops at the first false
+        template <typename Handler>
+        bool ForEachItem(std::string_view list, Handler handle) {
+            while (!list.empty()) {
+                size_t comma = list.find(',');
+                std::string_view item = list.substr(0, comma);
+                if (!item.empty() && !handle(item)) return false;
+                if (comma == std::string_view::npos) break;
+                list.remove_prefix(comma + 1);
+            }
+            return true;
+        }
+
+        void AppendNumber(std::string& out, double value) {
+            char buffer[32];
+            int length = snprintf(buffer, sizeof(buffer), "%.3f", value);
+            out.append(buffer, static_cast<size_t>(length));
+        }
+
+    }
+
+    WindowStats::WindowStats(PerformanceMonitor& monitor)
+        : latest_timestamp_(0)
+    {
+        ListScalarSeries(fields_, names_);
+
+        buckets_.resize(fields_.size() * kBucketsPerSeries);
+        for (Bucket& bucket : buckets_) {
+            bucket.epoch = -1;
+        }
+
+        monitor.AddSnapshotListener([this](const MetricsSnapshot& snapshot) {
+            Add(snapshot);
+        });
+    }
+
+    void WindowStats::Add(const MetricsSnapshot& snapshot) {
+        // The slot each window's current bucket lives in, shared by all series
+        size_t slots[kWindowCount];
+        int64_t epochs[kWindowCount];
+        size_t first = 0;
+        for (size_t w = 0; w < kWindowCount; ++w) {
+            epochs[w] = snapshot.timestamp / kWindows[w].bucket_seconds;
+            slots[w] = first + static_cast<size_t>(epochs[w] % kWindows[w].buckets);
+            first += kWindows[w].buckets;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        latest_timestamp_ = snapshot.timestamp;
+
+        for (size_t i = 0; i < fields_.size(); ++i) {
+            double value = ReadScalarField(snapshot.metrics, *fields_[i]);
+            Bucket* series = &buckets_[i * kBucketsPerSeries];
+
+            for (size_t w = 0; w < kWindowCount; ++w) {
+                Bucket& bucket = series[slots[w]];
+                if (bucket.epoch != epochs[w]) {
+                    bucket.sketch.Clear();
+                    bucket.epoch = epochs[w];
+                }
+                bucket.sketch.Add(value);
+            }
+        }
+    }
+
+    bool WindowStats::AppendJson(std::string_view windows, std::string_view series, std::string_view quantiles,
+                                 std::string& out, std::string& error) const {
+        bool window_selected[kWindowCount] = {};
+        if (!ForEachItem(windows, [&](std::string_view name) {
+                for (size_t w = 0; w < kWindowCount; ++w) {
+                    if (name == kWindows[w].name) {
+                        window_selected[w] = true;
+                        return true;
+                    }
+                }
+                error = "unknown window '" + std::string(name) + "' (1m, 1h or 24h)";
+                return false;
+            })) {
+            return false;
+        }
+        if (windows.empty()) {
+            for (bool& selected : window_selected) selected = true;
+        }
+
+        std::vector<bool> series_selected;
+        if (!MatchSeries(series, names_, series_selected, error)) {
+            return false;
+        }
+
+        double levels[kMaxQuantiles];
+        size_t level_count = 0;
+        if (!ForEachItem(quantiles, [&](std::string_view text) {
+                double q = 0.0;
+                auto result = std::from_chars(text.data(), text.data() + text.size(), q);
+                if (result.ec != std::errc() || result.ptr != text.data() + text.size() || q < 0.0 || q > 1.0) {
+                    error = "quantiles must be numbers from 0 to 1";
+                    return false;
+                }
+                if (level_count == kMaxQuantiles) {
+                    error = "at most " + std::to_string(kMaxQuantiles) + " quantiles";
+                    return false;
+                }
+                levels[level_count++] = q;
+                return true;
+            })) {
+            return false;
+        }
+        if (quantiles.empty()) {
+            for (double q : kDefaultQuantiles) levels[level_count++] = q;
+        }
+
+        // "p50", "p99.9": the keys are the same for every series. Levels
+        // printing the same key ("q=0.5,0.50") are asked once.
+        std::vector<std::string> keys;
+        size_t unique_count = 0;
+        for (size_t k = 0; k < level_count; ++k) {
+            char key[32];
+            snprintf(key, sizeof(key), ",\"p%g\":", levels[k] * 100.0);
+            if (std::find(keys.begin(), keys.end(), key) != keys.end()) continue;
+            keys.push_back(key);
+            levels[unique_count++] = levels[k];
+        }
+        level_count = unique_count;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        out += "{\"timestamp\":" + std::to_string(latest_timestamp_);
+        out += ",\"relative_accuracy\":";
+        AppendNumber(out, QuantileSketch::kRelativeAccuracy);
+        out += ",\"memory_bytes\":" + std::to_string(GetMemoryBytes());
+        out += ",\"windows\":{";
+
+        QuantileSketch merged;
+        bool first_window = true;
+        size_t first = 0;
+        for (size_t w = 0; w < kWindowCount; ++w) {
+            const Window& window = kWindows[w];
+            size_t window_first = first;
+            first += window.buckets;
+            if (!window_selected[w]) continue;
+
+            int64_t oldest = latest_timestamp_ / window.bucket_seconds - window.buckets + 1;
+
+            out += first_window ? "\"" : ",\"";
+            first_window = false;
+            out += window.name;
+            out += "\":{\"seconds\":" + std::to_string(window.bucket_seconds * window.buckets);
+            out += ",\"bucket_seconds\":" + std::to_string(window.bucket_seconds);
+            out += ",\"series\":{";
+
+            bool first_series = true;
+            for (size_t i = 0; i < names_.size(); ++i) {
+                if (!series_selected[i]) continue;
+
+                merged.Clear();
+                const Bucket* buckets = &buckets_[i * kBucketsPerSeries + window_first];
+                for (size_t b = 0; b < window.buckets; ++b) {
+                    if (buckets[b].epoch >= oldest) merged.Merge(buckets[b].sketch);
+                }
+
+                out += first_series ? "\"" : ",\"";
+                first_series = false;
+                out += names_[i];
+                out += "\":{\"count\":" + std::to_string(merged.GetCount());
+                out += ",\"min\":";
+                AppendNumber(out, merged.GetMin());
+                out += ",\"max\":";
+                AppendNumber(out, merged.GetMax());
+                out += ",\"mean\":";
+                AppendNumber(out, merged.GetMean());
+                for (size_t k = 0; k < level_count; ++k) {
+                    out += keys[k];
+                    AppendNumber(out, merged.Quantile(levels[k]));
+                }
+                out += "}";
+            }
+            out += "}}";
+        }
+
+        out += "}}";
+        return true;
+    }
+
+}
@@ -0,0 +1,108 @@
+// Decoder for the compact binary metrics format (/api/metrics.bin, /api/stream.bin).
+// Payloads are CBOR arrays laid out as described by /api/schema; decodeMetrics()
+// turns one into the same object shape /api/metrics returns as JSON.
+(function (global) {
+  function decodeCbor(bytes) {
+    const view = new DataView(bytes.buffer, bytes.byteOffset, bytes.byteLength);
+    let offset = 0;
+
+    function readLength(info) {
+      if (info < 24) return info;
+      let value;
+      switch (info) {
+        case 24: value = view.getUint8(offset); offset += 1; return value;
+        case 25: value = view.getUint16(offset); offset += 2; return value;
+        case 26: value = view.getUint32(offset); offset += 4; return value;
+        case 27: {
+          const high = view.getUint32(offset);
+          const low = view.getUint32(offset + 4);
+          offset += 8;
+          return high * 4294967296 + low;
+        }
+        default: throw new Error(`Unsupported CBOR length encoding ${info}`);
+      }
+    }
+
+    function readItem() {
+      const head = view.getUint8(offset++);
+      const major = head >> 5;
+      const info = head & 0x1f;
+
+      switch (major) {
+        case 0: return readLength(info);
+        case 1: return -1 - readLength(info);
+        case 4: {
+          const count = readLength(info);
+          const items = new Array(count);
+          for (let i = 0; i < count; i++) items[i] = readItem();
+          return items;
+        }
+        case 7: {
+          let value;
+          if (info === 26) { value = view.getFloat32(offset); offset += 4; return value; }
+          if (info === 27) { value = view.getFloat64(offset); offset += 8; return value; }
+          if (info === 20) return false;
+          if (info === 21) return true;
+          if (info === 22) return null;
+          throw new Error(`Unsupported CBOR simple value ${info}`);
+        }
+        default: throw new Error(`Unsupported CBOR major type ${major}`);
+      }
+    }
+
+    return readItem();
+  }
+
+  // Maps a decoded payload onto field names using the schema document
+  function decodeMetrics(buffer, schema) {
+    const bytes = buffer instanceof Uint8Array ? buffer : new Uint8Array(buffer);
+    const items = decodeCbor(bytes);
+    if (items[0] !== schema.schema_version) {
+      throw new Error(`Schema version ${items[0]} does not match ${schema.schema_version}`);
+    }
+
+    const result = { version: items[1], timestamp: items[2] };
+    const groupOffset = 3;
+    schema.groups.forEach((group, g) => {
+      const values = items[groupOffset + g];
+      const out = {};
+      group.fields.forEach((field, f) => {
+        // float32 on the wire: round to the precision the JSON API uses
+        out[field.name] = field.type === 'f32' ? Math.round(values[f] * 10) / 10 : values[f];
+      });
+      result[group.name] = out;
+    });
+    return result;
+  }
+
+  // Reads /api/stream.bin: each payload is preceded by a u32 little-endian length
+  async function readFrames(body, onFrame) {
+    const reader = body.getReader();
+    let pending = new Uint8Array(0);
+
+    for (;;) {
+      const { value, done } = await reader.read();
+      if (done) return;
+
+      const joined = new Uint8Array(pending.length + value.length);
+      joined.set(pending);
+      joined.set(value, pending.length);
+
+      let offset = 0;
+      while (joined.length - offset >= 4) {
+        const length = new DataView(joined.buffer, offset, 4).getUint32(0, true);
+        if (joined.length - offset - 4 < length) break;
+        onFrame(joined.subarray(offset + 4, offset + 4 + length));
+        offset += 4 + length;
+      }
+      pending = joined.slice(offset);
+    }
+  }
+
+  const api = { decodeCbor, decodeMetrics, readFrames };
+  if (typeof module !== 'undefined' && module.exports) {
+    module.exports = api;
+  } else {
+    global.MetricsCodec = api;
+  }
+})(typeof window !== 'undefined' ? window : globalThis);